@@ -0,0 +1,439 @@
+/*! Combat AI implementation file */
+
+#include "headers/ai.h"
+#include "headers/damage.h"
+#include "headers/player.h"
+#include <float.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/** Nodes between two looks at the clock, minus one. */
+#define AI_CLOCK_MASK 1023
+/** Score of a decided fight, above any health difference. */
+#define AI_WIN_SCORE 1e12
+
+/**
+ * @struct ai_entry
+ * @brief Transposition table entry. Slots of combatants and weapons refer to the search that stored it.
+ */
+struct ai_entry {
+    /** Zobrist key of the position. */
+    uint64_t key;
+    /** Expected score of the position for the searching player. */
+    double value;
+    /** Depth the value was searched to, 0 for an empty entry. */
+    uint8_t depth;
+    /** Weapon slot of the best move. */
+    uint8_t weapon;
+    /** Target slot of the best move. */
+    uint8_t target;
+};
+
+/**
+ * @enum ai_key_kind
+ * @brief What a Zobrist key stands for.
+ */
+enum ai_key_kind {
+    AI_KEY_HEALTH,
+    AI_KEY_WEAPON_HEALTH,
+    AI_KEY_WEAPON_DAMAGE,
+    AI_KEY_RESISTANCE,
+    AI_KEY_TO_MOVE,
+    AI_KEY_ROOT
+};
+
+/**
+ * @struct ai_combatant
+ * @brief A player as the search sees it.
+ */
+struct ai_combatant {
+    /** Index of the player in the game. */
+    size_t player_index;
+    /** Player health. */
+    unsigned int health;
+    /** Armor resistance. */
+    unsigned int resistance;
+    /** Weapons considered. */
+    size_t total_weapons;
+    /** Damage of each weapon. */
+    unsigned int weapon_damage[AI_MAX_WEAPONS];
+    /** Health of each weapon. */
+    unsigned int weapon_health[AI_MAX_WEAPONS];
+    /** Position of each weapon in the player's weapons. */
+    size_t weapon_position[AI_MAX_WEAPONS];
+};
+
+/**
+ * @struct ai_search
+ * @brief State of one search, lives on the stack and is modified and restored in place.
+ */
+struct ai_search {
+    /** Engine searched with. */
+    struct ai_engine *ai;
+    /** Players in turn order. */
+    struct ai_combatant combatants[AI_MAX_COMBATANTS];
+    /** Number of combatants. */
+    size_t total_combatants;
+    /** Slot of the searching player. */
+    size_t root;
+    /** Slot of the player to move. */
+    size_t to_move;
+    /** Zobrist key of the current position. */
+    uint64_t hash;
+    /** Time to stop at. */
+    struct timespec deadline;
+    /** Set while the deadline may stop the search. */
+    bool can_abort;
+    /** Set once the deadline passed, the current depth is then discarded. */
+    bool aborted;
+    /** Positions visited. */
+    size_t nodes;
+    /** Positions answered by the table. */
+    size_t table_hits;
+};
+
+/**
+ * @brief Derives a Zobrist key. splitmix64's finalizer is a bijection, so distinct inputs never share a key.
+ */
+static uint64_t ai_key(const struct ai_search *s, const enum ai_key_kind kind, const size_t slot, const unsigned int value)
+{
+    uint64_t x = s->ai->seed ^ ((uint64_t)kind << 56) ^ ((uint64_t)slot << 32) ^ value;
+    x = (x ^ (x >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+    x = (x ^ (x >> 27)) * UINT64_C(0x94d049bb133111eb);
+    return x ^ (x >> 31);
+}
+
+static bool ai_past_deadline(const struct ai_search *s)
+{
+    struct timespec now;
+    timespec_get(&now, TIME_UTC);
+    return now.tv_sec > s->deadline.tv_sec || (now.tv_sec == s->deadline.tv_sec && now.tv_nsec >= s->deadline.tv_nsec);
+}
+
+static size_t ai_next_to_move(const struct ai_search *s, const size_t from)
+{
+    for (size_t i = 1; i <= s->total_combatants; i++) {
+        const size_t slot = (from + i) % s->total_combatants;
+        if (s->combatants[slot].health > 0) {
+            return slot;
+        }
+    }
+    return from;
+}
+
+/**
+ * @brief Scores a position for the searching player: its health minus everyone else's, or a decided fight.
+ *
+ * @param[out] decided Set if the searching player or all of its opponents are dead.
+ */
+static double ai_evaluate(const struct ai_search *s, bool *decided)
+{
+    double others = 0.0;
+    bool any_alive = false;
+    for (size_t i = 0; i < s->total_combatants; i++) {
+        if (i != s->root) {
+            others += s->combatants[i].health;
+            any_alive |= s->combatants[i].health > 0;
+        }
+    }
+
+    const double own = s->combatants[s->root].health;
+    *decided = own == 0.0 || !any_alive;
+    if (own == 0.0) {
+        return -AI_WIN_SCORE - others;
+    }
+    if (!any_alive) {
+        return AI_WIN_SCORE + own;
+    }
+    return own - others;
+}
+
+static double ai_search_node(struct ai_search *s, const unsigned int depth);
+
+/**
+ * @brief Plays an attack dealing a known damage, searches the position after it and takes it back.
+ */
+static double ai_search_outcome(struct ai_search *s, const size_t weapon, const size_t target, const unsigned int damage, const unsigned int depth)
+{
+    struct ai_combatant *attacker = &s->combatants[s->to_move];
+    struct ai_combatant *defender = &s->combatants[target];
+    const unsigned int old_health = defender->health;
+    const unsigned int old_weapon_health = attacker->weapon_health[weapon];
+    const size_t old_to_move = s->to_move;
+    const uint64_t old_hash = s->hash;
+
+    // Same rules as player_attack_r: floor at 0, the weapon wears by a tenth of the damage dealt
+    defender->health = (old_health > damage) ? old_health - damage : 0;
+    attacker->weapon_health[weapon] = (old_weapon_health > damage / 10) ? old_weapon_health - damage / 10 : 0;
+    s->to_move = ai_next_to_move(s, old_to_move);
+    s->hash ^= ai_key(s, AI_KEY_HEALTH, target, old_health) ^ ai_key(s, AI_KEY_HEALTH, target, defender->health)
+        ^ ai_key(s, AI_KEY_WEAPON_HEALTH, old_to_move * AI_MAX_WEAPONS + weapon, old_weapon_health)
+        ^ ai_key(s, AI_KEY_WEAPON_HEALTH, old_to_move * AI_MAX_WEAPONS + weapon, attacker->weapon_health[weapon])
+        ^ ai_key(s, AI_KEY_TO_MOVE, 0, (unsigned int)old_to_move) ^ ai_key(s, AI_KEY_TO_MOVE, 0, (unsigned int)s->to_move);
+
+    const double value = ai_search_node(s, depth - 1);
+
+    defender->health = old_health;
+    attacker->weapon_health[weapon] = old_weapon_health;
+    s->to_move = old_to_move;
+    s->hash = old_hash;
+    return value;
+}
+
+/**
+ * @brief Chance node of an attack: a normal or a critical hit, weighted by the damage model.
+ */
+static double ai_search_attack(struct ai_search *s, const size_t weapon, const size_t target, const unsigned int depth)
+{
+    const struct ai_combatant *attacker = &s->combatants[s->to_move];
+    const unsigned int normal = damage_mitigate(attacker->weapon_damage[weapon], s->combatants[target].resistance);
+    const unsigned int critical = damage_apply_crit(normal, true);
+
+    if (normal == critical || DAMAGE_CRIT_NUMERATOR == 0) {
+        return ai_search_outcome(s, weapon, target, normal, depth);
+    }
+    if (DAMAGE_CRIT_NUMERATOR == DAMAGE_CRIT_DENOMINATOR) {
+        return ai_search_outcome(s, weapon, target, critical, depth);
+    }
+
+    const double chance = (double)DAMAGE_CRIT_NUMERATOR / DAMAGE_CRIT_DENOMINATOR;
+    const double normal_value = ai_search_outcome(s, weapon, target, normal, depth);
+    const double critical_value = ai_search_outcome(s, weapon, target, critical, depth);
+    return (1.0 - chance) * normal_value + chance * critical_value;
+}
+
+/**
+ * @brief Max node for the searching player, min node for everyone else.
+ */
+static double ai_search_node(struct ai_search *s, const unsigned int depth)
+{
+    s->nodes++;
+    if (s->can_abort && (s->nodes & AI_CLOCK_MASK) == 0 && ai_past_deadline(s)) {
+        s->aborted = true;
+    }
+    if (s->aborted) {
+        return 0.0;
+    }
+
+    bool decided = false;
+    const double score = ai_evaluate(s, &decided);
+    if (depth == 0 || decided) {
+        return score;
+    }
+
+    struct ai_entry *e = &s->ai->table[s->hash & s->ai->table_mask];
+    if (e->depth >= depth && e->key == s->hash) {
+        s->table_hits++;
+        return e->value;
+    }
+
+    const struct ai_combatant *attacker = &s->combatants[s->to_move];
+    const bool maximizing = s->to_move == s->root;
+    double best = maximizing ? -DBL_MAX : DBL_MAX;
+    size_t best_weapon = 0;
+    size_t best_target = 0;
+    bool any = false;
+
+    for (size_t w = 0; w < attacker->total_weapons; w++) {
+        if (attacker->weapon_health[w] == 0 || attacker->weapon_damage[w] == 0) {
+            continue;
+        }
+        for (size_t t = 0; t < s->total_combatants; t++) {
+            if (t == s->to_move || s->combatants[t].health == 0) {
+                continue;
+            }
+
+            const double value = ai_search_attack(s, w, t, depth);
+            if (s->aborted) {
+                return 0.0;
+            }
+            if (!any || (maximizing ? value > best : value < best)) {
+                best = value;
+                best_weapon = w;
+                best_target = t;
+                any = true;
+            }
+        }
+    }
+
+    if (!any) {
+        // Nothing to attack with, the turn passes
+        const size_t old_to_move = s->to_move;
+        const uint64_t old_hash = s->hash;
+        s->to_move = ai_next_to_move(s, old_to_move);
+        s->hash ^= ai_key(s, AI_KEY_TO_MOVE, 0, (unsigned int)old_to_move) ^ ai_key(s, AI_KEY_TO_MOVE, 0, (unsigned int)s->to_move);
+        best = ai_search_node(s, depth - 1);
+        s->to_move = old_to_move;
+        s->hash = old_hash;
+        if (s->aborted) {
+            return 0.0;
+        }
+    }
+
+    e->key = s->hash;
+    e->value = best;
+    e->depth = (uint8_t)depth;
+    e->weapon = (uint8_t)best_weapon;
+    e->target = (uint8_t)best_target;
+    return best;
+}
+
+/**
+ * @brief Loads a player into a combatant slot, with its strongest usable weapons.
+ */
+static void ai_load_combatant(const struct player *p, const size_t player_index, struct ai_combatant *c)
+{
+    const struct weapon *weapons = vector_items(&p->_weapons);
+    const struct inventory_index *idx = &p->_weapon_index;
+
+    c->player_index = player_index;
+    c->health = p->health;
+    c->resistance = p->_isWearingArmor ? p->current_armor._armor_resistance_force : 0;
+    c->total_weapons = 0;
+    for (size_t i = 0; i < idx->size && c->total_weapons < AI_MAX_WEAPONS; i++) {
+        const struct weapon *w = &weapons[idx->by_damage[i]];
+        if (w->weapon_health == 0 || w->weapon_damage == 0) {
+            break;
+        }
+        c->weapon_damage[c->total_weapons] = w->weapon_damage;
+        c->weapon_health[c->total_weapons] = w->weapon_health;
+        c->weapon_position[c->total_weapons] = idx->by_damage[i];
+        c->total_weapons++;
+    }
+}
+
+/**
+ * @brief Builds the search state from the game: the searching player and the first living others, in game order.
+ */
+static bool ai_load_search(const size_t player_index, const struct game *g, struct ai_search *s)
+{
+    const size_t total_players = game_get_total_players(g);
+    const struct player *self = game_get_player(player_index, g);
+    if (!self || self->health == 0) {
+        return false;
+    }
+
+    size_t others = 0;
+    for (size_t i = 0; i < total_players && s->total_combatants < AI_MAX_COMBATANTS; i++) {
+        const struct player *p = game_get_player(i, g);
+        if (i != player_index && (p->health == 0 || others == AI_MAX_COMBATANTS - 1)) {
+            continue;
+        }
+        if (i == player_index) {
+            s->root = s->total_combatants;
+        } else {
+            others++;
+        }
+        ai_load_combatant(p, i, &s->combatants[s->total_combatants++]);
+    }
+
+    s->to_move = s->root;
+    s->hash = ai_key(s, AI_KEY_ROOT, 0, (unsigned int)s->root) ^ ai_key(s, AI_KEY_TO_MOVE, 0, (unsigned int)s->to_move);
+    for (size_t i = 0; i < s->total_combatants; i++) {
+        const struct ai_combatant *c = &s->combatants[i];
+        s->hash ^= ai_key(s, AI_KEY_HEALTH, i, c->health) ^ ai_key(s, AI_KEY_RESISTANCE, i, c->resistance);
+        for (size_t w = 0; w < c->total_weapons; w++) {
+            s->hash ^= ai_key(s, AI_KEY_WEAPON_HEALTH, i * AI_MAX_WEAPONS + w, c->weapon_health[w])
+                ^ ai_key(s, AI_KEY_WEAPON_DAMAGE, i * AI_MAX_WEAPONS + w, c->weapon_damage[w]);
+        }
+    }
+
+    return others > 0 && s->combatants[s->root].total_weapons > 0;
+}
+
+bool ai_engine_initialize(const size_t table_entries, const uint64_t seed, struct ai_engine *ai)
+{
+    if (table_entries == 0 || !ai) {
+        return false;
+    }
+
+    size_t entries = 1;
+    while (entries < table_entries) {
+        entries *= 2;
+    }
+
+    ai->table = calloc(entries, sizeof(*ai->table));
+    if (!ai->table) {
+        return false;
+    }
+    ai->table_mask = entries - 1;
+    ai->seed = seed;
+    return true;
+}
+
+bool ai_choose_move(const size_t player_index, const unsigned int budget_us, const struct game *g, struct ai_engine *ai, struct ai_move *move, struct ai_search_info *info)
+{
+    if (!g || !ai || !ai->table || !move) {
+        return false;
+    }
+
+    struct ai_search s = {0};
+    s.ai = ai;
+    if (!ai_load_search(player_index, g, &s)) {
+        return false;
+    }
+
+    timespec_get(&s.deadline, TIME_UTC);
+    s.deadline.tv_sec += budget_us / 1000000;
+    s.deadline.tv_nsec += (long)(budget_us % 1000000) * 1000;
+    if (s.deadline.tv_nsec >= 1000000000) {
+        s.deadline.tv_sec++;
+        s.deadline.tv_nsec -= 1000000000;
+    }
+
+    const uint64_t root_hash = s.hash;
+    const struct ai_entry *root = &ai->table[root_hash & ai->table_mask];
+    struct ai_search_info found = {0};
+    for (unsigned int depth = 1; depth <= AI_MAX_DEPTH; depth++) {
+        s.can_abort = depth > 1;
+        const double value = ai_search_node(&s, depth);
+        if (s.aborted || root->key != root_hash) {
+            break;
+        }
+
+        const struct ai_combatant *self = &s.combatants[s.root];
+        move->weapon = self->weapon_position[root->weapon];
+        move->target = s.combatants[root->target].player_index;
+        found.depth = depth;
+        found.value = value;
+        if (ai_past_deadline(&s)) {
+            break;
+        }
+    }
+
+    found.nodes = s.nodes;
+    found.table_hits = s.table_hits;
+    if (info) {
+        *info = found;
+    }
+    return found.depth > 0;
+}
+
+bool ai_take_turn(const size_t player_index, const unsigned int budget_us, struct game *g, struct ai_engine *ai, pcg32_random_t *rng)
+{
+    struct ai_move move = {0};
+    if (!rng || !ai_choose_move(player_index, budget_us, g, ai, &move, NULL)) {
+        return false;
+    }
+
+    struct player *attacker = game_get_player_mut(player_index, g);
+    struct player *target = game_get_player_mut(move.target, g);
+    if (!attacker || !target) {
+        return false;
+    }
+
+    // By position, the name of the chosen weapon could stand for another one
+    player_attack_at_r(attacker, move.weapon, target, rng);
+    return true;
+}
+
+void ai_engine_deinitialize(struct ai_engine *ai)
+{
+    if (!ai) {
+        return;
+    }
+
+    free(ai->table);
+    memset(ai, 0, sizeof(*ai));
+}
@@ -0,0 +1,156 @@
+/*! Tagged allocation implementation file */
+
+#include "headers/alloc.h"
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * @struct alloc_header
+ * @brief Placed before every block, padded so the block keeps malloc()'s alignment.
+ */
+struct alloc_header {
+    /** Bytes requested. */
+    alignas(max_align_t) size_t size;
+    /** Tag the block is accounted to. */
+    enum alloc_tag tag;
+};
+
+/**
+ * @struct alloc_counters
+ * @brief Live counters of one tag.
+ */
+struct alloc_counters {
+    /** See alloc_stats. */
+    atomic_size_t live_bytes;
+    /** See alloc_stats. */
+    atomic_size_t peak_bytes;
+    /** See alloc_stats. */
+    atomic_size_t live_allocations;
+    /** See alloc_stats. */
+    atomic_size_t total_allocations;
+};
+
+/** Counters of every tag, zero initialized. */
+static struct alloc_counters alloc_counters[ALLOC_TAG_COUNT];
+
+/** Names of the tags, in enum order. */
+static const char *const alloc_tag_names[ALLOC_TAG_COUNT] = {
+    "vector",
+    "weapon",
+    "armor",
+    "player",
+    "game",
+    "name"
+};
+
+static void alloc_account(const enum alloc_tag tag, const size_t size)
+{
+    struct alloc_counters *c = &alloc_counters[tag];
+    const size_t live = atomic_fetch_add_explicit(&c->live_bytes, size, memory_order_relaxed) + size;
+    atomic_fetch_add_explicit(&c->live_allocations, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&c->total_allocations, 1, memory_order_relaxed);
+
+    size_t peak = atomic_load_explicit(&c->peak_bytes, memory_order_relaxed);
+    while (live > peak && !atomic_compare_exchange_weak_explicit(&c->peak_bytes, &peak, live, memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+static void alloc_unaccount(const enum alloc_tag tag, const size_t size)
+{
+    struct alloc_counters *c = &alloc_counters[tag];
+    atomic_fetch_sub_explicit(&c->live_bytes, size, memory_order_relaxed);
+    atomic_fetch_sub_explicit(&c->live_allocations, 1, memory_order_relaxed);
+}
+
+void *alloc_malloc(const size_t size, const enum alloc_tag tag)
+{
+    if ((unsigned int)tag >= ALLOC_TAG_COUNT || size > SIZE_MAX - sizeof(struct alloc_header)) {
+        return NULL;
+    }
+
+    struct alloc_header *h = malloc(sizeof(*h) + size);
+    if (!h) {
+        return NULL;
+    }
+    h->size = size;
+    h->tag = tag;
+    alloc_account(tag, size);
+
+    return h + 1;
+}
+
+void *alloc_realloc(void *ptr, const size_t size, const enum alloc_tag tag)
+{
+    if (!ptr) {
+        return alloc_malloc(size, tag);
+    }
+    if (size > SIZE_MAX - sizeof(struct alloc_header)) {
+        return NULL;
+    }
+
+    struct alloc_header *old = (struct alloc_header *)ptr - 1;
+    const size_t old_size = old->size;
+    const enum alloc_tag old_tag = old->tag;
+    struct alloc_header *h = realloc(old, sizeof(*h) + size);
+    if (!h) {
+        return NULL;
+    }
+
+    // A resize is one block going away and another taking its place
+    alloc_unaccount(old_tag, old_size);
+    alloc_account(old_tag, size);
+    h->size = size;
+
+    return h + 1;
+}
+
+void alloc_free(void *ptr)
+{
+    if (!ptr) {
+        return;
+    }
+
+    struct alloc_header *h = (struct alloc_header *)ptr - 1;
+    alloc_unaccount(h->tag, h->size);
+    free(h);
+}
+
+bool alloc_get_stats(const enum alloc_tag tag, struct alloc_stats *stats)
+{
+    if ((unsigned int)tag >= ALLOC_TAG_COUNT || !stats) {
+        return false;
+    }
+
+    const struct alloc_counters *c = &alloc_counters[tag];
+    stats->live_bytes = atomic_load_explicit(&c->live_bytes, memory_order_relaxed);
+    stats->peak_bytes = atomic_load_explicit(&c->peak_bytes, memory_order_relaxed);
+    stats->live_allocations = atomic_load_explicit(&c->live_allocations, memory_order_relaxed);
+    stats->total_allocations = atomic_load_explicit(&c->total_allocations, memory_order_relaxed);
+
+    return true;
+}
+
+const char *alloc_tag_name(const enum alloc_tag tag)
+{
+    if ((unsigned int)tag >= ALLOC_TAG_COUNT) {
+        return NULL;
+    }
+
+    return alloc_tag_names[tag];
+}
+
+void alloc_dump(FILE *out)
+{
+    if (!out) {
+        return;
+    }
+
+    fprintf(out, "%-8s %14s %14s %10s %12s\n", "tag", "live bytes", "peak bytes", "live", "allocations");
+    for (unsigned int tag = 0; tag < ALLOC_TAG_COUNT; tag++) {
+        struct alloc_stats s = {0};
+        alloc_get_stats((enum alloc_tag)tag, &s);
+        fprintf(out, "%-8s %14zu %14zu %10zu %12zu\n", alloc_tag_names[tag], s.live_bytes, s.peak_bytes, s.live_allocations, s.total_allocations);
+    }
+}
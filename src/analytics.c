@@ -0,0 +1,397 @@
+/*! Combat analytics implementation file */
+
+#include "headers/analytics.h"
+#include <assert.h>
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <string.h>
+
+static_assert((ANALYTICS_MAX_WEAPONS & (ANALYTICS_MAX_WEAPONS - 1)) == 0, "ANALYTICS_MAX_WEAPONS must be a power of two");
+static_assert((ANALYTICS_MAX_ARMORS & (ANALYTICS_MAX_ARMORS - 1)) == 0, "ANALYTICS_MAX_ARMORS must be a power of two");
+static_assert(ANALYTICS_SUB_BITS >= 1 && ANALYTICS_SUB_BITS < 32, "ANALYTICS_SUB_BITS out of range");
+
+/** Name given to the slot counting everything past a full table. */
+#define ANALYTICS_OTHER_NAME "(other)"
+/** Name counting the attacks on players wearing no armor. */
+#define ANALYTICS_NO_ARMOR_NAME "(none)"
+
+/**
+ * @struct analytics_histogram
+ * @brief Log-linear histogram of unsigned ints.
+ */
+struct analytics_histogram {
+    /** Values per bucket. */
+    _Atomic uint64_t counts[ANALYTICS_HISTOGRAM_BUCKETS];
+    /** Largest value. */
+    atomic_uint max;
+};
+
+/**
+ * @struct analytics_key
+ * @brief Name of a table slot, claimed by the first attack naming it.
+ */
+struct analytics_key {
+    /** Hash of the full name, 0 while the slot is free. */
+    _Atomic uint64_t hash;
+    /** Set once name is written. */
+    atomic_bool ready;
+    /** Name, cut to ANALYTICS_NAME_SIZE - 1 characters. */
+    char name[ANALYTICS_NAME_SIZE];
+};
+
+/**
+ * @struct analytics_weapon_slot
+ * @brief Live counters of one weapon.
+ */
+struct analytics_weapon_slot {
+    /** See analytics_weapon. */
+    _Atomic uint64_t attacks;
+    /** See analytics_weapon. */
+    _Atomic uint64_t crits;
+    /** See analytics_weapon. */
+    _Atomic uint64_t damage;
+    /** Damage dealt per hit. */
+    struct analytics_histogram hits;
+};
+
+/**
+ * @struct analytics_armor_slot
+ * @brief Live counters of one armor.
+ */
+struct analytics_armor_slot {
+    /** See analytics_armor. */
+    _Atomic uint64_t attacks;
+    /** See analytics_armor. */
+    _Atomic uint64_t incoming;
+    /** See analytics_armor. */
+    _Atomic uint64_t mitigated;
+};
+
+/** Set while recording. */
+static atomic_bool analytics_recording = false;
+/** Names of the weapon slots. */
+static struct analytics_key analytics_weapon_keys[ANALYTICS_MAX_WEAPONS];
+/** Weapon slots, the last one for weapons past a full table. */
+static struct analytics_weapon_slot analytics_weapons[ANALYTICS_MAX_WEAPONS + 1];
+/** Names of the armor slots. */
+static struct analytics_key analytics_armor_keys[ANALYTICS_MAX_ARMORS];
+/** Armor slots, the last one for armors past a full table. */
+static struct analytics_armor_slot analytics_armors[ANALYTICS_MAX_ARMORS + 1];
+/** Hits taken by killed players. */
+static struct analytics_histogram analytics_hits_to_kill;
+
+/**
+ * @brief FNV-1a hash of a name, never 0 as 0 marks free slots.
+ */
+static uint64_t analytics_hash(const char *name)
+{
+    uint64_t hash = UINT64_C(14695981039346656037);
+    for (const unsigned char *c = (const unsigned char *)name; *c; c++) {
+        hash = (hash ^ *c) * UINT64_C(1099511628211);
+    }
+
+    return hash ? hash : 1;
+}
+
+/**
+ * @brief Finds the slot of a name, claiming a free one if asked to.
+ *
+ * Open addressing with linear probing. Slots are never given back, so a name keeps its slot for good.
+ *
+ * @return Index of the slot, capacity if the name is not there, or the table is full when claiming.
+ */
+static size_t analytics_find_slot(const char *name, struct analytics_key *keys, const size_t capacity, const bool claim)
+{
+    const uint64_t hash = analytics_hash(name);
+    for (size_t probe = 0; probe < capacity; probe++) {
+        const size_t index = (size_t)(hash + probe) & (capacity - 1);
+        struct analytics_key *k = &keys[index];
+        uint64_t seen = atomic_load_explicit(&k->hash, memory_order_acquire);
+        if (seen == 0) {
+            if (!claim) {
+                return capacity;
+            }
+            if (atomic_compare_exchange_strong_explicit(&k->hash, &seen, hash, memory_order_acq_rel, memory_order_acquire)) {
+                strncpy(k->name, name, ANALYTICS_NAME_SIZE - 1);
+                k->name[ANALYTICS_NAME_SIZE - 1] = '\0';
+                atomic_store_explicit(&k->ready, true, memory_order_release);
+                return index;
+            }
+            // Another thread claimed it first, seen now holds its hash
+        }
+        if (seen == hash) {
+            return index;
+        }
+    }
+
+    return capacity;
+}
+
+/**
+ * @brief Gets the bucket of a value.
+ */
+static size_t analytics_bucket(const unsigned int value)
+{
+    if (value < (1u << ANALYTICS_SUB_BITS)) {
+        return value;
+    }
+
+    unsigned int msb = 0;
+    for (unsigned int rest = value; rest > 1; rest >>= 1) {
+        msb++;
+    }
+    // Buckets above the exact ones are 1 << shift wide, 1 << (ANALYTICS_SUB_BITS - 1) per power of two
+    const unsigned int shift = msb - ANALYTICS_SUB_BITS + 1;
+    return (1u << ANALYTICS_SUB_BITS) + (size_t)(shift - 1) * (1u << (ANALYTICS_SUB_BITS - 1)) +
+           ((value >> shift) - (1u << (ANALYTICS_SUB_BITS - 1)));
+}
+
+/**
+ * @brief Gets the highest value of a bucket.
+ */
+static unsigned int analytics_bucket_highest(const size_t bucket)
+{
+    if (bucket < (1u << ANALYTICS_SUB_BITS)) {
+        return (unsigned int)bucket;
+    }
+
+    const size_t above = bucket - (1u << ANALYTICS_SUB_BITS);
+    const unsigned int shift = (unsigned int)(above / (1u << (ANALYTICS_SUB_BITS - 1))) + 1;
+    const uint64_t lowest = (uint64_t)(above % (1u << (ANALYTICS_SUB_BITS - 1)) + (1u << (ANALYTICS_SUB_BITS - 1))) << shift;
+    return (unsigned int)(lowest + (UINT64_C(1) << shift) - 1);
+}
+
+static void analytics_histogram_record(const unsigned int value, struct analytics_histogram *h)
+{
+    atomic_fetch_add_explicit(&h->counts[analytics_bucket(value)], 1, memory_order_relaxed);
+
+    unsigned int max = atomic_load_explicit(&h->max, memory_order_relaxed);
+    while (value > max && !atomic_compare_exchange_weak_explicit(&h->max, &max, value, memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+/**
+ * @brief Gets several quantiles in one walk over the buckets.
+ *
+ * @param[in] quantiles Quantiles, ascending.
+ * @param[in] total Number of quantiles.
+ * @param[out] values Highest value of the bucket holding each quantile, 0 for an empty histogram.
+ */
+static void analytics_histogram_quantiles(const struct analytics_histogram *h, const double *quantiles, const size_t total, unsigned int *values)
+{
+    uint64_t counts[ANALYTICS_HISTOGRAM_BUCKETS];
+    uint64_t recorded = 0;
+    for (size_t i = 0; i < ANALYTICS_HISTOGRAM_BUCKETS; i++) {
+        counts[i] = atomic_load_explicit(&h->counts[i], memory_order_relaxed);
+        recorded += counts[i];
+    }
+
+    size_t bucket = 0;
+    uint64_t seen = 0;
+    for (size_t q = 0; q < total; q++) {
+        values[q] = 0;
+        if (recorded == 0) {
+            continue;
+        }
+
+        const double clamped = quantiles[q] < 0.0 ? 0.0 : (quantiles[q] > 1.0 ? 1.0 : quantiles[q]);
+        uint64_t rank = (uint64_t)(clamped * (double)recorded + 0.999999);
+        rank = rank == 0 ? 1 : (rank > recorded ? recorded : rank);
+        while (bucket < ANALYTICS_HISTOGRAM_BUCKETS && seen + counts[bucket] < rank) {
+            seen += counts[bucket++];
+        }
+        if (bucket < ANALYTICS_HISTOGRAM_BUCKETS) {
+            values[q] = analytics_bucket_highest(bucket);
+        }
+    }
+
+    // No bucket reports more than was ever recorded
+    const unsigned int max = atomic_load_explicit(&h->max, memory_order_relaxed);
+    for (size_t q = 0; q < total; q++) {
+        values[q] = values[q] > max ? max : values[q];
+    }
+}
+
+static void analytics_read_weapon(const size_t slot, struct analytics_weapon *w)
+{
+    const struct analytics_weapon_slot *s = &analytics_weapons[slot];
+    if (slot == ANALYTICS_MAX_WEAPONS) {
+        strcpy(w->name, ANALYTICS_OTHER_NAME);
+    } else {
+        memcpy(w->name, analytics_weapon_keys[slot].name, ANALYTICS_NAME_SIZE);
+    }
+    w->attacks = atomic_load_explicit(&s->attacks, memory_order_relaxed);
+    w->crits = atomic_load_explicit(&s->crits, memory_order_relaxed);
+    w->damage = atomic_load_explicit(&s->damage, memory_order_relaxed);
+    w->damage_max = atomic_load_explicit(&s->hits.max, memory_order_relaxed);
+
+    const double quantiles[3] = { 0.5, 0.9, 0.99 };
+    unsigned int values[3] = {0};
+    analytics_histogram_quantiles(&s->hits, quantiles, 3, values);
+    w->damage_p50 = values[0];
+    w->damage_p90 = values[1];
+    w->damage_p99 = values[2];
+}
+
+static void analytics_read_armor(const size_t slot, struct analytics_armor *a)
+{
+    const struct analytics_armor_slot *s = &analytics_armors[slot];
+    if (slot == ANALYTICS_MAX_ARMORS) {
+        strcpy(a->name, ANALYTICS_OTHER_NAME);
+    } else {
+        memcpy(a->name, analytics_armor_keys[slot].name, ANALYTICS_NAME_SIZE);
+    }
+    a->attacks = atomic_load_explicit(&s->attacks, memory_order_relaxed);
+    a->incoming = atomic_load_explicit(&s->incoming, memory_order_relaxed);
+    a->mitigated = atomic_load_explicit(&s->mitigated, memory_order_relaxed);
+}
+
+/**
+ * @brief Writes a string as a JSON string.
+ */
+static void analytics_dump_string(FILE *out, const char *s)
+{
+    fputc('"', out);
+    for (const unsigned char *c = (const unsigned char *)s; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            fprintf(out, "\\%c", *c);
+        } else if (*c < 0x20) {
+            fprintf(out, "\\u%04x", *c);
+        } else {
+            fputc(*c, out);
+        }
+    }
+    fputc('"', out);
+}
+
+void analytics_enable(const bool enabled)
+{
+    atomic_store_explicit(&analytics_recording, enabled, memory_order_relaxed);
+}
+
+bool analytics_is_enabled(void)
+{
+    return atomic_load_explicit(&analytics_recording, memory_order_relaxed);
+}
+
+void analytics_record_attack(const char *weapon_name, const char *armor_name, const unsigned int weapon_damage, const unsigned int normal_damage, const unsigned int dealt, const unsigned int hits_to_kill)
+{
+    if (!weapon_name || !atomic_load_explicit(&analytics_recording, memory_order_relaxed)) {
+        return;
+    }
+
+    struct analytics_weapon_slot *w = &analytics_weapons[analytics_find_slot(weapon_name, analytics_weapon_keys, ANALYTICS_MAX_WEAPONS, true)];
+    atomic_fetch_add_explicit(&w->attacks, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&w->crits, dealt > normal_damage ? 1 : 0, memory_order_relaxed);
+    atomic_fetch_add_explicit(&w->damage, dealt, memory_order_relaxed);
+    analytics_histogram_record(dealt, &w->hits);
+
+    struct analytics_armor_slot *a = &analytics_armors[analytics_find_slot(armor_name ? armor_name : ANALYTICS_NO_ARMOR_NAME, analytics_armor_keys, ANALYTICS_MAX_ARMORS, true)];
+    atomic_fetch_add_explicit(&a->attacks, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&a->incoming, weapon_damage, memory_order_relaxed);
+    atomic_fetch_add_explicit(&a->mitigated, normal_damage, memory_order_relaxed);
+
+    if (hits_to_kill > 0) {
+        analytics_histogram_record(hits_to_kill, &analytics_hits_to_kill);
+    }
+}
+
+bool analytics_get_weapon(const char *weapon_name, struct analytics_weapon *w)
+{
+    if (!weapon_name || !w) {
+        return false;
+    }
+
+    const size_t slot = analytics_find_slot(weapon_name, analytics_weapon_keys, ANALYTICS_MAX_WEAPONS, false);
+    if (slot == ANALYTICS_MAX_WEAPONS || !atomic_load_explicit(&analytics_weapon_keys[slot].ready, memory_order_acquire)) {
+        return false;
+    }
+
+    analytics_read_weapon(slot, w);
+    return true;
+}
+
+bool analytics_get_armor(const char *armor_name, struct analytics_armor *a)
+{
+    if (!a) {
+        return false;
+    }
+
+    const size_t slot = analytics_find_slot(armor_name ? armor_name : ANALYTICS_NO_ARMOR_NAME, analytics_armor_keys, ANALYTICS_MAX_ARMORS, false);
+    if (slot == ANALYTICS_MAX_ARMORS || !atomic_load_explicit(&analytics_armor_keys[slot].ready, memory_order_acquire)) {
+        return false;
+    }
+
+    analytics_read_armor(slot, a);
+    return true;
+}
+
+unsigned int analytics_hits_to_kill_quantile(const double quantile)
+{
+    unsigned int value = 0;
+    analytics_histogram_quantiles(&analytics_hits_to_kill, &quantile, 1, &value);
+    return value;
+}
+
+bool analytics_dump(FILE *out)
+{
+    if (!out) {
+        return false;
+    }
+
+    fprintf(out, "{\"weapons\":[");
+    bool first = true;
+    for (size_t i = 0; i <= ANALYTICS_MAX_WEAPONS; i++) {
+        if (i < ANALYTICS_MAX_WEAPONS && !atomic_load_explicit(&analytics_weapon_keys[i].ready, memory_order_acquire)) {
+            continue;
+        }
+        struct analytics_weapon w = {0};
+        analytics_read_weapon(i, &w);
+        if (w.attacks == 0) {
+            continue;
+        }
+        fprintf(out, "%s{\"name\":", first ? "" : ",");
+        analytics_dump_string(out, w.name);
+        fprintf(out, ",\"attacks\":%" PRIu64 ",\"crits\":%" PRIu64 ",\"crit_rate\":%.4f,\"damage\":%" PRIu64
+                ",\"damage_p50\":%u,\"damage_p90\":%u,\"damage_p99\":%u,\"damage_max\":%u}",
+                w.attacks, w.crits, (double)w.crits / (double)w.attacks, w.damage,
+                w.damage_p50, w.damage_p90, w.damage_p99, w.damage_max);
+        first = false;
+    }
+
+    fprintf(out, "],\"armors\":[");
+    first = true;
+    for (size_t i = 0; i <= ANALYTICS_MAX_ARMORS; i++) {
+        if (i < ANALYTICS_MAX_ARMORS && !atomic_load_explicit(&analytics_armor_keys[i].ready, memory_order_acquire)) {
+            continue;
+        }
+        struct analytics_armor a = {0};
+        analytics_read_armor(i, &a);
+        if (a.attacks == 0) {
+            continue;
+        }
+        fprintf(out, "%s{\"name\":", first ? "" : ",");
+        analytics_dump_string(out, a.name);
+        fprintf(out, ",\"attacks\":%" PRIu64 ",\"incoming\":%" PRIu64 ",\"mitigated\":%" PRIu64 ",\"mitigation\":%.4f}",
+                a.attacks, a.incoming, a.mitigated, a.incoming ? 1.0 - (double)a.mitigated / (double)a.incoming : 0.0);
+        first = false;
+    }
+
+    const double quantiles[3] = { 0.5, 0.9, 0.99 };
+    unsigned int hits[3] = {0};
+    analytics_histogram_quantiles(&analytics_hits_to_kill, quantiles, 3, hits);
+    fprintf(out, "],\"hits_to_kill\":{\"p50\":%u,\"p90\":%u,\"p99\":%u,\"max\":%u}}\n",
+            hits[0], hits[1], hits[2], atomic_load_explicit(&analytics_hits_to_kill.max, memory_order_relaxed));
+
+    return fflush(out) == 0 && !ferror(out);
+}
+
+void analytics_reset(void)
+{
+    // Plain stores are fine, nothing records meanwhile
+    memset(analytics_weapon_keys, 0, sizeof(analytics_weapon_keys));
+    memset(analytics_weapons, 0, sizeof(analytics_weapons));
+    memset(analytics_armor_keys, 0, sizeof(analytics_armor_keys));
+    memset(analytics_armors, 0, sizeof(analytics_armors));
+    memset(&analytics_hits_to_kill, 0, sizeof(analytics_hits_to_kill));
+}
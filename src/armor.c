@@ -1,24 +1,29 @@
 /*! Armor implementation file */
 
 #include "headers/armor.h"
-#include "headers/compatibility.h"
+#include "headers/alloc.h"
+#include "headers/error.h"
+#include "headers/report.h"
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
+static bool armor_is_valid(const char *name, const unsigned int health, const unsigned int max_health, const unsigned int resistance_force)
+{
+    return name && name[0] != '\0' && health > 0 && max_health > 0 && health <= max_health && resistance_force > 0;
+}
+
 bool armor_initialize(const char *name, const unsigned int health, const unsigned int max_health, const unsigned int resistance_force, struct armor *a)
 {
-    if (!name || name[0] == '\0' || health == 0 || max_health == 0 || health > max_health || resistance_force == 0 || !a) {
-        return false;
+    if (!armor_is_valid(name, health, max_health, resistance_force) || !a) {
+        return error_set(!name || !a ? ERROR_NULL_ARGUMENT : ERROR_INVALID_ARGUMENT, "armor_initialize");
     }
 
-    size_t name_length = strlen(name);
-    a->armor_name = malloc(name_length + 1);
-    if (!a->armor_name) {
+    if (!name_initialize(name, &a->armor_name)) {
         return false;
     }
-    strcpy_s(a->armor_name, name_length + 1, name);
     a->_armor_health = health;
     a->_armor_max_health = max_health;
     a->_armor_resistance_force = resistance_force;
@@ -26,6 +31,42 @@ bool armor_initialize(const char *name, const unsigned int health, const unsigne
     return true;
 }
 
+bool armor_batch_initialize(const struct armor_spec *specs, const size_t total, struct armor_batch *batch)
+{
+    if (!specs || total == 0 || total > SIZE_MAX / sizeof(struct armor) || !batch) {
+        return error_set(!specs || !batch ? ERROR_NULL_ARGUMENT : ERROR_INVALID_ARGUMENT, "armor_batch_initialize");
+    }
+
+    memset(batch, 0, sizeof(*batch));
+    size_t names_size = 0;
+    for (size_t i = 0; i < total; i++) {
+        if (!armor_is_valid(specs[i].name, specs[i].health, specs[i].max_health, specs[i].resistance_force)) {
+            return error_set(ERROR_INVALID_ARGUMENT, "armor_batch_initialize");
+        }
+        names_size += name_external_size(specs[i].name);
+    }
+
+    batch->armors = alloc_malloc(total * sizeof(*batch->armors), ALLOC_TAG_ARMOR);
+    batch->names = names_size ? alloc_malloc(names_size, ALLOC_TAG_ARMOR) : NULL;
+    if (!batch->armors || (names_size && !batch->names)) {
+        armor_batch_deinitialize(batch);
+        return error_set(ERROR_OUT_OF_MEMORY, "armor_batch_initialize");
+    }
+
+    char *storage = batch->names;
+    for (size_t i = 0; i < total; i++) {
+        struct armor *a = &batch->armors[i];
+        name_initialize_in(specs[i].name, storage, &a->armor_name);
+        storage += name_external_size(specs[i].name);
+        a->_armor_health = specs[i].health;
+        a->_armor_max_health = specs[i].max_health;
+        a->_armor_resistance_force = specs[i].resistance_force;
+    }
+    batch->size = total;
+
+    return true;
+}
+
 unsigned int armor_get_health(const struct armor *a)
 {
     if (!a) {
@@ -67,14 +108,27 @@ void armor_repair_armor(const unsigned int repair_amount, struct armor *a)
 	}
 }
 
+void armor_wear_armor(const unsigned int wear_amount, struct armor *a)
+{
+    if (wear_amount == 0 || !a) {
+        return;
+    }
+
+    a->_armor_health = (a->_armor_health > wear_amount) ? a->_armor_health - wear_amount : 0;
+}
+
 void armor_print_stats(const struct armor *a)
 {
     if (!a) {
         return;
     }
 
-    printf("Armor name: %s\nArmor health: %u\nArmor max health: %u\nArmor resistance: %u\n", 
-        a->armor_name, a->_armor_health, a->_armor_max_health, a->_armor_resistance_force);
+    struct report r = {0};
+    if (!report_initialize(REPORT_FORMAT_HUMAN, 256, stdout, &r)) {
+        return;
+    }
+    report_write_armor(&r, NULL, a);
+    report_deinitialize(&r);
 }
 
 bool armor_is_equal(const struct armor *a1, const struct armor *a2)
@@ -83,7 +137,7 @@ bool armor_is_equal(const struct armor *a1, const struct armor *a2)
         return false;
     }
 
-    return strcmp(a1->armor_name, a2->armor_name) == 0 &&
+    return name_equals(&a1->armor_name, name_get(&a2->armor_name)) &&
     a1->_armor_health == a2->_armor_health &&
     a1->_armor_max_health == a2->_armor_health &&
     a1->_armor_resistance_force == a2->_armor_resistance_force;
@@ -95,14 +149,9 @@ void armor_add_armor(const struct armor *a1, const struct armor *a2, struct armo
         return;
     }
 
-    size_t total_len = strlen(a1->armor_name) + 1 + strlen(a2->armor_name) + 1;
-    added_armor->armor_name = malloc(total_len);
-    if (!added_armor->armor_name) {
+    if (!name_join(name_get(&a1->armor_name), ':', name_get(&a2->armor_name), &added_armor->armor_name)) {
         return;
     }
-    strcpy_s(added_armor->armor_name, total_len, a1->armor_name);
-    strcat_s(added_armor->armor_name, total_len, ":");
-    strcat_s(added_armor->armor_name, total_len, a2->armor_name);
 
     added_armor->_armor_health = a1->_armor_health + a2->_armor_health;
     added_armor->_armor_max_health = a1->_armor_max_health + a2->_armor_max_health;
@@ -111,13 +160,24 @@ void armor_add_armor(const struct armor *a1, const struct armor *a2, struct armo
 
 void armor_deinitialize(struct armor *a)
 {
-    if (!a || !a->armor_name) {
+    if (!a || name_is_empty(&a->armor_name)) {
         return;
     }
-    free(a->armor_name);
-    a->armor_name = NULL;
+    name_deinitialize(&a->armor_name);
     a->_armor_health = 0;
     a->_armor_max_health = 0;
     a->_armor_resistance_force = 0;
     memset(a, 0, sizeof(*a));
+}
+
+void armor_batch_deinitialize(struct armor_batch *batch)
+{
+    if (!batch) {
+        return;
+    }
+
+    // Names are inline or in batch->names, the armors own nothing else
+    alloc_free(batch->armors);
+    alloc_free(batch->names);
+    memset(batch, 0, sizeof(*batch));
 }
\ No newline at end of file
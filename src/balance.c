@@ -0,0 +1,620 @@
+/*! Balance analyzer implementation file */
+
+#include "headers/balance.h"
+#include "headers/damage.h"
+#include "headers/player.h"
+#include "headers/tokenizer.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Longest name accepted in a catalog. */
+#define CATALOG_NAME_SIZE 128
+/** Read size used for catalogs. */
+#define CATALOG_BLOCK_SIZE (64 * 1024)
+/** Chance of a critical hit, from the damage model. */
+#define BALANCE_CRIT_CHANCE ((double)DAMAGE_CRIT_NUMERATOR / DAMAGE_CRIT_DENOMINATOR)
+/** Seed of the sampled cells. Each cell draws from its own stream, so results do not depend on scheduling. */
+#define BALANCE_SEED 42u
+
+/**
+ * @struct ttk_distribution
+ * @brief Distribution of the hits needed to kill, for one base damage per hit.
+ */
+struct ttk_distribution {
+    /** Damage per hit before critical hits, after the armor formula. */
+    unsigned int base_damage;
+    /** cdf[n] is the probability that n hits or fewer kill, for n up to max_turns. */
+    double *cdf;
+    /** Fewest hits that can kill, max_turns + 1 if none can. */
+    unsigned int min_hits;
+    /** Hits after which the kill is certain, max_turns if never. */
+    unsigned int max_hits;
+};
+
+/**
+ * @struct balance_context
+ * @brief Everything the row jobs share.
+ */
+struct balance_context {
+    /** Matrix being filled. */
+    struct balance_matrix *m;
+    /** Duel rules. */
+    const struct balance_config *config;
+    /** One distribution per distinct base damage. */
+    struct ttk_distribution *distributions;
+    /** Number of distributions. */
+    size_t total_distributions;
+    /** Distribution of attacking weapon w against armor a, at [w * total_armors + a]. */
+    const struct ttk_distribution **pair_distributions;
+};
+
+/**
+ * @struct balance_row
+ * @brief Job argument for one attacker loadout.
+ */
+struct balance_row {
+    /** Shared context. */
+    const struct balance_context *ctx;
+    /** Attacker loadout index. */
+    size_t attacker;
+};
+
+struct balance_config balance_default_config(void)
+{
+    const struct balance_config config = {
+        .health = 100,
+        .heal_per_turn = 0,
+        .weapon_wear = false,
+        .max_turns = 1000,
+        .samples = 2000
+    };
+    return config;
+}
+
+/**
+ * @brief Releases the weapons and armors loaded so far.
+ *
+ * @param[in] weapons Pointer to weapon vector.
+ * @param[in] armors Pointer to armor vector.
+ */
+static void balance_free_catalog(struct vector *weapons, struct vector *armors)
+{
+    struct weapon *w = vector_items(weapons);
+    for (size_t i = 0; i < weapons->size; i++) {
+        weapon_deinitialize(&w[i]);
+    }
+    struct armor *a = vector_items(armors);
+    for (size_t i = 0; i < armors->size; i++) {
+        armor_deinitialize(&a[i]);
+    }
+    vector_deinitialize(weapons);
+    vector_deinitialize(armors);
+}
+
+/**
+ * @brief Parses one catalog entry and appends it.
+ *
+ * @param[in] line Line to parse.
+ * @param[in,out] weapons Pointer to weapon vector.
+ * @param[in,out] armors Pointer to armor vector.
+ * @return true if the line was an entry or skippable, false on parse errors.
+ */
+static bool balance_parse_entry(const struct string_view line, struct vector *weapons, struct vector *armors)
+{
+    struct tokenizer t = {0};
+    struct string_view kind = {0};
+    struct string_view name = {0};
+    struct string_view numbers[3] = {0};
+    unsigned int values[3] = {0};
+    char name_buffer[CATALOG_NAME_SIZE];
+
+    tokenizer_initialize(line.data, line.length, &t);
+    if (!tokenizer_next_token(&t, &kind) || kind.data[0] == '#') {
+        return true;
+    }
+
+    const bool is_weapon = string_view_equals(kind, "weapon");
+    const bool is_armor = string_view_equals(kind, "armor");
+    const size_t total_numbers = is_weapon ? 2 : 3;
+    if ((!is_weapon && !is_armor) || !tokenizer_next_token(&t, &name) ||
+        !string_view_copy(name, sizeof(name_buffer), name_buffer)) {
+        return false;
+    }
+    for (size_t i = 0; i < total_numbers; i++) {
+        if (!tokenizer_next_token(&t, &numbers[i]) || !string_view_parse_uint(numbers[i], &values[i])) {
+            return false;
+        }
+    }
+    if (tokenizer_remaining(&t).length > 0) {
+        return false;
+    }
+
+    if (is_weapon) {
+        struct weapon w = {0};
+        if (!weapon_initialize(name_buffer, values[0], values[1], &w)) {
+            return false;
+        }
+        if (!vector_push_back(weapons, &w)) {
+            weapon_deinitialize(&w);
+            return false;
+        }
+        return true;
+    }
+
+    struct armor a = {0};
+    if (!armor_initialize(name_buffer, values[0], values[1], values[2], &a)) {
+        return false;
+    }
+    if (!vector_push_back(armors, &a)) {
+        armor_deinitialize(&a);
+        return false;
+    }
+    return true;
+}
+
+bool balance_load_catalog(const char *path, struct vector *weapons, struct vector *armors)
+{
+    if (!path || !weapons || !armors) {
+        return false;
+    }
+
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "cannot open %s at balance_load_catalog()\n", path);
+        return false;
+    }
+
+    struct line_reader lr = {0};
+    if (!line_reader_initialize(file, CATALOG_BLOCK_SIZE, &lr)) {
+        fclose(file);
+        return false;
+    }
+    if (!vector_initialize(16, sizeof(struct weapon), weapons) || !vector_initialize(16, sizeof(struct armor), armors)) {
+        vector_deinitialize(weapons);
+        line_reader_deinitialize(&lr);
+        fclose(file);
+        return false;
+    }
+
+    bool ok = true;
+    size_t line_number = 0;
+    struct string_view line = {0};
+    while (ok && line_reader_next_line(&lr, &line)) {
+        line_number++;
+        if (!balance_parse_entry(line, weapons, armors)) {
+            fprintf(stderr, "invalid entry on line %zu of %s at balance_load_catalog()\n", line_number, path);
+            ok = false;
+        }
+    }
+    if (line_reader_has_failed(&lr)) {
+        fprintf(stderr, "read failed at balance_load_catalog()\n");
+        ok = false;
+    }
+
+    line_reader_deinitialize(&lr);
+    fclose(file);
+    if (!ok) {
+        balance_free_catalog(weapons, armors);
+    }
+    return ok;
+}
+
+/**
+ * @brief Fills the distribution of hits to kill for its base damage.
+ *
+ * n hits with k crits deal n * d + k * (c - d), so n hits kill when k reaches
+ * ceil((health - n * d) / (c - d)), a binomial tail.
+ *
+ * @param[in,out] dist Pointer to distribution struct with base_damage set.
+ * @param[in] health Health to take away.
+ * @param[in] max_turns Last n to compute.
+ * @param[in] log_factorials log(i!) for i up to max_turns.
+ */
+static void balance_fill_distribution(struct ttk_distribution *dist, const unsigned int health, const unsigned int max_turns, const double *log_factorials)
+{
+    const uint64_t d = dist->base_damage;
+    const uint64_t extra = damage_apply_crit(dist->base_damage, true) - dist->base_damage;
+    const double log_p = log(BALANCE_CRIT_CHANCE);
+    const double log_q = log(1.0 - BALANCE_CRIT_CHANCE);
+
+    dist->cdf[0] = 0.0;
+    for (uint64_t n = 1; n <= max_turns; n++) {
+        if (d == 0) {
+            dist->cdf[n] = 0.0;
+            continue;
+        }
+        if (n * d >= health) {
+            dist->cdf[n] = 1.0;
+            continue;
+        }
+        if (extra == 0 || DAMAGE_CRIT_NUMERATOR == 0) {
+            dist->cdf[n] = 0.0;
+            continue;
+        }
+
+        const uint64_t crits_needed = (health - n * d + extra - 1) / extra;
+        if (DAMAGE_CRIT_NUMERATOR == DAMAGE_CRIT_DENOMINATOR) {
+            dist->cdf[n] = crits_needed <= n ? 1.0 : 0.0;
+            continue;
+        }
+        double tail = 0.0;
+        for (uint64_t k = crits_needed; k <= n; k++) {
+            tail += exp(log_factorials[n] - log_factorials[k] - log_factorials[n - k] + (double)k * log_p + (double)(n - k) * log_q);
+        }
+        dist->cdf[n] = tail > 1.0 ? 1.0 : tail;
+    }
+
+    dist->min_hits = max_turns + 1;
+    dist->max_hits = max_turns;
+    for (unsigned int n = max_turns; n >= 1; n--) {
+        if (dist->cdf[n] > 0.0) {
+            dist->min_hits = n;
+        }
+        if (dist->cdf[n] >= 1.0) {
+            dist->max_hits = n;
+        }
+    }
+}
+
+/**
+ * @brief Solves a matchup exactly from both hits to kill distributions.
+ *
+ * The attacker wins at its n-th hit if the defender has not killed it with its first n - 1 hits.
+ * Only the hit counts where either side can land the kill are visited.
+ *
+ * @param[in] attacker Distribution of the attacker's hits to kill.
+ * @param[in] defender Distribution of the defender's hits to kill.
+ * @param[in] max_turns Attacks per side.
+ * @param[out] cell Pointer to cell struct.
+ */
+static void balance_solve_cell(const struct ttk_distribution *attacker, const struct ttk_distribution *defender, const unsigned int max_turns, struct balance_cell *cell)
+{
+    const double *attacker_cdf = attacker->cdf;
+    const double *defender_cdf = defender->cdf;
+    const unsigned int first = attacker->min_hits < defender->min_hits ? attacker->min_hits : defender->min_hits;
+    unsigned int last = attacker->max_hits > defender->max_hits ? attacker->max_hits : defender->max_hits;
+    if (last > max_turns) {
+        last = max_turns;
+    }
+
+    double win = 0.0;
+    double loss = 0.0;
+    double turns = 0.0;
+    for (unsigned int n = first; n <= last; n++) {
+        const double attacker_kills_at_n = attacker_cdf[n] - attacker_cdf[n - 1];
+        const double defender_kills_at_n = defender_cdf[n] - defender_cdf[n - 1];
+        const double won_at_n = attacker_kills_at_n * (1.0 - defender_cdf[n - 1]);
+        win += won_at_n;
+        loss += defender_kills_at_n * (1.0 - attacker_cdf[n]);
+        turns += won_at_n * n;
+    }
+
+    cell->win_probability = win;
+    cell->draw_probability = fmax(0.0, 1.0 - win - loss);
+    cell->mean_turns_to_kill = win > 0.0 ? turns / win : 0.0;
+    cell->sampled = false;
+}
+
+/**
+ * @brief Checks if a weapon can break before it kills, which makes the duel path dependent.
+ *
+ * @param[in] w Pointer to weapon struct.
+ * @param[in] base_damage Damage per hit against the defender's armor.
+ * @param[in] config Duel rules.
+ * @return true if the weapon may break, false otherwise.
+ */
+static bool balance_weapon_may_break(const struct weapon *w, const unsigned int base_damage, const struct balance_config *config)
+{
+    if (!config->weapon_wear || base_damage == 0) {
+        return false;
+    }
+
+    uint64_t max_hits = (config->health + (uint64_t)base_damage - 1) / base_damage;
+    if (max_hits > config->max_turns) {
+        max_hits = config->max_turns;
+    }
+    return max_hits * (damage_apply_crit(base_damage, true) / 10) >= w->weapon_health;
+}
+
+/**
+ * @brief Plays one attack: rolls the damage, applies it and wears the weapon.
+ *
+ * @param[in,out] w Attacking weapon, a copy owned by the duel.
+ * @param[in] resistance Defender's armor resistance.
+ * @param[in,out] health Defender's health.
+ * @param[in] config Duel rules.
+ * @param[in,out] rng Random state.
+ */
+static void balance_strike(struct weapon *w, const unsigned int resistance, unsigned int *health, const struct balance_config *config, pcg32_random_t *rng)
+{
+    if (config->weapon_wear && w->weapon_health == 0) {
+        return;
+    }
+
+    const unsigned int damage = crit(w->weapon_damage, resistance, rng);
+    *health = (*health > damage) ? *health - damage : 0;
+    if (config->weapon_wear) {
+        weapon_use(damage / 10, w);
+    }
+}
+
+/**
+ * @brief Estimates a path dependent matchup by playing many duels.
+ *
+ * @param[in] ctx Shared context.
+ * @param[in] attacker Attacker loadout.
+ * @param[in] defender Defender loadout.
+ * @param[in,out] rng Random state.
+ * @param[out] cell Pointer to cell struct.
+ */
+static void balance_sample_cell(const struct balance_context *ctx, const size_t attacker, const size_t defender, pcg32_random_t *rng, struct balance_cell *cell)
+{
+    const struct balance_config *config = ctx->config;
+    const size_t total_armors = ctx->m->armors->size;
+    const struct weapon *weapons = vector_items(ctx->m->weapons);
+    const struct armor *armors = vector_items(ctx->m->armors);
+    const unsigned int attacker_resistance = armors[attacker % total_armors]._armor_resistance_force;
+    const unsigned int defender_resistance = armors[defender % total_armors]._armor_resistance_force;
+
+    unsigned int wins = 0;
+    unsigned int losses = 0;
+    double turns = 0.0;
+    for (unsigned int s = 0; s < config->samples; s++) {
+        // Copies share the catalog's names but only their health changes
+        struct weapon attacker_weapon = weapons[attacker / total_armors];
+        struct weapon defender_weapon = weapons[defender / total_armors];
+        unsigned int attacker_health = config->health;
+        unsigned int defender_health = config->health;
+
+        for (unsigned int n = 1; n <= config->max_turns; n++) {
+            balance_strike(&attacker_weapon, defender_resistance, &defender_health, config, rng);
+            if (defender_health == 0) {
+                wins++;
+                turns += n;
+                break;
+            }
+            defender_health += config->heal_per_turn;
+
+            balance_strike(&defender_weapon, attacker_resistance, &attacker_health, config, rng);
+            if (attacker_health == 0) {
+                losses++;
+                break;
+            }
+            attacker_health += config->heal_per_turn;
+        }
+    }
+
+    cell->win_probability = (double)wins / config->samples;
+    cell->draw_probability = (double)(config->samples - wins - losses) / config->samples;
+    cell->mean_turns_to_kill = wins > 0 ? turns / wins : 0.0;
+    cell->sampled = true;
+}
+
+/**
+ * @brief Fills one row of the matrix. Runs as a job.
+ *
+ * @param[in] arg Pointer to row struct.
+ * @param[in,out] rng Random state of the running worker, unused since cells seed their own.
+ */
+static void balance_row_job(void *arg, pcg32_random_t *rng)
+{
+    (void)rng;
+    const struct balance_row *row = arg;
+    const struct balance_context *ctx = row->ctx;
+    const struct balance_config *config = ctx->config;
+    struct balance_matrix *m = ctx->m;
+    const size_t total_armors = m->armors->size;
+    const struct weapon *weapons = vector_items(m->weapons);
+
+    const size_t a = row->attacker;
+    const size_t a_weapon = a / total_armors;
+    const size_t a_armor = a % total_armors;
+    for (size_t d = 0; d < m->total_loadouts; d++) {
+        const size_t d_weapon = d / total_armors;
+        const size_t d_armor = d % total_armors;
+        const struct ttk_distribution *attacker_dist = ctx->pair_distributions[a_weapon * total_armors + d_armor];
+        const struct ttk_distribution *defender_dist = ctx->pair_distributions[d_weapon * total_armors + a_armor];
+        struct balance_cell *cell = &m->cells[a * m->total_loadouts + d];
+
+        const bool either_hits = attacker_dist->base_damage > 0 || defender_dist->base_damage > 0;
+        const bool path_dependent = either_hits && (config->heal_per_turn > 0 ||
+            balance_weapon_may_break(&weapons[a_weapon], attacker_dist->base_damage, config) ||
+            balance_weapon_may_break(&weapons[d_weapon], defender_dist->base_damage, config));
+
+        if (path_dependent) {
+            pcg32_random_t cell_rng = {0};
+            pcg32_srandom_r(&cell_rng, BALANCE_SEED, a * m->total_loadouts + d);
+            balance_sample_cell(ctx, a, d, &cell_rng, cell);
+        } else {
+            balance_solve_cell(attacker_dist, defender_dist, config->max_turns, cell);
+        }
+    }
+}
+
+/**
+ * @brief Orders base damages for deduplication.
+ *
+ * @param[in] a Pointer to unsigned int.
+ * @param[in] b Pointer to unsigned int.
+ * @return Negative, zero or positive like strcmp.
+ */
+static int balance_uint_cmp(const void *a, const void *b)
+{
+    const unsigned int x = *(const unsigned int *)a;
+    const unsigned int y = *(const unsigned int *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Builds one distribution per distinct base damage and maps every weapon and armor pair to one.
+ *
+ * @param[in,out] ctx Context with m and config set.
+ * @return true if success, false otherwise.
+ */
+static bool balance_build_distributions(struct balance_context *ctx)
+{
+    const struct balance_config *config = ctx->config;
+    const size_t total_weapons = ctx->m->weapons->size;
+    const size_t total_armors = ctx->m->armors->size;
+    const size_t total_pairs = total_weapons * total_armors;
+    const struct weapon *weapons = vector_items(ctx->m->weapons);
+    const struct armor *armors = vector_items(ctx->m->armors);
+
+    unsigned int *damages = malloc(total_pairs * sizeof(*damages));
+    double *log_factorials = malloc(((size_t)config->max_turns + 1) * sizeof(*log_factorials));
+    ctx->pair_distributions = malloc(total_pairs * sizeof(*ctx->pair_distributions));
+    ctx->distributions = malloc(total_pairs * sizeof(*ctx->distributions));
+    if (!damages || !log_factorials || !ctx->pair_distributions || !ctx->distributions) {
+        free(damages);
+        free(log_factorials);
+        return false;
+    }
+
+    for (size_t w = 0; w < total_weapons; w++) {
+        for (size_t a = 0; a < total_armors; a++) {
+            damages[w * total_armors + a] = damage_mitigate(weapons[w].weapon_damage, armors[a]._armor_resistance_force);
+        }
+    }
+    log_factorials[0] = 0.0;
+    for (size_t i = 1; i <= config->max_turns; i++) {
+        log_factorials[i] = log_factorials[i - 1] + log((double)i);
+    }
+
+    // Many pairs share a base damage, each distinct one is computed once
+    unsigned int *distinct = malloc(total_pairs * sizeof(*distinct));
+    if (!distinct) {
+        free(damages);
+        free(log_factorials);
+        return false;
+    }
+    memcpy(distinct, damages, total_pairs * sizeof(*distinct));
+    qsort(distinct, total_pairs, sizeof(*distinct), balance_uint_cmp);
+
+    bool ok = true;
+    ctx->total_distributions = 0;
+    for (size_t i = 0; i < total_pairs && ok; i++) {
+        if (i > 0 && distinct[i] == distinct[i - 1]) {
+            continue;
+        }
+        struct ttk_distribution *dist = &ctx->distributions[ctx->total_distributions];
+        dist->base_damage = distinct[i];
+        dist->cdf = malloc(((size_t)config->max_turns + 1) * sizeof(*dist->cdf));
+        if (!dist->cdf) {
+            ok = false;
+            break;
+        }
+        balance_fill_distribution(dist, config->health, config->max_turns, log_factorials);
+        ctx->total_distributions++;
+    }
+
+    for (size_t i = 0; i < total_pairs && ok; i++) {
+        // Distributions are sorted by base damage
+        size_t low = 0;
+        size_t high = ctx->total_distributions;
+        while (low < high) {
+            const size_t mid = low + (high - low) / 2;
+            if (ctx->distributions[mid].base_damage < damages[i]) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        ctx->pair_distributions[i] = &ctx->distributions[low];
+    }
+
+    free(distinct);
+    free(damages);
+    free(log_factorials);
+    return ok;
+}
+
+/**
+ * @brief Releases the distributions of a context.
+ *
+ * @param[in] ctx Pointer to context struct.
+ */
+static void balance_free_distributions(struct balance_context *ctx)
+{
+    if (ctx->distributions) {
+        for (size_t i = 0; i < ctx->total_distributions; i++) {
+            free(ctx->distributions[i].cdf);
+        }
+    }
+    free(ctx->distributions);
+    free(ctx->pair_distributions);
+}
+
+bool balance_analyze(const struct vector *weapons, const struct vector *armors, const struct balance_config *config, struct job_system *js, struct balance_matrix *m)
+{
+    if (!weapons || !armors || !config || !m || weapons->size == 0 || armors->size == 0 ||
+        config->health == 0 || config->max_turns == 0 || config->samples == 0) {
+        return false;
+    }
+
+    memset(m, 0, sizeof(*m));
+    m->weapons = weapons;
+    m->armors = armors;
+    m->total_loadouts = weapons->size * armors->size;
+    m->cells = malloc(m->total_loadouts * m->total_loadouts * sizeof(*m->cells));
+    struct balance_row *rows = malloc(m->total_loadouts * sizeof(*rows));
+    struct balance_context ctx = { .m = m, .config = config };
+    if (!m->cells || !rows || !balance_build_distributions(&ctx)) {
+        balance_free_distributions(&ctx);
+        free(rows);
+        free(m->cells);
+        memset(m, 0, sizeof(*m));
+        return false;
+    }
+
+    for (size_t i = 0; i < m->total_loadouts; i++) {
+        rows[i].ctx = &ctx;
+        rows[i].attacker = i;
+        if (!js || !job_system_submit(js, balance_row_job, &rows[i])) {
+            balance_row_job(&rows[i], NULL);
+        }
+    }
+    job_system_wait(js);
+
+    for (size_t i = 0; i < m->total_loadouts * m->total_loadouts; i++) {
+        m->total_sampled += m->cells[i].sampled;
+    }
+
+    balance_free_distributions(&ctx);
+    free(rows);
+    return true;
+}
+
+void balance_print_csv(const struct balance_matrix *m, FILE *out)
+{
+    if (!m || !m->cells || !out) {
+        return;
+    }
+
+    const size_t total_armors = m->armors->size;
+    const struct weapon *weapons = vector_items(m->weapons);
+    const struct armor *armors = vector_items(m->armors);
+
+    fprintf(out, "attacker,defender,win_probability,draw_probability,mean_turns_to_kill,method\n");
+    for (size_t a = 0; a < m->total_loadouts; a++) {
+        for (size_t d = 0; d < m->total_loadouts; d++) {
+            const struct balance_cell *cell = &m->cells[a * m->total_loadouts + d];
+            fprintf(out, "%s/%s,%s/%s,%.6f,%.6f,%.3f,%s\n",
+                name_get(&weapons[a / total_armors].weapon_name), name_get(&armors[a % total_armors].armor_name),
+                name_get(&weapons[d / total_armors].weapon_name), name_get(&armors[d % total_armors].armor_name),
+                cell->win_probability, cell->draw_probability, cell->mean_turns_to_kill,
+                cell->sampled ? "sampled" : "exact");
+        }
+    }
+}
+
+void balance_matrix_deinitialize(struct balance_matrix *m)
+{
+    if (!m || !m->cells) {
+        return;
+    }
+
+    free(m->cells);
+    memset(m, 0, sizeof(*m));
+}
@@ -0,0 +1,353 @@
+/*! Console command implementation file */
+
+#include "headers/command.h"
+#include "headers/player.h"
+#include "headers/vector.h"
+#include <stdio.h>
+#include <string.h>
+
+/** Slots of the verb table. */
+#define COMMAND_TABLE_SIZE (1u << COMMAND_TABLE_BITS)
+
+/**
+ * @struct command_entry
+ * @brief Slot of the verb table.
+ */
+struct command_entry {
+    /** Verb as typed, NULL for an empty slot. */
+    const char *name;
+    /** Length of the verb. */
+    size_t length;
+    /** Verb. */
+    enum command_verb verb;
+};
+
+/** Builds the slot of a verb, its characters are spelled out as indexing a string literal is not a constant expression. */
+#define COMMAND_ENTRY(str, first, second, last, id) \
+    [COMMAND_HASH(first, second, last, sizeof(str) - 1)] = { (str), sizeof(str) - 1, (id) }
+
+/** Verbs by slot. */
+static const struct command_entry command_table[COMMAND_TABLE_SIZE] = {
+    COMMAND_ENTRY("add", 'a', 'd', 'd', COMMAND_VERB_ADD),
+    COMMAND_ENTRY("remove", 'r', 'e', 'e', COMMAND_VERB_REMOVE),
+    COMMAND_ENTRY("equip", 'e', 'q', 'p', COMMAND_VERB_EQUIP),
+    COMMAND_ENTRY("attack", 'a', 't', 'k', COMMAND_VERB_ATTACK),
+    COMMAND_ENTRY("heal", 'h', 'e', 'l', COMMAND_VERB_HEAL),
+    COMMAND_ENTRY("repair", 'r', 'e', 'r', COMMAND_VERB_REPAIR),
+    COMMAND_ENTRY("enhance", 'e', 'n', 'e', COMMAND_VERB_ENHANCE),
+    COMMAND_ENTRY("stats", 's', 't', 's', COMMAND_VERB_STATS)
+};
+
+/** Spelling of the verbs, in enum order. */
+static const char *const command_verb_names[COMMAND_VERB_COUNT] = {
+    NULL,
+    "add",
+    "remove",
+    "equip",
+    "attack",
+    "heal",
+    "repair",
+    "enhance",
+    "stats"
+};
+
+/** Runs a command on the rest of its line. */
+typedef bool (*command_func)(struct tokenizer *args, struct command_context *ctx);
+
+/**
+ * @brief Reads the next token as an unsigned int.
+ */
+static bool command_next_uint(struct tokenizer *args, unsigned int *value)
+{
+    struct string_view token = {0};
+    return tokenizer_next_token(args, &token) && string_view_parse_uint(token, value);
+}
+
+/**
+ * @brief Reads the rest of the line as a name.
+ */
+static bool command_rest_name(struct tokenizer *args, char *name)
+{
+    const struct string_view rest = tokenizer_remaining(args);
+    return rest.length > 0 && string_view_copy(rest, COMMAND_NAME_SIZE, name);
+}
+
+/**
+ * @brief Checks that the line has nothing left.
+ */
+static bool command_done(const struct tokenizer *args)
+{
+    return tokenizer_remaining(args).length == 0;
+}
+
+/**
+ * @brief Finds the weapon a typed name stands for: the exact name, else the only name it starts, else the closest name.
+ */
+static struct weapon *command_find_weapon(const char *typed, struct command_context *ctx)
+{
+    size_t position = 0;
+    size_t matches[2];
+    if (!radix_tree_find(typed, &ctx->weapon_names, &position)) {
+        if (radix_tree_complete(typed, 2, &ctx->weapon_names, matches) == 1) {
+            position = matches[0];
+        } else if (!radix_tree_find_closest(typed, COMMAND_MAX_TYPOS, &ctx->weapon_names, &position, NULL)) {
+            return NULL;
+        }
+    }
+
+    if (position >= ctx->player->_weapons.size) {
+        return NULL;
+    }
+    return (struct weapon *)vector_items(&ctx->player->_weapons) + position;
+}
+
+/**
+ * @brief Finds the weapon a typed name names without guessing: the exact name, else the only name it starts.
+ *
+ * Prints the names it could stand for when there is no such weapon.
+ */
+static struct weapon *command_find_weapon_strict(const char *typed, struct command_context *ctx)
+{
+    struct weapon *weapons = vector_items(&ctx->player->_weapons);
+    const size_t total_weapons = ctx->player->_weapons.size;
+    size_t position = 0;
+    if (radix_tree_find(typed, &ctx->weapon_names, &position)) {
+        return position < total_weapons ? &weapons[position] : NULL;
+    }
+
+    size_t matches[COMMAND_MAX_CANDIDATES];
+    size_t total = radix_tree_complete(typed, COMMAND_MAX_CANDIDATES, &ctx->weapon_names, matches);
+    if (total == 1) {
+        return matches[0] < total_weapons ? &weapons[matches[0]] : NULL;
+    }
+    // A near miss is only suggested
+    if (total == 0 && radix_tree_find_closest(typed, COMMAND_MAX_TYPOS, &ctx->weapon_names, &matches[0], NULL)) {
+        total = 1;
+    }
+    if (total > 0) {
+        printf("\"%s\" names no single weapon, did you mean:", typed);
+        for (size_t i = 0; i < total; i++) {
+            if (matches[i] < total_weapons) {
+                printf(" \"%s\"", name_get(&weapons[matches[i]].weapon_name));
+            }
+        }
+        printf("\n");
+    }
+
+    return NULL;
+}
+
+static bool command_add(struct tokenizer *args, struct command_context *ctx)
+{
+    unsigned int damage = 0;
+    char name[COMMAND_NAME_SIZE];
+    if (!command_next_uint(args, &damage) || !command_rest_name(args, name)) {
+        return false;
+    }
+
+    struct weapon w = {0};
+    if (!weapon_initialize(name, COMMAND_WEAPON_HEALTH, damage, &w)) {
+        return false;
+    }
+
+    const size_t before = ctx->player->_weapons.size;
+    if (!player_add_weapon(&w, ctx->player)) {
+        weapon_deinitialize(&w);
+        return false;
+    }
+
+    return radix_tree_insert(name, before, &ctx->weapon_names);
+}
+
+static bool command_remove(struct tokenizer *args, struct command_context *ctx)
+{
+    char name[COMMAND_NAME_SIZE];
+    if (!command_rest_name(args, name)) {
+        return false;
+    }
+
+    const struct weapon *found = command_find_weapon_strict(name, ctx);
+    if (!found) {
+        return false;
+    }
+
+    struct weapon removed = *found;
+    if (!player_remove_weapon(&removed, ctx->player)) {
+        return false;
+    }
+    weapon_deinitialize(&removed);
+
+    // Weapons after the removed one moved down, so every position is redone
+    radix_tree_clear(&ctx->weapon_names);
+    return radix_tree_insert_weapons(&ctx->player->_weapons, &ctx->weapon_names);
+}
+
+static bool command_equip(struct tokenizer *args, struct command_context *ctx)
+{
+    unsigned int resistance = 0;
+    char name[COMMAND_NAME_SIZE];
+    if (!command_next_uint(args, &resistance) || !command_rest_name(args, name) || ctx->player->_isWearingArmor) {
+        return false;
+    }
+
+    struct armor a = {0};
+    if (!armor_initialize(name, COMMAND_ARMOR_HEALTH, COMMAND_ARMOR_HEALTH, resistance, &a)) {
+        return false;
+    }
+    if (!player_equip_armor_move(&a, ctx->player)) {
+        armor_deinitialize(&a);
+        return false;
+    }
+
+    return true;
+}
+
+static bool command_attack(struct tokenizer *args, struct command_context *ctx)
+{
+    char name[COMMAND_NAME_SIZE];
+    if (!command_rest_name(args, name) || !ctx->opponent) {
+        return false;
+    }
+
+    const struct weapon *w = command_find_weapon(name, ctx);
+    if (!w) {
+        return false;
+    }
+    player_attack(ctx->player, name_get(&w->weapon_name), ctx->opponent);
+    ctx->turn_over = true;
+
+    return true;
+}
+
+static bool command_heal(struct tokenizer *args, struct command_context *ctx)
+{
+    unsigned int amount = 0;
+    if (!command_next_uint(args, &amount) || !command_done(args)) {
+        return false;
+    }
+
+    player_heal(amount, ctx->player);
+    return true;
+}
+
+static bool command_repair(struct tokenizer *args, struct command_context *ctx)
+{
+    unsigned int amount = 0;
+    char name[COMMAND_NAME_SIZE];
+    if (!command_next_uint(args, &amount) || !command_rest_name(args, name)) {
+        return false;
+    }
+
+    const struct weapon *w = command_find_weapon(name, ctx);
+    return w && player_repair_weapon(name_get(&w->weapon_name), amount, ctx->player);
+}
+
+static bool command_enhance(struct tokenizer *args, struct command_context *ctx)
+{
+    unsigned int amount = 0;
+    char name[COMMAND_NAME_SIZE];
+    if (!command_next_uint(args, &amount) || !command_rest_name(args, name)) {
+        return false;
+    }
+
+    const struct weapon *w = command_find_weapon(name, ctx);
+    return w && player_enhance_weapon(name_get(&w->weapon_name), amount, ctx->player);
+}
+
+static bool command_stats(struct tokenizer *args, struct command_context *ctx)
+{
+    if (!command_done(args)) {
+        return false;
+    }
+
+    player_get_stats(ctx->player);
+    return true;
+}
+
+/** Handlers, in enum order. */
+static const command_func command_handlers[COMMAND_VERB_COUNT] = {
+    NULL,
+    command_add,
+    command_remove,
+    command_equip,
+    command_attack,
+    command_heal,
+    command_repair,
+    command_enhance,
+    command_stats
+};
+
+bool command_context_initialize(struct player *player, struct player *opponent, struct command_context *ctx)
+{
+    if (!player || !ctx) {
+        return false;
+    }
+
+    ctx->player = player;
+    ctx->opponent = opponent;
+    ctx->turn_over = false;
+    if (!radix_tree_initialize(&ctx->weapon_names)) {
+        return false;
+    }
+    if (!radix_tree_insert_weapons(&player->_weapons, &ctx->weapon_names)) {
+        radix_tree_deinitialize(&ctx->weapon_names);
+        return false;
+    }
+
+    return true;
+}
+
+void command_context_deinitialize(struct command_context *ctx)
+{
+    if (!ctx) {
+        return;
+    }
+
+    radix_tree_deinitialize(&ctx->weapon_names);
+    ctx->player = NULL;
+    ctx->opponent = NULL;
+}
+
+enum command_verb command_lookup(const struct string_view verb)
+{
+    if (!verb.data || verb.length < COMMAND_MIN_VERB_LENGTH || verb.length > COMMAND_MAX_VERB_LENGTH) {
+        return COMMAND_VERB_UNKNOWN;
+    }
+
+    // One hash and at most one comparison, whatever the number of verbs
+    const struct command_entry *e = &command_table[COMMAND_HASH(verb.data[0], verb.data[1], verb.data[verb.length - 1], verb.length)];
+    if (!e->name || e->length != verb.length || memcmp(e->name, verb.data, verb.length) != 0) {
+        return COMMAND_VERB_UNKNOWN;
+    }
+
+    return e->verb;
+}
+
+const char *command_verb_name(const enum command_verb verb)
+{
+    if ((unsigned int)verb >= COMMAND_VERB_COUNT) {
+        return NULL;
+    }
+
+    return command_verb_names[verb];
+}
+
+bool command_execute(const struct string_view line, struct command_context *ctx)
+{
+    if (!line.data || !ctx || !ctx->player) {
+        return false;
+    }
+
+    struct tokenizer args = {0};
+    struct string_view verb = {0};
+    if (!tokenizer_initialize(line.data, line.length, &args) || !tokenizer_next_token(&args, &verb)) {
+        return false;
+    }
+
+    const enum command_verb id = command_lookup(verb);
+    if (id == COMMAND_VERB_UNKNOWN) {
+        return false;
+    }
+
+    return command_handlers[id](&args, ctx);
+}
@@ -0,0 +1,201 @@
+/*! Error reporting implementation file */
+
+#include "headers/error.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <threads.h>
+#include <time.h>
+
+static_assert((ERROR_LOG_CAPACITY & (ERROR_LOG_CAPACITY - 1)) == 0, "ERROR_LOG_CAPACITY must be a power of two");
+
+/**
+ * @struct error_slot
+ * @brief Slot of the log ring.
+ *
+ * A slot at position p is free for the producer claiming p once sequence is p, and holds an
+ * error for the consumer once sequence is p + 1, as in Vyukov's bounded queue.
+ */
+struct error_slot {
+    /** Position the slot is ready for, see above. */
+    atomic_size_t sequence;
+    /** Function that failed. */
+    const char *where;
+    /** Why it failed. */
+    enum error_code code;
+};
+
+/** Names of the codes, in enum order. */
+static const char *const error_code_names[ERROR_COUNT] = {
+    "no error",
+    "null argument",
+    "invalid argument",
+    "out of range",
+    "out of memory",
+    "not found"
+};
+
+/** Last failure of the thread. */
+static _Thread_local enum error_code error_local_code = ERROR_NONE;
+/** Function of the last failure of the thread. */
+static _Thread_local const char *error_local_where = NULL;
+
+/** Set while the drain thread runs. */
+static atomic_bool error_logging = false;
+/** Log ring. */
+static struct error_slot error_ring[ERROR_LOG_CAPACITY];
+/** Next position producers claim. */
+static atomic_size_t error_tail = 0;
+/** Next position the drain thread reads, only touched by it. */
+static size_t error_head = 0;
+/** Errors dropped on a full ring. */
+static atomic_size_t error_dropped = 0;
+/** Stream written by the drain thread. */
+static FILE *error_out = NULL;
+/** Drain thread. */
+static thrd_t error_thread;
+
+/**
+ * @brief Claims a slot and copies the error in, or counts it as dropped if the ring is full.
+ */
+static void error_log_push(const enum error_code code, const char *where)
+{
+    size_t position = atomic_load_explicit(&error_tail, memory_order_relaxed);
+    for (;;) {
+        struct error_slot *slot = &error_ring[position & (ERROR_LOG_CAPACITY - 1)];
+        const size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        const intptr_t lag = (intptr_t)sequence - (intptr_t)position;
+        if (lag == 0) {
+            if (atomic_compare_exchange_weak_explicit(&error_tail, &position, position + 1, memory_order_relaxed, memory_order_relaxed)) {
+                slot->code = code;
+                slot->where = where;
+                atomic_store_explicit(&slot->sequence, position + 1, memory_order_release);
+                return;
+            }
+            // Lost the slot to another producer, position now holds the new tail
+        } else if (lag < 0) {
+            // The drain thread has not freed this slot yet
+            atomic_fetch_add_explicit(&error_dropped, 1, memory_order_relaxed);
+            return;
+        } else {
+            position = atomic_load_explicit(&error_tail, memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief Writes every published error and frees their slots.
+ */
+static void error_log_drain(void)
+{
+    bool wrote = false;
+    for (;;) {
+        struct error_slot *slot = &error_ring[error_head & (ERROR_LOG_CAPACITY - 1)];
+        if (atomic_load_explicit(&slot->sequence, memory_order_acquire) != error_head + 1) {
+            break;
+        }
+
+        fprintf(error_out, "%s at %s()\n", error_code_name(slot->code), slot->where);
+        atomic_store_explicit(&slot->sequence, error_head + ERROR_LOG_CAPACITY, memory_order_release);
+        error_head++;
+        wrote = true;
+    }
+    if (wrote) {
+        fflush(error_out);
+    }
+}
+
+static int error_log_main(void *arg)
+{
+    (void)arg;
+    const struct timespec pause = { .tv_sec = 0, .tv_nsec = ERROR_LOG_DRAIN_MS * 1000000L };
+    while (atomic_load_explicit(&error_logging, memory_order_acquire)) {
+        error_log_drain();
+        thrd_sleep(&pause, NULL);
+    }
+
+    return 0;
+}
+
+bool error_set(const enum error_code code, const char *where)
+{
+    error_local_code = code;
+    error_local_where = where;
+    if (code != ERROR_NOT_FOUND && where && atomic_load_explicit(&error_logging, memory_order_acquire)) {
+        error_log_push(code, where);
+    }
+
+    return false;
+}
+
+enum error_code error_last(void)
+{
+    return error_local_code;
+}
+
+const char *error_last_where(void)
+{
+    return error_local_where;
+}
+
+void error_clear(void)
+{
+    error_local_code = ERROR_NONE;
+    error_local_where = NULL;
+}
+
+const char *error_code_name(const enum error_code code)
+{
+    if ((unsigned int)code >= ERROR_COUNT) {
+        return NULL;
+    }
+
+    return error_code_names[code];
+}
+
+bool error_log_start(FILE *out)
+{
+    if (!out || atomic_load_explicit(&error_logging, memory_order_relaxed)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < ERROR_LOG_CAPACITY; i++) {
+        atomic_store_explicit(&error_ring[i].sequence, i, memory_order_relaxed);
+    }
+    atomic_store_explicit(&error_tail, 0, memory_order_relaxed);
+    atomic_store_explicit(&error_dropped, 0, memory_order_relaxed);
+    error_head = 0;
+    error_out = out;
+
+    atomic_store_explicit(&error_logging, true, memory_order_release);
+    if (thrd_create(&error_thread, error_log_main, NULL) != thrd_success) {
+        atomic_store_explicit(&error_logging, false, memory_order_relaxed);
+        error_out = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+void error_log_stop(void)
+{
+    if (!atomic_load_explicit(&error_logging, memory_order_relaxed)) {
+        return;
+    }
+
+    atomic_store_explicit(&error_logging, false, memory_order_release);
+    thrd_join(error_thread, NULL);
+    error_log_drain();
+
+    const size_t dropped = atomic_load_explicit(&error_dropped, memory_order_relaxed);
+    if (dropped > 0) {
+        fprintf(error_out, "%zu errors dropped, the log was full\n", dropped);
+        fflush(error_out);
+    }
+    error_out = NULL;
+}
+
+size_t error_log_dropped(void)
+{
+    return atomic_load_explicit(&error_dropped, memory_order_relaxed);
+}
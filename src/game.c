@@ -1,37 +1,302 @@
 /*! Game implementation file */
 
 #include "headers/game.h"
+#include "headers/alloc.h"
 #include "headers/vector.h"
 #include "headers/player.h"
+#include "headers/inventory.h"
+#include "headers/trace.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
-/** Global player vector */
-static struct vector players = {0};
+static_assert(GAME_CHUNK_PLAYERS > 0 && GAME_CHUNK_PLAYERS <= 64, "GAME_CHUNK_PLAYERS must fit a uint64_t mask");
+
+/**
+ * @struct game_chunk
+ * @brief Fixed block of players, shared by every game that has not modified it since forking.
+ */
+struct game_chunk {
+    /** Chunk tables pointing to this chunk. */
+    atomic_size_t references;
+    /** Bit i is set if players[i]'s weapons and index were copied by this chunk and are freed with it. */
+    uint64_t owned;
+    /** Bit i is set if players[i] was moved in, or deep copied from such a player, and is deinitialized with the chunk. */
+    uint64_t moved;
+    /** Players, only the first total_players of the game across all chunks are valid. */
+    struct player players[GAME_CHUNK_PLAYERS];
+};
+
+/**
+ * @struct game_table
+ * @brief List of chunks, shared by every game that has not modified it since forking.
+ */
+struct game_table {
+    /** Games pointing to this table. */
+    atomic_size_t references;
+    /** Chunks allocated. */
+    size_t total_chunks;
+    /** Chunks there is room for. */
+    size_t capacity;
+    /** Chunk pointers. */
+    struct game_chunk *chunks[];
+};
+
+static struct game_table *game_table_create(const size_t capacity)
+{
+    struct game_table *t = alloc_malloc(sizeof(*t) + capacity * sizeof(t->chunks[0]), ALLOC_TAG_GAME);
+    if (!t) {
+        return NULL;
+    }
+
+    atomic_init(&t->references, 1);
+    t->total_chunks = 0;
+    t->capacity = capacity;
+    return t;
+}
+
+/**
+ * @brief Frees the storage a chunk copied for one of its players.
+ */
+static void game_release_storage(struct player *p)
+{
+    vector_deinitialize(&p->_weapons);
+    inventory_index_deinitialize(&p->_weapon_index);
+}
+
+/**
+ * @brief Gives a player its own copy of its weapons and index.
+ */
+static bool game_copy_storage(struct player *p)
+{
+    struct vector weapons = p->_weapons;
+    struct inventory_index index = {0};
+
+    // Inline weapons were already copied along with the player
+    if (p->_weapons._heap && !vector_copy(&p->_weapons, &weapons)) {
+        return false;
+    }
+    if (!inventory_index_copy(&p->_weapon_index, &index)) {
+        if (weapons._heap != p->_weapons._heap) {
+            vector_deinitialize(&weapons);
+        }
+        return false;
+    }
+
+    p->_weapons = weapons;
+    p->_weapon_index = index;
+    return true;
+}
+
+/**
+ * @brief Frees whatever a chunk owns of one of its players.
+ */
+static void game_release_slot(struct game_chunk *c, const size_t slot)
+{
+    const uint64_t bit = UINT64_C(1) << slot;
+    if (c->moved & bit) {
+        player_deinitialize(&c->players[slot]);
+    } else if (c->owned & bit) {
+        game_release_storage(&c->players[slot]);
+    }
+    c->moved &= ~bit;
+    c->owned &= ~bit;
+}
+
+static void game_chunk_release(struct game_chunk *c)
+{
+    if (atomic_fetch_sub(&c->references, 1) != 1) {
+        return;
+    }
+
+    for (size_t i = 0; i < GAME_CHUNK_PLAYERS; i++) {
+        game_release_slot(c, i);
+    }
+    alloc_free(c);
+}
+
+static void game_table_release(struct game_table *t)
+{
+    if (atomic_fetch_sub(&t->references, 1) != 1) {
+        return;
+    }
+
+    for (size_t i = 0; i < t->total_chunks; i++) {
+        game_chunk_release(t->chunks[i]);
+    }
+    alloc_free(t);
+}
+
+/**
+ * @brief Makes sure the game's table is not shared, copying the chunk pointers if it is.
+ */
+static bool game_unshare_table(struct game *g)
+{
+    struct game_table *old = g->table;
+    if (atomic_load(&old->references) == 1) {
+        return true;
+    }
+
+    struct game_table *t = game_table_create(old->capacity);
+    if (!t) {
+        return false;
+    }
+    t->total_chunks = old->total_chunks;
+    for (size_t i = 0; i < old->total_chunks; i++) {
+        t->chunks[i] = old->chunks[i];
+        atomic_fetch_add(&t->chunks[i]->references, 1);
+    }
+
+    g->table = t;
+    game_table_release(old);
+    return true;
+}
+
+/**
+ * @brief Makes sure a chunk of an unshared table is not shared, copying it if it is.
+ */
+static struct game_chunk *game_unshare_chunk(const size_t chunk, struct game *g)
+{
+    struct game_chunk *old = g->table->chunks[chunk];
+    if (atomic_load(&old->references) == 1) {
+        return old;
+    }
+
+    struct game_chunk *c = alloc_malloc(sizeof(*c), ALLOC_TAG_GAME);
+    if (!c) {
+        return NULL;
+    }
+
+    const size_t first = chunk * GAME_CHUNK_PLAYERS;
+    const size_t live = (g->total_players - first < GAME_CHUNK_PLAYERS) ? g->total_players - first : GAME_CHUNK_PLAYERS;
+    atomic_init(&c->references, 1);
+    c->owned = 0;
+    c->moved = 0;
+    for (size_t i = 0; i < live; i++) {
+        const uint64_t bit = UINT64_C(1) << i;
+        // Players the game owns are copied whole, their names must not outlive the chunk they came from
+        bool ok = false;
+        if (old->moved & bit) {
+            ok = player_copy(&old->players[i], &c->players[i]);
+            c->moved |= ok ? bit : 0;
+        } else {
+            c->players[i] = old->players[i];
+            ok = game_copy_storage(&c->players[i]);
+            c->owned |= ok ? bit : 0;
+        }
+        if (!ok) {
+            for (size_t j = 0; j < i; j++) {
+                game_release_slot(c, j);
+            }
+            alloc_free(c);
+            return NULL;
+        }
+    }
+
+    g->table->chunks[chunk] = c;
+    game_chunk_release(old);
+    return c;
+}
+
+/**
+ * @brief Gets the slot of a player, valid while the table is not modified.
+ */
+static struct player *game_slot(const size_t index, const struct game *g)
+{
+    return &g->table->chunks[index / GAME_CHUNK_PLAYERS]->players[index % GAME_CHUNK_PLAYERS];
+}
 
 bool game_initialize(const unsigned int initial_capacity, struct game *g)
 {
-    if (!g) {
+    if (!g || initial_capacity == 0) {
         return false;
     }
 
-    vector_initialize(initial_capacity, sizeof(struct player), &players);
+    memset(g, 0, sizeof(*g));
+    g->table = game_table_create((initial_capacity + GAME_CHUNK_PLAYERS - 1) / GAME_CHUNK_PLAYERS);
+    return g->table != NULL;
+}
 
-    g->players = players;
-    return false;
+/**
+ * @brief Appends a player to the game as is, and gets the chunk and slot it went to.
+ */
+static struct game_chunk *game_append(const struct player *p, struct game *g, size_t *slot_out)
+{
+    if (!p || !g || !g->table || !game_unshare_table(g)) {
+        return NULL;
+    }
+
+    const size_t chunk = g->total_players / GAME_CHUNK_PLAYERS;
+    const size_t slot = g->total_players % GAME_CHUNK_PLAYERS;
+    struct game_table *t = g->table;
+
+    if (chunk == t->total_chunks) {
+        if (t->total_chunks == t->capacity) {
+            const size_t capacity = t->capacity ? t->capacity * 2 : 1;
+            struct game_table *grown = alloc_realloc(t, sizeof(*t) + capacity * sizeof(t->chunks[0]), ALLOC_TAG_GAME);
+            if (!grown) {
+                return NULL;
+            }
+            grown->capacity = capacity;
+            g->table = t = grown;
+        }
+
+        struct game_chunk *c = alloc_malloc(sizeof(*c), ALLOC_TAG_GAME);
+        if (!c) {
+            return NULL;
+        }
+        atomic_init(&c->references, 1);
+        c->owned = 0;
+        c->moved = 0;
+        t->chunks[t->total_chunks++] = c;
+    }
+
+    struct game_chunk *c = game_unshare_chunk(chunk, g);
+    if (!c) {
+        return NULL;
+    }
+    c->players[slot] = *p;
+    c->owned &= ~(UINT64_C(1) << slot);
+    c->moved &= ~(UINT64_C(1) << slot);
+    g->total_players++;
+    *slot_out = slot;
+
+    return c;
 }
 
 bool game_insert_player(const struct player *p, struct game *g)
 {
-    if (!p || !g) {
+    size_t slot = 0;
+    struct game_chunk *c = game_append(p, g, &slot);
+    if (!c) {
         return false;
     }
 
-    if (vector_push_back(&g->players, p)) {
-        return true;
+    // The game gets its own weapons vector and index, so it never depends on how the caller's are stored
+    if (!game_copy_storage(&c->players[slot])) {
+        memset(&c->players[slot], 0, sizeof(c->players[slot]));
+        g->total_players--;
+        return false;
     }
+    c->owned |= UINT64_C(1) << slot;
 
-    return false;
+    return true;
+}
+
+bool game_insert_player_move(struct player *p, struct game *g)
+{
+    size_t slot = 0;
+    struct game_chunk *c = game_append(p, g, &slot);
+    if (!c) {
+        return false;
+    }
+
+    c->moved |= UINT64_C(1) << slot;
+    memset(p, 0, sizeof(*p));
+
+    return true;
 }
 
 bool game_remove_player(const struct player *p, struct game *g)
@@ -40,33 +305,121 @@ bool game_remove_player(const struct player *p, struct game *g)
         return false;
     }
 
-    if (vector_pop_search(&g->players, p)) {
-        return true;
+    // Forks and moved-in players do not keep the caller's pointers, so players are told apart by identity
+    for (size_t i = 0; i < g->total_players; i++) {
+        if (game_slot(i, g) == p) {
+            return game_remove_player_at(i, g);
+        }
+    }
+    if (name_is_empty(&p->player_name)) {
+        return false;
+    }
+    for (size_t i = 0; i < g->total_players; i++) {
+        if (name_equals(&game_slot(i, g)->player_name, name_get(&p->player_name))) {
+            return game_remove_player_at(i, g);
+        }
     }
 
     return false;
 }
 
+bool game_remove_player_at(const size_t index, struct game *g)
+{
+    if (!g || !g->table || index >= g->total_players || !game_unshare_table(g)) {
+        return false;
+    }
+
+    TRACE_INSTANT("player removal");
+    // Every chunk from the removed player on shifts, so each needs its own copy
+    const size_t last_chunk = (g->total_players - 1) / GAME_CHUNK_PLAYERS;
+    for (size_t chunk = index / GAME_CHUNK_PLAYERS; chunk <= last_chunk; chunk++) {
+        if (!game_unshare_chunk(chunk, g)) {
+            return false;
+        }
+    }
+
+    game_release_slot(g->table->chunks[index / GAME_CHUNK_PLAYERS], index % GAME_CHUNK_PLAYERS);
+
+    for (size_t i = index; i + 1 < g->total_players; i++) {
+        struct game_chunk *to = g->table->chunks[i / GAME_CHUNK_PLAYERS];
+        struct game_chunk *from = g->table->chunks[(i + 1) / GAME_CHUNK_PLAYERS];
+        const uint64_t to_bit = UINT64_C(1) << (i % GAME_CHUNK_PLAYERS);
+        const uint64_t from_bit = UINT64_C(1) << ((i + 1) % GAME_CHUNK_PLAYERS);
+
+        to->players[i % GAME_CHUNK_PLAYERS] = from->players[(i + 1) % GAME_CHUNK_PLAYERS];
+        to->owned = (from->owned & from_bit) ? (to->owned | to_bit) : (to->owned & ~to_bit);
+        to->moved = (from->moved & from_bit) ? (to->moved | to_bit) : (to->moved & ~to_bit);
+    }
+
+    const size_t last = g->total_players - 1;
+    g->table->chunks[last / GAME_CHUNK_PLAYERS]->owned &= ~(UINT64_C(1) << (last % GAME_CHUNK_PLAYERS));
+    g->table->chunks[last / GAME_CHUNK_PLAYERS]->moved &= ~(UINT64_C(1) << (last % GAME_CHUNK_PLAYERS));
+    g->total_players--;
+
+    return true;
+}
+
+const struct player *game_get_player(const size_t index, const struct game *g)
+{
+    if (!g || !g->table || index >= g->total_players) {
+        return NULL;
+    }
+
+    return game_slot(index, g);
+}
+
+struct player *game_get_player_mut(const size_t index, struct game *g)
+{
+    if (!g || !g->table || index >= g->total_players || !game_unshare_table(g)) {
+        return NULL;
+    }
+
+    struct game_chunk *c = game_unshare_chunk(index / GAME_CHUNK_PLAYERS, g);
+    if (!c) {
+        return NULL;
+    }
+
+    return &c->players[index % GAME_CHUNK_PLAYERS];
+}
+
+bool game_fork(const struct game *src, struct game *dst)
+{
+    if (!src || !src->table || !dst) {
+        return false;
+    }
+
+    atomic_fetch_add(&src->table->references, 1);
+    dst->table = src->table;
+    dst->total_players = src->total_players;
+
+    return true;
+}
+
 void game_get_winner(struct player *winner, const struct game *g)
 {
-    if (!g || !g->players.items || g->players.size == 0) {
+    if (!winner || !g || !g->table || g->total_players == 0) {
         return;
     }
 
-    vector_get_element(&g->players, 0, winner);
+    TRACE_INSTANT("winner selection");
+    *winner = *game_slot(0, g);
 }
 
 size_t game_get_total_players(const struct game *g)
 {
-    return g->players.size;
+    if (!g) {
+        return 0;
+    }
+
+    return g->total_players;
 }
 
 void game_deinitialize(struct game *g)
 {
-    if (!g || !g->players.items) {
+    if (!g || !g->table) {
         return;
     }
 
-    vector_deinitialize(&g->players);
+    game_table_release(g->table);
     memset(g, 0, sizeof(*g));
-}
\ No newline at end of file
+}
@@ -0,0 +1,105 @@
+/*! Combat AI declaration file */
+
+#pragma once
+
+#include "game.h"
+#include "../third_party/pcg_basic.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Most players a search considers, the searching player included. */
+#define AI_MAX_COMBATANTS 8
+/** Most weapons per player a search considers, the strongest ones. */
+#define AI_MAX_WEAPONS 8
+/** Deepest search, in turns. */
+#define AI_MAX_DEPTH 32
+
+/**
+ * @struct ai_move
+ * @brief An attack: which weapon, on whom.
+ */
+struct ai_move {
+    /** Position of the weapon in the attacker's weapons. */
+    size_t weapon;
+    /** Index of the target in the game. */
+    size_t target;
+};
+
+/**
+ * @struct ai_search_info
+ * @brief Statistics of the last search.
+ */
+struct ai_search_info {
+    /** Deepest fully searched depth, in turns. */
+    unsigned int depth;
+    /** Positions visited, transposition hits included. */
+    size_t nodes;
+    /** Positions answered by the transposition table. */
+    size_t table_hits;
+    /** Expected score of the chosen move. */
+    double value;
+};
+
+/** Transposition table entry, private to ai.c. */
+struct ai_entry;
+
+/**
+ * @struct ai_engine
+ * @brief Expectiminimax search over attacks, with critical hits as chance events.
+ *
+ * Players move in game order. The searching player maximizes its score, the others are assumed
+ * to minimize it. Positions are hashed with Zobrist keys and cached in a fixed transposition table,
+ * and iterative deepening stops at the time budget. Searching allocates nothing.
+ * An engine is not thread safe, give each thread its own.
+ */
+struct ai_engine {
+    /** Transposition table. */
+    struct ai_entry *table;
+    /** Entries minus one, a power of two minus one. */
+    size_t table_mask;
+    /** Seed of the Zobrist keys. */
+    uint64_t seed;
+};
+
+/**
+ * @brief Initializes the engine.
+ *
+ * @param[in] table_entries Transposition table entries, rounded up to a power of two. Cannot be 0.
+ * @param[in] seed Seed of the Zobrist keys.
+ * @param[out] ai Pointer to caller allocated engine struct.
+ * @return true if success, false otherwise.
+ */
+bool ai_engine_initialize(const size_t table_entries, const uint64_t seed, struct ai_engine *ai);
+/**
+ * @brief Chooses the attack of a player.
+ *
+ * Searches one turn deeper at a time until the budget runs out, keeping the move of the deepest
+ * finished depth. The first depth always finishes.
+ *
+ * @param[in] player_index Index of the attacking player in the game.
+ * @param[in] budget_us Time budget in microseconds.
+ * @param[in] g Pointer to game struct.
+ * @param[in,out] ai Pointer to engine struct.
+ * @param[out] move Pointer to caller allocated move struct.
+ * @param[out] info Pointer to caller allocated search statistics, may be NULL.
+ * @return true if a move was found, false if the player cannot attack anyone.
+ */
+bool ai_choose_move(const size_t player_index, const unsigned int budget_us, const struct game *g, struct ai_engine *ai, struct ai_move *move, struct ai_search_info *info);
+/**
+ * @brief Chooses and plays the attack of a player.
+ *
+ * @param[in] player_index Index of the attacking player in the game.
+ * @param[in] budget_us Time budget in microseconds.
+ * @param[in,out] g Pointer to game struct.
+ * @param[in,out] ai Pointer to engine struct.
+ * @param[in,out] rng Random state the attack draws critical hits from.
+ * @return true if the player attacked, false otherwise.
+ */
+bool ai_take_turn(const size_t player_index, const unsigned int budget_us, struct game *g, struct ai_engine *ai, pcg32_random_t *rng);
+/**
+ * @brief Deinitializes the engine.
+ *
+ * @param[in] ai Pointer to engine struct.
+ */
+void ai_engine_deinitialize(struct ai_engine *ai);
@@ -0,0 +1,93 @@
+/*! Tagged allocation declaration file */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/** Environment variable that makes main() dump the allocation stats at exit. */
+#define ALLOC_REPORT_VARIABLE "GAME_MEMORY_REPORT"
+
+/**
+ * @enum alloc_tag
+ * @brief Subsystem an allocation is accounted to.
+ */
+enum alloc_tag {
+    /** Vector elements and scratch buffers. */
+    ALLOC_TAG_VECTOR,
+    /** Weapon batches. */
+    ALLOC_TAG_WEAPON,
+    /** Armor batches. */
+    ALLOC_TAG_ARMOR,
+    /** Player batches and weapon indexes. */
+    ALLOC_TAG_PLAYER,
+    /** Game tables and chunks. */
+    ALLOC_TAG_GAME,
+    /** Names too long to be inline. */
+    ALLOC_TAG_NAME,
+    /** Number of tags. */
+    ALLOC_TAG_COUNT
+};
+
+/**
+ * @struct alloc_stats
+ * @brief Allocation stats of one tag.
+ */
+struct alloc_stats {
+    /** Bytes allocated and not yet freed. */
+    size_t live_bytes;
+    /** Highest live_bytes so far. */
+    size_t peak_bytes;
+    /** Blocks allocated and not yet freed. */
+    size_t live_allocations;
+    /** Blocks allocated so far, every resize counted as a new block. */
+    size_t total_allocations;
+};
+
+/**
+ * @brief Allocates memory accounted to a tag. Thread safe.
+ *
+ * Blocks carry a small header with their size and tag, so they must be freed with alloc_free().
+ *
+ * @param[in] size Bytes to allocate.
+ * @param[in] tag Subsystem to account the block to.
+ * @return Pointer to the block, aligned as malloc() would, NULL on failure.
+ */
+void *alloc_malloc(const size_t size, const enum alloc_tag tag);
+/**
+ * @brief Resizes a block from alloc_malloc(), or allocates one if ptr is NULL. Thread safe.
+ *
+ * @param[in] ptr Block to resize, may be NULL.
+ * @param[in] size New size in bytes.
+ * @param[in] tag Subsystem to account a new block to, a resized block keeps its tag.
+ * @return Pointer to the block, NULL on failure with ptr left untouched.
+ */
+void *alloc_realloc(void *ptr, const size_t size, const enum alloc_tag tag);
+/**
+ * @brief Frees a block from alloc_malloc() or alloc_realloc(). Thread safe.
+ *
+ * @param[in] ptr Block to free, may be NULL.
+ */
+void alloc_free(void *ptr);
+/**
+ * @brief Gets the stats of a tag.
+ *
+ * @param[in] tag Tag to query.
+ * @param[out] stats Pointer to caller allocated stats struct.
+ * @return true if success, false otherwise.
+ */
+bool alloc_get_stats(const enum alloc_tag tag, struct alloc_stats *stats);
+/**
+ * @brief Gets the name of a tag.
+ *
+ * @param[in] tag Tag.
+ * @return Name of the tag, NULL if it is not one.
+ */
+const char *alloc_tag_name(const enum alloc_tag tag);
+/**
+ * @brief Writes the stats of every tag as a table.
+ *
+ * @param[in] out Stream to write to.
+ */
+void alloc_dump(FILE *out);
@@ -0,0 +1,135 @@
+/*! Combat analytics declaration file */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/** Environment variable naming the file main() writes the analytics to at exit. */
+#define ANALYTICS_PATH_VARIABLE "GAME_ANALYTICS"
+
+/** Bits of exact values at the bottom of a histogram, every bucket above is within 1 / 2^(ANALYTICS_SUB_BITS - 1) of its values. */
+#define ANALYTICS_SUB_BITS 5
+/** Buckets of a histogram, enough for every unsigned int. */
+#define ANALYTICS_HISTOGRAM_BUCKETS ((1u << ANALYTICS_SUB_BITS) + (32 - ANALYTICS_SUB_BITS) * (1u << (ANALYTICS_SUB_BITS - 1)))
+/** Weapons tracked by name, later ones are counted together. */
+#define ANALYTICS_MAX_WEAPONS 64
+/** Armors tracked by name, later ones are counted together. */
+#define ANALYTICS_MAX_ARMORS 32
+/** Longest name kept, including the NUL-terminator. Longer names are cut, but still told apart. */
+#define ANALYTICS_NAME_SIZE 32
+
+/*
+Every attack made while recording is folded into fixed tables, so memory stays the same
+whatever the session length:
+
+- per weapon: attacks, critical hits and a histogram of the damage dealt
+- per armor: attacks taken, damage before and after the armor, critical hits left out
+- hits to kill: a histogram of the hits every killed player took over its life
+
+Histograms are log-linear like HDR histograms: exact below 2^ANALYTICS_SUB_BITS, then
+2^(ANALYTICS_SUB_BITS - 1) buckets per power of two. Everything is updated with relaxed atomics,
+so any thread may record while another reads, and reads see each counter whole but not
+necessarily the counters of one attack together.
+
+A critical hit is counted when it dealt more than a normal hit would have, which misses only
+crits on hits too weak for the multiplier to add anything.
+*/
+
+/**
+ * @struct analytics_weapon
+ * @brief Aggregates of one weapon.
+ */
+struct analytics_weapon {
+    /** Name, cut to ANALYTICS_NAME_SIZE - 1 characters. "(other)" for weapons past ANALYTICS_MAX_WEAPONS. */
+    char name[ANALYTICS_NAME_SIZE];
+    /** Attacks made. */
+    uint64_t attacks;
+    /** Critical hits among them. */
+    uint64_t crits;
+    /** Damage dealt in total. */
+    uint64_t damage;
+    /** Median damage of a hit. */
+    unsigned int damage_p50;
+    /** 90th percentile damage of a hit. */
+    unsigned int damage_p90;
+    /** 99th percentile damage of a hit. */
+    unsigned int damage_p99;
+    /** Most damage of a hit. */
+    unsigned int damage_max;
+};
+
+/**
+ * @struct analytics_armor
+ * @brief Aggregates of one armor, "(none)" standing for players wearing none.
+ */
+struct analytics_armor {
+    /** Name, cut to ANALYTICS_NAME_SIZE - 1 characters. "(other)" for armors past ANALYTICS_MAX_ARMORS. */
+    char name[ANALYTICS_NAME_SIZE];
+    /** Attacks taken. */
+    uint64_t attacks;
+    /** Weapon damage of those attacks. */
+    uint64_t incoming;
+    /** Damage they would have dealt without critical hits. */
+    uint64_t mitigated;
+};
+
+/**
+ * @brief Starts or stops recording. Thread safe.
+ *
+ * @param[in] enabled Whether attacks are recorded from now on.
+ */
+void analytics_enable(const bool enabled);
+/**
+ * @brief Checks whether attacks are recorded. Thread safe.
+ *
+ * @return true if recording, false otherwise.
+ */
+bool analytics_is_enabled(void);
+/**
+ * @brief Records an attack if recording. Thread safe, called by player_attack_r().
+ *
+ * @param[in] weapon_name Name of the weapon.
+ * @param[in] armor_name Name of the target's armor, NULL if it wears none.
+ * @param[in] weapon_damage Damage of the weapon before the armor.
+ * @param[in] normal_damage Damage of a normal hit after the armor.
+ * @param[in] dealt Damage dealt, more than normal_damage for a critical hit.
+ * @param[in] hits_to_kill Hits the target took over its life if this one killed it, 0 otherwise.
+ */
+void analytics_record_attack(const char *weapon_name, const char *armor_name, const unsigned int weapon_damage, const unsigned int normal_damage, const unsigned int dealt, const unsigned int hits_to_kill);
+/**
+ * @brief Gets the aggregates of a weapon. Thread safe.
+ *
+ * @param[in] weapon_name Name of the weapon.
+ * @param[out] w Pointer to caller allocated weapon aggregates struct.
+ * @return true if the weapon was seen, false otherwise.
+ */
+bool analytics_get_weapon(const char *weapon_name, struct analytics_weapon *w);
+/**
+ * @brief Gets the aggregates of an armor. Thread safe.
+ *
+ * @param[in] armor_name Name of the armor, NULL for players wearing none.
+ * @param[out] a Pointer to caller allocated armor aggregates struct.
+ * @return true if the armor was seen, false otherwise.
+ */
+bool analytics_get_armor(const char *armor_name, struct analytics_armor *a);
+/**
+ * @brief Gets a quantile of the hits it took to kill a player. Thread safe.
+ *
+ * @param[in] quantile Quantile, from 0 to 1.
+ * @return Highest hit count of the bucket holding the quantile, 0 if nobody was killed.
+ */
+unsigned int analytics_hits_to_kill_quantile(const double quantile);
+/**
+ * @brief Writes every aggregate as a JSON object. Thread safe.
+ *
+ * @param[in] out Stream to write to.
+ * @return true if success, false otherwise.
+ */
+bool analytics_dump(FILE *out);
+/**
+ * @brief Clears every aggregate. Not safe while other threads record.
+ */
+void analytics_reset(void);
@@ -1,7 +1,9 @@
 /*! Armor declaration file. */
 
 #pragma once
+#include "name.h"
 #include <stdbool.h>
+#include <stddef.h>
 
 /**
  * @struct armor
@@ -16,7 +18,35 @@ struct armor {
     unsigned int _armor_max_health;
 
     /** Armor's name */
-    char *armor_name;
+    struct name armor_name;
+};
+
+/**
+ * @struct armor_spec
+ * @brief Arguments of armor_initialize(), for building many armors at once.
+ */
+struct armor_spec {
+    /** Name of the armor. */
+    const char *name;
+    /** Health of the armor. */
+    unsigned int health;
+    /** Max health of the armor. */
+    unsigned int max_health;
+    /** Resistance force of the armor. */
+    unsigned int resistance_force;
+};
+
+/**
+ * @struct armor_batch
+ * @brief Armors built together, with one allocation for the structs and one for the names.
+ */
+struct armor_batch {
+    /** Armors, in the order of their specs. */
+    struct armor *armors;
+    /** Names too long to be inline, NULL if there are none. */
+    char *names;
+    /** Number of armors. */
+    size_t size;
 };
 
 /**
@@ -30,6 +60,17 @@ struct armor {
  * @return true if armor created, false otherwise.
  */
 bool armor_initialize(const char *name, const unsigned int health, const unsigned int max_health, const unsigned int resistance_force, struct armor *a);
+/**
+ * @brief Initializes armors from specs, validated as armor_initialize() does.
+ * 
+ * Copies of the armors share their long names with the batch, so they must not outlive it.
+ * 
+ * @param[in] specs Specs of the armors.
+ * @param[in] total Number of specs.
+ * @param[out] batch Pointer to caller allocated batch struct.
+ * @return true if every armor was created, false otherwise.
+ */
+bool armor_batch_initialize(const struct armor_spec *specs, const size_t total, struct armor_batch *batch);
 /**
  * @brief Gets the armor's health.
  * 
@@ -58,6 +99,13 @@ void armor_enhance_armor(const unsigned int new_resistance_force, struct armor *
  * @param[in,out] a Pointer to armor struct.
  */
 void armor_repair_armor(const unsigned int repair_amount, struct armor *a);
+/**
+ * @brief Wears the armor by decreasing its health, never below 0.
+ * 
+ * @param[in] wear_amount Amount to decrease the armor health by.
+ * @param[in,out] a Pointer to armor struct.
+ */
+void armor_wear_armor(const unsigned int wear_amount, struct armor *a);
 /**
  * @brief Prints all the details of armor.
  * 
@@ -85,4 +133,10 @@ void armor_add_armor(const struct armor *a1, const struct armor *a2, struct armo
  * 
  * @param[in] a Pointer to armor struct.
  */
-void armor_deinitialize(struct armor *a);
\ No newline at end of file
+void armor_deinitialize(struct armor *a);
+/**
+ * @brief Deinitializes the batch and every armor in it.
+ * 
+ * @param[in] batch Pointer to batch struct.
+ */
+void armor_batch_deinitialize(struct armor_batch *batch);
\ No newline at end of file
@@ -0,0 +1,111 @@
+/*! Balance analyzer declaration file */
+
+#pragma once
+
+#include "vector.h"
+#include "weapon.h"
+#include "armor.h"
+#include "job_system.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * @struct balance_config
+ * @brief Rules of the duels played for every matchup.
+ *
+ * Both sides start at the same health and take turns attacking, the first loadout of a matchup attacks first.
+ */
+struct balance_config {
+    /** Starting health of both sides. */
+    unsigned int health;
+    /** Health each side heals after the other side attacked, 0 for none. */
+    unsigned int heal_per_turn;
+    /** If set, weapons wear by damage / 10 per hit and a broken weapon deals no damage. */
+    bool weapon_wear;
+    /** Attacks per side before a duel counts as a draw. */
+    unsigned int max_turns;
+    /** Duels sampled for a matchup that has no closed form. */
+    unsigned int samples;
+};
+
+/**
+ * @struct balance_cell
+ * @brief Outcome of one matchup.
+ */
+struct balance_cell {
+    /** Probability that the attacker kills the defender first. */
+    double win_probability;
+    /** Probability that nobody dies within max_turns. */
+    double draw_probability;
+    /** Mean attacker turns to kill the defender, over the duels the attacker won. 0 if it never wins. */
+    double mean_turns_to_kill;
+    /** Set if the cell was sampled instead of computed exactly. */
+    bool sampled;
+};
+
+/**
+ * @struct balance_matrix
+ * @brief Every weapon and armor pairing played against every other.
+ *
+ * Loadout i uses weapon i / total_armors and armor i % total_armors.
+ * Cell (i, j) is at cells[i * total_loadouts + j], loadout i attacking first.
+ */
+struct balance_matrix {
+    /** Weapons of the catalog, owned by the caller. */
+    const struct vector *weapons;
+    /** Armors of the catalog, owned by the caller. */
+    const struct vector *armors;
+    /** Number of loadouts. */
+    size_t total_loadouts;
+    /** total_loadouts * total_loadouts cells. */
+    struct balance_cell *cells;
+    /** Number of cells that had to be sampled. */
+    size_t total_sampled;
+};
+
+/**
+ * @brief Gets the default duel rules: 100 health, no healing, no wear.
+ *
+ * @return Default config.
+ */
+struct balance_config balance_default_config(void);
+/**
+ * @brief Loads weapons and armors from a catalog file.
+ *
+ * One entry per line, blank lines and lines starting with '#' are skipped:
+ * `weapon <name> <health> <damage>` or `armor <name> <health> <max_health> <resistance>`.
+ *
+ * @param[in] path Path of the catalog.
+ * @param[out] weapons Pointer to caller allocated vector, initialized here for struct weapon.
+ * @param[out] armors Pointer to caller allocated vector, initialized here for struct armor.
+ * @return true if success, false on I/O or parse errors.
+ */
+bool balance_load_catalog(const char *path, struct vector *weapons, struct vector *armors);
+/**
+ * @brief Computes every matchup of the catalog.
+ *
+ * Cells without healing or weapon breakage are solved exactly from the binomial
+ * distribution of critical hits, the rest are sampled. Rows run as jobs when a job system is given.
+ *
+ * @param[in] weapons Vector of struct weapon.
+ * @param[in] armors Vector of struct armor.
+ * @param[in] config Duel rules.
+ * @param[in,out] js Job system to run on, NULL to run on the calling thread.
+ * @param[out] m Pointer to caller allocated matrix struct.
+ * @return true if success, false otherwise.
+ */
+bool balance_analyze(const struct vector *weapons, const struct vector *armors, const struct balance_config *config, struct job_system *js, struct balance_matrix *m);
+/**
+ * @brief Writes the matrix as CSV: attacker,defender,win_probability,draw_probability,mean_turns_to_kill,method.
+ *
+ * @param[in] m Pointer to matrix struct.
+ * @param[in] out Stream to write to.
+ */
+void balance_print_csv(const struct balance_matrix *m, FILE *out);
+/**
+ * @brief Deinitializes the matrix. The catalog is not touched.
+ *
+ * @param[in] m Pointer to matrix struct.
+ */
+void balance_matrix_deinitialize(struct balance_matrix *m);
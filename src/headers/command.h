@@ -0,0 +1,135 @@
+/*! Console command declaration file */
+
+#pragma once
+
+#include "radix.h"
+#include "tokenizer.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Forward declaration, commands only act through player.h. */
+struct player;
+
+/** Longest weapon or armor name a command takes, including the NUL-terminator. */
+#define COMMAND_NAME_SIZE 128
+/** Health of weapons made by the add command. */
+#define COMMAND_WEAPON_HEALTH 100
+/** Health and max health of armors made by the equip command. */
+#define COMMAND_ARMOR_HEALTH 100
+/** Most edits between a typed weapon name and the name it is taken for. */
+#define COMMAND_MAX_TYPOS 2
+/** Most candidates listed when a name given to remove does not pick one weapon. */
+#define COMMAND_MAX_CANDIDATES 8
+
+/*
+Console language, one command per line, numbers first and the name last so it may contain spaces:
+
+add <damage> <weapon>          makes a weapon and adds it to the player
+remove <weapon>                removes a weapon from the player
+equip <resistance> <armor>     makes an armor and equips it, if the player wears none
+attack <weapon>                attacks the opponent and ends the turn
+heal <amount>                  heals the player
+repair <amount> <weapon>       repairs a weapon
+enhance <amount> <weapon>      enhances a weapon
+stats                          prints the player's stats
+
+A weapon may be named by its exact name, by a prefix of exactly one name, or with up to COMMAND_MAX_TYPOS typos.
+remove destroys the weapon, so it does not guess: it takes the exact name or a prefix of exactly one name,
+and otherwise prints the candidates and fails.
+
+Verbs are found with a perfect hash of their first, second and last characters and their length.
+The table is built by the compiler from designated initializers, so two verbs hashing to one slot
+fail the build with -Woverride-init; pick another COMMAND_HASH_MULTIPLIER or widen the table then.
+*/
+
+/** Bits of a verb hash, the table has 1 << COMMAND_TABLE_BITS slots. */
+#define COMMAND_TABLE_BITS 3
+/** Multiplier of the verb hash, found by trying odd numbers until every verb got its own slot. */
+#define COMMAND_HASH_MULTIPLIER 1653u
+/** Shortest verb, shorter words are not looked up. */
+#define COMMAND_MIN_VERB_LENGTH 3
+/** Longest verb, longer words are not looked up. */
+#define COMMAND_MAX_VERB_LENGTH 7
+
+/** Slot of a verb, usable in constant expressions. */
+#define COMMAND_HASH(first, second, last, length)                                   \
+    ((uint32_t)(((uint32_t)(unsigned char)(first) | (uint32_t)(unsigned char)(second) << 8 | \
+                 (uint32_t)(unsigned char)(last) << 16 | (uint32_t)(length) << 24) *         \
+                COMMAND_HASH_MULTIPLIER) >> (32 - COMMAND_TABLE_BITS))
+
+/**
+ * @enum command_verb
+ * @brief Verbs of the console language.
+ */
+enum command_verb {
+    /** Not a verb. */
+    COMMAND_VERB_UNKNOWN,
+    COMMAND_VERB_ADD,
+    COMMAND_VERB_REMOVE,
+    COMMAND_VERB_EQUIP,
+    COMMAND_VERB_ATTACK,
+    COMMAND_VERB_HEAL,
+    COMMAND_VERB_REPAIR,
+    COMMAND_VERB_ENHANCE,
+    COMMAND_VERB_STATS,
+    /** Number of verbs, COMMAND_VERB_UNKNOWN included. */
+    COMMAND_VERB_COUNT
+};
+
+/**
+ * @struct command_context
+ * @brief What commands act on.
+ *
+ * Weapons made by commands belong to the player's weapons vector from then on, like those of server sessions,
+ * and removed weapons are freed. Armors are moved into the player, which frees them when deinitialized. While the context lives, the player's weapons may only be added or
+ * removed through commands, which keep the name index up to date.
+ */
+struct command_context {
+    /** Player typing the commands. */
+    struct player *player;
+    /** Player attacked by the attack command, may be NULL. */
+    struct player *opponent;
+    /** Names of the player's weapons, with their positions. */
+    struct radix_tree weapon_names;
+    /** Set by the attack command. */
+    bool turn_over;
+};
+
+/**
+ * @brief Initializes the context and indexes the player's weapons.
+ *
+ * @param[in] player Player typing the commands.
+ * @param[in] opponent Player attacked by the attack command, may be NULL.
+ * @param[out] ctx Pointer to caller allocated command context struct.
+ * @return true if success, false otherwise.
+ */
+bool command_context_initialize(struct player *player, struct player *opponent, struct command_context *ctx);
+/**
+ * @brief Deinitializes the context. The players are not touched.
+ *
+ * @param[in] ctx Pointer to command context struct.
+ */
+void command_context_deinitialize(struct command_context *ctx);
+/**
+ * @brief Looks up a verb in constant time.
+ *
+ * @param[in] verb Word to look up, case sensitive.
+ * @return Verb, COMMAND_VERB_UNKNOWN if the word is not one.
+ */
+enum command_verb command_lookup(const struct string_view verb);
+/**
+ * @brief Gets the spelling of a verb.
+ *
+ * @param[in] verb Verb.
+ * @return Verb as typed, NULL for COMMAND_VERB_UNKNOWN or a value out of range.
+ */
+const char *command_verb_name(const enum command_verb verb);
+/**
+ * @brief Parses a line and runs its command.
+ *
+ * @param[in] line Line to run, does not need to be NUL-terminated.
+ * @param[in,out] ctx Pointer to command context struct.
+ * @return true if the command ran, false on an unknown verb, bad arguments or if it could not be carried out.
+ */
+bool command_execute(const struct string_view line, struct command_context *ctx);
@@ -0,0 +1,114 @@
+/*! Damage model declaration file */
+
+#pragma once
+
+#include "../third_party/pcg_basic.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <limits.h>
+#include <assert.h>
+
+/*
+Every constant below can be overridden at compile time (-D or the matching CMake cache variable).
+All arithmetic is integer, so a given seed deals the same damage on every compiler and platform.
+*/
+
+/** Divides the weapon damage by the armor resistance, 0 resistance blocks everything. */
+#define DAMAGE_ARMOR_DIVIDE 0
+/** Subtracts the armor resistance from the weapon damage, never below 0. */
+#define DAMAGE_ARMOR_SUBTRACT 1
+/** Scales the weapon damage by 100 / (100 + armor resistance). */
+#define DAMAGE_ARMOR_PERCENT 2
+
+#ifndef DAMAGE_ARMOR_FORMULA
+/** Armor formula in use, one of the DAMAGE_ARMOR_* values. */
+#define DAMAGE_ARMOR_FORMULA DAMAGE_ARMOR_DIVIDE
+#endif
+
+#ifndef DAMAGE_CRIT_NUMERATOR
+/** Numerator of the critical hit chance. */
+#define DAMAGE_CRIT_NUMERATOR 1
+#endif
+
+#ifndef DAMAGE_CRIT_DENOMINATOR
+/** Denominator of the critical hit chance. */
+#define DAMAGE_CRIT_DENOMINATOR 4
+#endif
+
+/** Fractional bits of fixed-point multipliers. */
+#define DAMAGE_FIXED_SHIFT 16
+/** 1.0 in fixed point. */
+#define DAMAGE_FIXED_ONE (1u << DAMAGE_FIXED_SHIFT)
+
+#ifndef DAMAGE_CRIT_MULTIPLIER
+/** Critical hit multiplier in 16.16 fixed point, 1.5 by default. */
+#define DAMAGE_CRIT_MULTIPLIER (DAMAGE_FIXED_ONE + DAMAGE_FIXED_ONE / 2)
+#endif
+
+static_assert(DAMAGE_ARMOR_FORMULA >= DAMAGE_ARMOR_DIVIDE && DAMAGE_ARMOR_FORMULA <= DAMAGE_ARMOR_PERCENT, "unknown DAMAGE_ARMOR_FORMULA");
+static_assert(DAMAGE_CRIT_DENOMINATOR > 0, "DAMAGE_CRIT_DENOMINATOR cannot be 0");
+static_assert(DAMAGE_CRIT_NUMERATOR <= DAMAGE_CRIT_DENOMINATOR, "critical hit chance cannot exceed 1");
+static_assert(DAMAGE_CRIT_MULTIPLIER >= DAMAGE_FIXED_ONE, "critical hits cannot deal less than normal hits");
+
+/**
+ * @brief Applies the armor formula.
+ *
+ * @param[in] weapon_damage Base weapon damage.
+ * @param[in] armor_resistance Armor resistance.
+ * @return Damage of a normal hit.
+ */
+static inline unsigned int damage_mitigate(const unsigned int weapon_damage, const unsigned int armor_resistance)
+{
+#if DAMAGE_ARMOR_FORMULA == DAMAGE_ARMOR_DIVIDE
+    return armor_resistance ? weapon_damage / armor_resistance : 0;
+#elif DAMAGE_ARMOR_FORMULA == DAMAGE_ARMOR_SUBTRACT
+    return weapon_damage > armor_resistance ? weapon_damage - armor_resistance : 0;
+#else
+    return (unsigned int)((uint64_t)weapon_damage * 100 / (100 + (uint64_t)armor_resistance));
+#endif
+}
+
+/**
+ * @brief Scales a normal hit into a critical one if is_crit is set, without branching on it.
+ *
+ * @param[in] base_damage Damage of a normal hit.
+ * @param[in] is_crit Whether the hit is critical.
+ * @return Damage dealt, saturated at UINT_MAX.
+ */
+static inline unsigned int damage_apply_crit(const unsigned int base_damage, const bool is_crit)
+{
+    const uint64_t bonus = ((uint64_t)base_damage * (DAMAGE_CRIT_MULTIPLIER - DAMAGE_FIXED_ONE)) >> DAMAGE_FIXED_SHIFT;
+    const uint64_t total = base_damage + (bonus & (0 - (uint64_t)is_crit));
+    return total > UINT_MAX ? UINT_MAX : (unsigned int)total;
+}
+
+/**
+ * @brief Draws whether a hit is critical, without modulo bias.
+ *
+ * Power of two denominators take the top bits of a single draw, others use rejection sampling.
+ *
+ * @param[in,out] rng Random state to draw from.
+ * @return true with probability DAMAGE_CRIT_NUMERATOR / DAMAGE_CRIT_DENOMINATOR.
+ */
+static inline bool damage_roll_crit(pcg32_random_t *rng)
+{
+#if (DAMAGE_CRIT_DENOMINATOR & (DAMAGE_CRIT_DENOMINATOR - 1)) == 0
+    const uint64_t draw = ((uint64_t)pcg32_random_r(rng) * DAMAGE_CRIT_DENOMINATOR) >> 32;
+#else
+    const uint32_t draw = pcg32_boundedrand_r(rng, DAMAGE_CRIT_DENOMINATOR);
+#endif
+    return draw < DAMAGE_CRIT_NUMERATOR;
+}
+
+/**
+ * @brief Rolls the damage of one hit.
+ *
+ * @param[in] weapon_damage Base weapon damage.
+ * @param[in] armor_resistance Armor resistance.
+ * @param[in,out] rng Random state to draw from.
+ * @return Damage dealt.
+ */
+static inline unsigned int damage_roll(const unsigned int weapon_damage, const unsigned int armor_resistance, pcg32_random_t *rng)
+{
+    return damage_apply_crit(damage_mitigate(weapon_damage, armor_resistance), damage_roll_crit(rng));
+}
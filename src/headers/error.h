@@ -0,0 +1,94 @@
+/*! Error reporting declaration file */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/** Environment variable naming the file main() logs errors to. */
+#define ERROR_LOG_PATH_VARIABLE "GAME_ERROR_LOG"
+/** Errors the log holds before the drain thread catches up, later ones are dropped and counted. */
+#define ERROR_LOG_CAPACITY 4096
+/** How long the drain thread sleeps once the log is empty, in milliseconds. */
+#define ERROR_LOG_DRAIN_MS 10
+
+/*
+Failing functions keep returning false or NULL, and tell why through error_last(), which
+works like errno: one value per thread, set by the last failure and left alone by successes.
+Setting it is a thread local store, so failures in loops cost about what successes do.
+
+Errors are printed only while the log runs, and not from the thread that failed: error_set()
+copies the code and the function name into a lock-free ring, and a background thread formats
+and writes them. ERROR_NOT_FOUND is an expected outcome of lookups and is never logged.
+*/
+
+/**
+ * @enum error_code
+ * @brief Why a call failed.
+ */
+enum error_code {
+    /** No failure since the last error_clear(). */
+    ERROR_NONE,
+    /** A required pointer was NULL. */
+    ERROR_NULL_ARGUMENT,
+    /** An argument was out of its domain, such as an empty name or a zero size. */
+    ERROR_INVALID_ARGUMENT,
+    /** An index was past the end. */
+    ERROR_OUT_OF_RANGE,
+    /** An allocation failed. */
+    ERROR_OUT_OF_MEMORY,
+    /** A lookup found nothing. */
+    ERROR_NOT_FOUND,
+    /** Number of codes. */
+    ERROR_COUNT
+};
+
+/**
+ * @brief Records a failure of the calling thread, and logs it if the log runs.
+ *
+ * @param[in] code Why the call failed.
+ * @param[in] where Name of the failing function, must outlive the log as only the pointer is kept.
+ * @return false, so failing functions can return it.
+ */
+bool error_set(const enum error_code code, const char *where);
+/**
+ * @brief Gets the last failure of the calling thread.
+ *
+ * @return Code of the last failure, ERROR_NONE if none since error_clear().
+ */
+enum error_code error_last(void);
+/**
+ * @brief Gets the function of the last failure of the calling thread.
+ *
+ * @return Function name, NULL if none since error_clear().
+ */
+const char *error_last_where(void);
+/**
+ * @brief Forgets the last failure of the calling thread.
+ */
+void error_clear(void);
+/**
+ * @brief Gets the name of a code.
+ *
+ * @param[in] code Error code.
+ * @return Name such as "out of range", NULL for a value out of range.
+ */
+const char *error_code_name(const enum error_code code);
+/**
+ * @brief Starts the drain thread writing logged errors to a stream. No thread may log meanwhile.
+ *
+ * @param[in] out Stream to write to, owned by the caller.
+ * @return true if success, false if already running or the thread could not start.
+ */
+bool error_log_start(FILE *out);
+/**
+ * @brief Stops the drain thread once it wrote everything logged so far. No thread may log meanwhile.
+ */
+void error_log_stop(void);
+/**
+ * @brief Gets the number of errors dropped because the log was full since it started. Thread safe.
+ *
+ * @return Dropped errors.
+ */
+size_t error_log_dropped(void);
@@ -9,14 +9,31 @@
 
 /** Forward declaration to avoid linking issues */
 struct player;
+/** Forward declaration, chunk tables are private to game.c. */
+struct game_table;
+
+/** Players per copy-on-write chunk. At most 64, chunks track their players in a bit mask. */
+#define GAME_CHUNK_PLAYERS 32
 
 /**
  * @struct game
- * @brief Represents the main game.
+ * @brief Represents the main game. Holds no global state, so any number of games can live in one process.
+ *
+ * Players live in fixed-size chunks listed by a chunk table. Forked games share the table and
+ * the chunks, and copy a chunk the first time they modify one of its players.
+ *
+ * The game copies the weapons vector and inventory index of inserted players, so inserted players
+ * never alias their caller's; the weapons in the vector, names included, stay the caller's to free.
+ * The copies, and those made for a fork, belong to the chunk that made them and are freed with it.
+ * Names longer than NAME_SIZE - 1 are shared rather than copied, so players must outlive every game they were forked into.
+ * Players inserted with game_insert_player_move() belong to the game instead and are deinitialized with it,
+ * and a fork modifying one gets a deep copy, so they need no outside owner at all.
  */
 struct game {
-    /** Holds all the current players. */
-    struct vector players;
+    /** Chunks holding the players, possibly shared with forks. */
+    struct game_table *table;
+    /** Number of players. */
+    size_t total_players;
 };
 
 /**
@@ -30,23 +47,74 @@ bool game_initialize(const unsigned int initial_capacity, struct game *g);
 /**
  * @brief Adds a player into game.
  * 
+ * The game keeps its own copy of the player's weapons vector and index, see struct game, so p
+ * is left as is and still needs deinitializing.
+ * 
  * @param[in] p Pointer to player struct.
  * @param[in] g Pointer to game struct.
  * @return true if success, false otherwise.
  */
 bool game_insert_player(const struct player *p, struct game *g);
+/**
+ * @brief Moves a player into the game, which deinitializes it along with what it owns once removed or at the end.
+ * 
+ * @param[in,out] p Pointer to player struct, zeroed once moved. Left untouched on failure.
+ * @param[in] g Pointer to game struct.
+ * @return true if success, false otherwise.
+ */
+bool game_insert_player_move(struct player *p, struct game *g);
 /**
  * @brief Removes a player from the game.
  * 
+ * p is either a player of the game, as got from game_get_player(), or the first player with the same
+ * name is removed. A struct zeroed by game_insert_player_move() names nobody; prefer
+ * game_remove_player_at() when the position is known.
+ * 
  * @param[in] p Pointer to player struct.
  * @param[in] g Pointer to game struct.
  * @return true if success, false otherwise.
  */
 bool game_remove_player(const struct player *p, struct game *g);
+/**
+ * @brief Removes the player at the given position from the game.
+ * 
+ * @param[in] index Position of the player.
+ * @param[in] g Pointer to game struct.
+ * @return true if success, false otherwise.
+ */
+bool game_remove_player_at(const size_t index, struct game *g);
+/**
+ * @brief Gets the player at the given position.
+ * 
+ * @param[in] index Position of the player.
+ * @param[in] g Pointer to game struct.
+ * @return Pointer to the player if success, NULL otherwise. Invalidated by inserting or removing players.
+ */
+const struct player *game_get_player(const size_t index, const struct game *g);
+/**
+ * @brief Gets the player at the given position for modification.
+ * 
+ * Copies the player's chunk first if it is shared with a fork, so the changes stay in this game.
+ * 
+ * @param[in] index Position of the player.
+ * @param[in] g Pointer to game struct.
+ * @return Pointer to the player if success, NULL otherwise. Invalidated by inserting or removing players.
+ */
+struct player *game_get_player_mut(const size_t index, struct game *g);
+/**
+ * @brief Forks the game in O(1). Both games can then be modified independently.
+ * 
+ * Forks may be used from different threads, as long as each game is used by one thread at a time.
+ * 
+ * @param[in] src Pointer to game struct to fork.
+ * @param[out] dst Pointer to caller allocated game struct, deinitialized like any game.
+ * @return true if success, false otherwise.
+ */
+bool game_fork(const struct game *src, struct game *dst);
 /**
  * @brief Gets the game's winner.
  * 
- * @param[out] winner Pointer to caller allocated player struct.
+ * @param[out] winner Pointer to caller allocated player struct, a shallow copy that must not be deinitialized.
  * @param[in] g Pointer to game struct.
  */
 void game_get_winner(struct player *winner, const struct game *g);
@@ -0,0 +1,80 @@
+/*! Input thread declaration file */
+
+#pragma once
+
+#include "spsc_queue.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdatomic.h>
+#include <threads.h>
+
+/** Longest line kept by a command, including the NUL-terminator. Longer lines are truncated. */
+#define INPUT_LINE_SIZE 128
+/** How often the reader wakes up to check if it was asked to stop, in milliseconds. */
+#define INPUT_POLL_MS 50
+
+/**
+ * @struct input_command
+ * @brief One line of player input, trimmed. Splitting it into a verb and arguments is left to command.h.
+ */
+struct input_command {
+    /** Trimmed line as typed by the player. */
+    char line[INPUT_LINE_SIZE];
+};
+
+/**
+ * @struct input_thread
+ * @brief Reads a stream on its own thread and queues parsed commands for the game loop.
+ */
+struct input_thread {
+    /** Parsed commands, produced by the reader and consumed by the game loop. */
+    struct spsc_queue commands;
+    /** Stream to read from, owned by the caller. */
+    FILE *stream;
+    /** Reader thread. */
+    thrd_t thread;
+    /** Cleared to ask the reader to stop. */
+    atomic_bool running;
+    /** Set by the reader once the stream ended and its last command was queued. */
+    atomic_bool closed;
+};
+
+/**
+ * @brief Trims a line into a command, truncating it to INPUT_LINE_SIZE - 1 characters.
+ *
+ * @param[in] line Line to parse, does not need to be NUL-terminated.
+ * @param[in] length Length of the line.
+ * @param[out] cmd Pointer to caller allocated command struct.
+ */
+void input_command_parse(const char *line, const size_t length, struct input_command *cmd);
+/**
+ * @brief Starts the reader thread.
+ *
+ * @param[in] stream Stream to read commands from.
+ * @param[in] queue_capacity How many commands can wait to be drained.
+ * @param[out] it Pointer to caller allocated input thread struct. Must stay in place until stopped.
+ * @return true if the thread started, false otherwise.
+ */
+bool input_thread_start(FILE *stream, const size_t queue_capacity, struct input_thread *it);
+/**
+ * @brief Takes the oldest queued command without blocking.
+ *
+ * @param[in] it Pointer to input thread struct.
+ * @param[out] cmd Pointer to caller allocated command struct.
+ * @return true if a command was taken, false if none is waiting.
+ */
+bool input_thread_poll(struct input_thread *it, struct input_command *cmd);
+/**
+ * @brief Checks if the stream ended and every command was drained.
+ *
+ * @param[in] it Pointer to input thread struct.
+ * @return true if no command will ever arrive again, false otherwise.
+ */
+bool input_thread_is_closed(struct input_thread *it);
+/**
+ * @brief Stops the reader thread and releases the queue.
+ *
+ * @param[in] it Pointer to input thread struct.
+ */
+void input_thread_stop(struct input_thread *it);
@@ -0,0 +1,140 @@
+/*! Inventory index declaration file */
+
+#pragma once
+
+#include "vector.h"
+#include "weapon.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @struct inventory_key
+ * @brief Stats a weapon was indexed with.
+ */
+struct inventory_key {
+    /** Weapon damage when last indexed. */
+    unsigned int damage;
+    /** Weapon health when last indexed. */
+    unsigned int health;
+};
+
+/**
+ * @struct inventory_index
+ * @brief Orders of a weapons vector by damage and by durability, kept up to date as weapons change.
+ *
+ * Both orders list usable weapons (health and damage above 0) first, so queries are a lookup
+ * or a binary search. Adding, removing or changing a weapon costs a binary search plus a shift.
+ */
+struct inventory_index {
+    /** Key of every weapon, by position in the weapons vector. */
+    struct inventory_key *keys;
+    /** Weapon positions, most damage first, more health first on ties. */
+    size_t *by_damage;
+    /** Weapon positions, most health first, more damage first on ties. */
+    size_t *by_durability;
+    /** Number of weapons indexed. */
+    size_t size;
+    /** Number of weapons there is room for. */
+    size_t capacity;
+    /** The arrays are in caller owned storage, moved to the heap before growing. */
+    bool _borrowed;
+};
+
+/**
+ * @brief Initializes the index with every weapon of the vector.
+ *
+ * @param[in] weapons Vector of struct weapon.
+ * @param[out] idx Pointer to caller allocated index struct.
+ * @return true if success, false otherwise.
+ */
+bool inventory_index_initialize(const struct vector *weapons, struct inventory_index *idx);
+/**
+ * @brief Gets the storage inventory_index_initialize_in() needs for a number of weapons.
+ *
+ * @param[in] total Number of weapons.
+ * @return Bytes, a multiple of sizeof(size_t) so storage for several indexes can be packed.
+ */
+size_t inventory_index_storage_size(const size_t total);
+/**
+ * @brief Initializes the index with every weapon of the vector, in caller owned storage.
+ *
+ * The storage is left alone when the index grows or is deinitialized.
+ *
+ * @param[in] weapons Vector of struct weapon.
+ * @param[out] storage inventory_index_storage_size(weapons->size) bytes, aligned for size_t.
+ * @param[out] idx Pointer to caller allocated index struct.
+ * @return true if success, false otherwise.
+ */
+bool inventory_index_initialize_in(const struct vector *weapons, void *storage, struct inventory_index *idx);
+/**
+ * @brief Initializes dst with a copy of src.
+ *
+ * @param[in] src Pointer to index struct to copy.
+ * @param[out] dst Pointer to caller allocated index struct.
+ * @return true if success, false otherwise.
+ */
+bool inventory_index_copy(const struct inventory_index *src, struct inventory_index *dst);
+/**
+ * @brief Makes room for total weapons, so the next insertions cannot fail.
+ *
+ * @param[in] total Number of weapons to make room for.
+ * @param[in,out] idx Pointer to index struct.
+ * @return true if success, false otherwise.
+ */
+bool inventory_index_reserve(const size_t total, struct inventory_index *idx);
+/**
+ * @brief Indexes the weapon just pushed to the back of the vector. Room must have been reserved.
+ *
+ * @param[in] weapons Vector of struct weapon.
+ * @param[in,out] idx Pointer to index struct.
+ */
+void inventory_index_push_back(const struct vector *weapons, struct inventory_index *idx);
+/**
+ * @brief Forgets a weapon about to be removed from the vector, renumbering those after it.
+ *
+ * @param[in] position Position of the weapon in the vector.
+ * @param[in,out] idx Pointer to index struct.
+ */
+void inventory_index_remove(const size_t position, struct inventory_index *idx);
+/**
+ * @brief Moves a weapon whose damage or health changed to its new place.
+ *
+ * @param[in] weapons Vector of struct weapon.
+ * @param[in] position Position of the changed weapon in the vector.
+ * @param[in,out] idx Pointer to index struct.
+ */
+void inventory_index_update(const struct vector *weapons, const size_t position, struct inventory_index *idx);
+/**
+ * @brief Gets the usable weapon with the most damage.
+ *
+ * @param[in] idx Pointer to index struct.
+ * @param[out] position Position of the weapon in the vector.
+ * @return true if a weapon is usable, false otherwise.
+ */
+bool inventory_index_strongest(const struct inventory_index *idx, size_t *position);
+/**
+ * @brief Gets the usable weapon with the most health.
+ *
+ * @param[in] idx Pointer to index struct.
+ * @param[out] position Position of the weapon in the vector.
+ * @return true if a weapon is usable, false otherwise.
+ */
+bool inventory_index_most_durable(const struct inventory_index *idx, size_t *position);
+/**
+ * @brief Gets the usable weapon that hits an armor hardest.
+ *
+ * Among weapons hitting equally hard once the armor is applied, picks the lowest base damage,
+ * saving stronger weapons for tougher armors, then the most health.
+ *
+ * @param[in] idx Pointer to index struct.
+ * @param[in] armor_resistance Resistance of the armor to hit.
+ * @param[out] position Position of the weapon in the vector.
+ * @return true if a usable weapon gets through the armor, false otherwise.
+ */
+bool inventory_index_best_against(const struct inventory_index *idx, const unsigned int armor_resistance, size_t *position);
+/**
+ * @brief Deinitializes the index. The weapons are not touched.
+ *
+ * @param[in] idx Pointer to index struct.
+ */
+void inventory_index_deinitialize(struct inventory_index *idx);
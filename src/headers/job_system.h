@@ -0,0 +1,125 @@
+/*! Job system declaration file */
+
+#pragma once
+
+#include "vector.h"
+#include "../third_party/pcg_basic.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <threads.h>
+
+/** Jobs a worker can hold before new submissions from it run inline. */
+#define JOB_DEQUE_CAPACITY 4096
+/** Assumed cache line size, keeps the two ends of a deque from false sharing. */
+#define JOB_CACHE_LINE 64
+
+/**
+ * @typedef job_func
+ * @brief A unit of work.
+ *
+ * @param[in] arg Argument given at submission.
+ * @param[in,out] rng Random state of the worker running the job, never shared with another thread.
+ */
+typedef void (*job_func)(void *arg, pcg32_random_t *rng);
+
+/**
+ * @struct job_deque
+ * @brief Chase-Lev deque: the owner pushes and pops at the bottom, thieves steal from the top.
+ *
+ * Slots are atomics so a thief reading a slot the owner is reusing is a lost race, not a data race.
+ */
+struct job_deque {
+    /** Job functions, JOB_DEQUE_CAPACITY slots. */
+    _Atomic(job_func) *funcs;
+    /** Job arguments, JOB_DEQUE_CAPACITY slots. */
+    _Atomic(void *) *args;
+    /** Next slot to steal from. */
+    alignas(JOB_CACHE_LINE) _Atomic int64_t top;
+    /** Next free slot, only moved by the owner. */
+    alignas(JOB_CACHE_LINE) _Atomic int64_t bottom;
+};
+
+/** Forward declaration, a worker points back to its system. */
+struct job_system;
+
+/**
+ * @struct job_worker
+ * @brief A worker thread with its own deque and random state.
+ */
+struct job_worker {
+    /** Jobs submitted by this worker. */
+    struct job_deque deque;
+    /** Random state handed to jobs run on this worker. */
+    pcg32_random_t rng;
+    /** Worker thread. */
+    thrd_t thread;
+    /** Owning system. */
+    struct job_system *system;
+    /** Position in the system's worker array. */
+    size_t index;
+};
+
+/**
+ * @struct job_system
+ * @brief Fixed pool of workers that balance uneven jobs by stealing from each other.
+ */
+struct job_system {
+    /** Worker array. */
+    struct job_worker *workers;
+    /** Number of workers. */
+    size_t total_workers;
+    /** Jobs submitted from outside the pool, guarded by lock. */
+    struct vector injected;
+    /** Guards injected and the sleep and completion conditions. */
+    mtx_t lock;
+    /** Signalled when new work is available for sleeping workers. */
+    cnd_t wake;
+    /** Broadcast when pending drops to zero. */
+    cnd_t done;
+    /** Jobs submitted and not yet finished. */
+    atomic_size_t pending;
+    /** Workers waiting on wake. */
+    atomic_size_t sleeping;
+    /** Cleared to shut the workers down. */
+    atomic_bool running;
+};
+
+/**
+ * @brief Gets a sensible worker count for this machine.
+ *
+ * @return Number of online processors, at least 1.
+ */
+size_t job_system_default_workers(void);
+/**
+ * @brief Initializes the job system and starts its workers.
+ *
+ * @param[in] total_workers Number of worker threads, cannot be 0.
+ * @param[in] seed Seed for the workers' random states, each worker gets its own stream.
+ * @param[out] js Pointer to caller allocated job system struct. Must stay in place until deinitialized.
+ * @return true if success, false otherwise.
+ */
+bool job_system_initialize(const size_t total_workers, const uint64_t seed, struct job_system *js);
+/**
+ * @brief Submits a job. Jobs may submit more jobs, those go to the submitting worker's deque.
+ *
+ * @param[in,out] js Pointer to job system struct.
+ * @param[in] func Job function.
+ * @param[in] arg Argument passed to func, must stay valid until the job ran.
+ * @return true if submitted, false otherwise.
+ */
+bool job_system_submit(struct job_system *js, job_func func, void *arg);
+/**
+ * @brief Blocks until every submitted job finished. Must not be called from a job.
+ *
+ * @param[in,out] js Pointer to job system struct.
+ */
+void job_system_wait(struct job_system *js);
+/**
+ * @brief Waits for outstanding jobs, stops the workers and deinitializes the job system.
+ *
+ * @param[in] js Pointer to job system struct.
+ */
+void job_system_deinitialize(struct job_system *js);
@@ -0,0 +1,88 @@
+/*! Name declaration file */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/** Bytes of a name. Names shorter than this are stored inline, longer ones on the heap. */
+#define NAME_SIZE 24
+
+/**
+ * @struct name
+ * @brief Entity name with small-string optimization.
+ *
+ * Inline names are NUL terminated in bytes, which leaves the last byte 0. Heap names keep their
+ * pointer at the start of bytes and a nonzero tag in the last byte. Nothing points into the struct
+ * itself, so names can be copied by value like the structs holding them; a heap name copied that
+ * way is shared, not duplicated. A zeroed name is the empty name.
+ */
+struct name {
+    /** Inline characters, or the heap pointer and the tag. */
+    char bytes[NAME_SIZE];
+};
+
+/**
+ * @brief Initializes a name with a copy of the string.
+ *
+ * @param[in] str String to copy.
+ * @param[out] n Pointer to caller allocated name struct.
+ * @return true if success, false otherwise.
+ */
+bool name_initialize(const char *str, struct name *n);
+/**
+ * @brief Initializes a name with two strings joined by a separator.
+ *
+ * @param[in] first String before the separator.
+ * @param[in] separator Character between the strings.
+ * @param[in] second String after the separator.
+ * @param[out] n Pointer to caller allocated name struct.
+ * @return true if success, false otherwise.
+ */
+bool name_join(const char *first, const char separator, const char *second, struct name *n);
+/**
+ * @brief Gets the bytes a name needs outside its struct.
+ *
+ * @param[in] str String the name would hold.
+ * @return Bytes needed by name_initialize_in(), 0 if the string fits inline.
+ */
+size_t name_external_size(const char *str);
+/**
+ * @brief Initializes a name whose characters, if they do not fit inline, live in caller owned storage.
+ *
+ * Lets many names share one allocation. name_deinitialize() leaves the storage alone.
+ *
+ * @param[in] str String to copy.
+ * @param[out] storage Where to copy a string that does not fit inline, name_external_size() bytes.
+ * @param[out] n Pointer to caller allocated name struct.
+ * @return true if success, false otherwise.
+ */
+bool name_initialize_in(const char *str, char *storage, struct name *n);
+/**
+ * @brief Gets the characters of a name.
+ *
+ * @param[in] n Pointer to name struct.
+ * @return NUL terminated string, valid until the name is deinitialized or, if inline, moved.
+ */
+const char *name_get(const struct name *n);
+/**
+ * @brief Compares a name with a string.
+ *
+ * @param[in] n Pointer to name struct.
+ * @param[in] str String to compare to.
+ * @return true if equal, false otherwise.
+ */
+bool name_equals(const struct name *n, const char *str);
+/**
+ * @brief Checks if a name is empty, as a zeroed or deinitialized name is.
+ *
+ * @param[in] n Pointer to name struct.
+ * @return true if empty, false otherwise.
+ */
+bool name_is_empty(const struct name *n);
+/**
+ * @brief Deinitializes a name, freeing it if it is on the heap and owned by the name.
+ *
+ * @param[in] n Pointer to name struct.
+ */
+void name_deinitialize(struct name *n);
@@ -0,0 +1,117 @@
+/*! Parallel algorithms declaration file */
+
+#pragma once
+
+#include "vector.h"
+#include "job_system.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/** Fewest elements a job handles, shorter ranges run on the calling thread. */
+#define PARALLEL_MIN_CHUNK 4096
+/** Jobs per worker a range is split into, so stealing can even out uneven chunks. */
+#define PARALLEL_CHUNKS_PER_WORKER 4
+
+/**
+ * @typedef parallel_each_func
+ * @brief Visits one element. Runs concurrently with other calls, on other elements.
+ *
+ * @param[in,out] element Element to visit.
+ * @param[in] arg Argument given to the algorithm.
+ */
+typedef void (*parallel_each_func)(void *element, void *arg);
+
+/**
+ * @typedef parallel_transform_func
+ * @brief Computes the output element of one input element. Runs concurrently with other calls.
+ *
+ * @param[in] element Input element.
+ * @param[out] out Output element.
+ * @param[in] arg Argument given to the algorithm.
+ */
+typedef void (*parallel_transform_func)(const void *element, void *out, void *arg);
+
+/**
+ * @typedef parallel_fold_func
+ * @brief Folds one element into a partial result. Runs concurrently, each call with its own partial.
+ *
+ * @param[in,out] partial Partial result.
+ * @param[in] element Element to fold in.
+ * @param[in] arg Argument given to the algorithm.
+ */
+typedef void (*parallel_fold_func)(void *partial, const void *element, void *arg);
+
+/**
+ * @typedef parallel_combine_func
+ * @brief Combines a partial result into the result. Called on the calling thread, in range order.
+ *
+ * @param[in,out] result Result so far.
+ * @param[in] partial Partial result of the next chunk.
+ * @param[in] arg Argument given to the algorithm.
+ */
+typedef void (*parallel_combine_func)(void *result, const void *partial, void *arg);
+
+/*
+Every algorithm works on the elements [first, last) of a vector. Ranges of at least twice
+PARALLEL_MIN_CHUNK elements are split into chunks run as jobs on js, anything shorter, or a NULL js,
+runs sequentially on the calling thread. Like job_system_wait(), they must not be called from a job.
+*/
+
+/**
+ * @brief Calls func on every element of the range.
+ *
+ * @param[in,out] vec Pointer to vector struct.
+ * @param[in] first Index of the first element.
+ * @param[in] last Index one past the last element.
+ * @param[in] func Function to call.
+ * @param[in] arg Argument passed to func.
+ * @param[in,out] js Pointer to job system struct, may be NULL.
+ * @return true if success, false on invalid arguments or allocation failure.
+ */
+bool parallel_for_each(struct vector *vec, const size_t first, const size_t last, parallel_each_func func, void *arg, struct job_system *js);
+/**
+ * @brief Fills dst with func of every element of the range, in order.
+ *
+ * @param[in] src Pointer to vector struct to read.
+ * @param[in] first Index of the first element.
+ * @param[in] last Index one past the last element.
+ * @param[in] func Function computing an output element.
+ * @param[in] arg Argument passed to func.
+ * @param[in,out] js Pointer to job system struct, may be NULL.
+ * @param[in,out] dst Pointer to initialized vector struct of output elements, its contents are replaced. Cannot be src.
+ * @return true if success, false on invalid arguments or allocation failure.
+ */
+bool parallel_transform(const struct vector *src, const size_t first, const size_t last, parallel_transform_func func, void *arg, struct job_system *js, struct vector *dst);
+/**
+ * @brief Reduces the range to a single result.
+ *
+ * Each chunk folds its elements into its own copy of identity, then the partial results are combined
+ * in range order, so the result does not depend on scheduling as long as fold and combine agree.
+ *
+ * @param[in] vec Pointer to vector struct.
+ * @param[in] first Index of the first element.
+ * @param[in] last Index one past the last element.
+ * @param[in] identity Initial value of every partial result and of the result.
+ * @param[in] result_size Size in bytes of a result.
+ * @param[in] fold Function folding an element into a partial result.
+ * @param[in] combine Function combining a partial result into the result.
+ * @param[in] arg Argument passed to fold and combine.
+ * @param[in,out] js Pointer to job system struct, may be NULL.
+ * @param[out] result Caller allocated result of result_size bytes.
+ * @return true if success, false on invalid arguments or allocation failure.
+ */
+bool parallel_reduce(const struct vector *vec, const size_t first, const size_t last, const void *identity, const size_t result_size, parallel_fold_func fold, parallel_combine_func combine, void *arg, struct job_system *js, void *result);
+/**
+ * @brief Sorts the range.
+ *
+ * Chunks are sorted as jobs, then merged pairwise, one round of jobs per doubling of the run length.
+ * Not stable, like qsort().
+ *
+ * @param[in,out] vec Pointer to vector struct.
+ * @param[in] first Index of the first element.
+ * @param[in] last Index one past the last element.
+ * @param[in] order Ordering function.
+ * @param[in,out] js Pointer to job system struct, may be NULL.
+ * @return true if success, false on invalid arguments or allocation failure.
+ */
+bool parallel_sort(struct vector *vec, const size_t first, const size_t last, order_func order, struct job_system *js);
@@ -6,7 +6,10 @@
 #include "game.h"
 #include "vector.h"
 #include "armor.h"
+#include "inventory.h"
+#include "../third_party/pcg_basic.h"
 #include <stdbool.h>
+#include <stddef.h>
 
 /**
  * @struct player
@@ -15,19 +18,62 @@
 struct player {
     /** Vector to hold weapons. */
     struct vector _weapons;
+    /** Weapons ordered by damage and durability, follows _weapons. */
+    struct inventory_index _weapon_index;
     /** Current armor used by player */
     struct armor current_armor;
     /** Player's name */
-    char *player_name;
+    struct name player_name;
     /** Player's health */
     unsigned int health;
     /** Boolean to check if player is already wearing armor or not */
     bool _isWearingArmor;
+    /** Whether the weapons in the vector were moved in and are freed with the player. The vector itself always is. */
+    bool _owns_weapons;
+    /** Whether the armor was moved in and is freed with the player. */
+    bool _owns_armor;
+    /** Attacks taken so far, recorded as the hits to kill by analytics.h. */
+    unsigned int _hits_taken;
+};
+
+/**
+ * @struct player_spec
+ * @brief Arguments of player_initialize(), for building many players at once.
+ */
+struct player_spec {
+    /** Name of the player. */
+    const char *name;
+    /** Health of the player. */
+    unsigned int health;
+    /** Vector of weapon. */
+    const struct vector *weapons;
+    /** Armor of the player. */
+    const struct armor *armor;
+};
+
+/**
+ * @struct player_batch
+ * @brief Players built together, with one allocation each for the structs, the names and the weapon indexes.
+ *
+ * Weapons vectors too big to stay inline are the only per-player allocations.
+ */
+struct player_batch {
+    /** Players, in the order of their specs. */
+    struct player *players;
+    /** Names too long to be inline, NULL if there are none. */
+    char *names;
+    /** Storage of every player's weapon index. */
+    void *indexes;
+    /** Number of players. */
+    size_t size;
 };
 
 /**
  * @brief Initializes player.
  * 
+ * The player gets its own copy of the weapons vector, however many weapons it holds, and frees it when
+ * deinitialized; the weapons in it, names included, stay the caller's. Weapons wear independently per player.
+ * 
  * @param[in] name Name of the player.
  * @param[in] health Health of the player.
  * @param[in] weapons Vector of weapon.
@@ -36,6 +82,41 @@ struct player {
  * @return true if success, false otherwise.
  */
 bool player_initialize(const char *name, const unsigned int health, const struct vector *weapons, const struct armor *armor, struct player *p);
+/**
+ * @brief Initializes player, taking over the weapons vector and the armor.
+ * 
+ * The player frees them on player_deinitialize(), along with every weapon in the vector at that time.
+ * The sources are zeroed so nothing else aliases them; on failure they are left untouched.
+ * 
+ * @param[in] name Name of the player.
+ * @param[in] health Health of the player.
+ * @param[in,out] weapons Vector of weapon to take over.
+ * @param[in,out] armor Armor to take over.
+ * @param[out] p Pointer to caller allocated player struct to initialize.
+ * @return true if success, false otherwise.
+ */
+bool player_initialize_move(const char *name, const unsigned int health, struct vector *weapons, struct armor *armor, struct player *p);
+/**
+ * @brief Initializes dst with a deep copy of src, which dst owns whatever src owns.
+ * 
+ * @param[in] src Pointer to player struct to copy.
+ * @param[out] dst Pointer to caller allocated player struct.
+ * @return true if success, false otherwise.
+ */
+bool player_copy(const struct player *src, struct player *dst);
+/**
+ * @brief Initializes players from specs, validated as player_initialize() does.
+ * 
+ * Like player_initialize(), every player gets its own copy of its spec's weapons vector, only allocated
+ * if it does not fit inline. Copies of the players share their long names, weapon indexes and spilled
+ * weapons vectors with the batch, so they must not outlive it.
+ * 
+ * @param[in] specs Specs of the players.
+ * @param[in] total Number of specs.
+ * @param[out] batch Pointer to caller allocated batch struct.
+ * @return true if every player was created, false otherwise.
+ */
+bool player_batch_initialize(const struct player_spec *specs, const size_t total, struct player_batch *batch);
 /**
  * @brief Gets the player's weapons.
  * 
@@ -65,13 +146,100 @@ void player_get_stats(const struct player *p);
  */
 void player_update_weapons(const char *type, const struct weapon *w, struct player *p);
 /**
- * @brief Attacks another player by decreasing its health.
+ * @brief Adds a weapon at the end of the player's weapons.
+ * 
+ * @param[in] w Pointer to weapon struct, copied.
+ * @param[in,out] p Pointer to player struct.
+ * @return true if success, false otherwise.
+ */
+bool player_add_weapon(const struct weapon *w, struct player *p);
+/**
+ * @brief Removes the first of the player's weapons equal to w byte for byte. The removed weapon is not deinitialized.
+ * 
+ * @param[in] w Pointer to weapon struct to remove.
+ * @param[in,out] p Pointer to player struct.
+ * @return true if removed, false if the player does not have it.
+ */
+bool player_remove_weapon(const struct weapon *w, struct player *p);
+/**
+ * @brief Enhances one of the player's weapons in place.
+ * 
+ * @param[in] weapon_name Name of the weapon to enhance. Must be owned by the player.
+ * @param[in] enhance_damage Damage to add to the weapon.
+ * @param[in] p Pointer to the player struct.
+ * @return true if the player owns the weapon, false otherwise.
+ */
+bool player_enhance_weapon(const char *weapon_name, const unsigned int enhance_damage, struct player *p);
+/**
+ * @brief Repairs one of the player's weapons in place.
+ * 
+ * @param[in] weapon_name Name of the weapon to repair. Must be owned by the player.
+ * @param[in] repair_health Health to add to the weapon.
+ * @param[in] p Pointer to the player struct.
+ * @return true if the player owns the weapon, false otherwise.
+ */
+bool player_repair_weapon(const char *weapon_name, const unsigned int repair_health, struct player *p);
+/**
+ * @brief Gets the usable weapon with the most damage.
+ * 
+ * @param[in] p Pointer to the player struct.
+ * @return Pointer to the weapon, valid until the player's weapons change. NULL if none is usable.
+ */
+const struct weapon *player_get_strongest_weapon(const struct player *p);
+/**
+ * @brief Gets the usable weapon with the most health.
+ * 
+ * @param[in] p Pointer to the player struct.
+ * @return Pointer to the weapon, valid until the player's weapons change. NULL if none is usable.
+ */
+const struct weapon *player_get_most_durable_weapon(const struct player *p);
+/**
+ * @brief Gets the usable weapon that hits an armor hardest, see inventory_index_best_against.
+ * 
+ * @param[in] armor_resistance Resistance of the armor to hit.
+ * @param[in] p Pointer to the player struct.
+ * @return Pointer to the weapon, valid until the player's weapons change. NULL if none gets through.
+ */
+const struct weapon *player_get_best_weapon_against(const unsigned int armor_resistance, const struct player *p);
+/**
+ * @brief Attacks another player by decreasing its health. The weapon wears by a tenth of the damage dealt, a broken weapon deals none.
  * 
  * @param[in] attacker Pointer to player struct which is going to attack.
  * @param[in] weapon_name Weapon name to attack to. Must be owned by the attacker.
  * @param[in] target Pointer to player struct to attack.
  */
 void player_attack(struct player *attacker, const char *weapon_name, struct player *target);
+/**
+ * @brief Attacks another player, drawing critical hits from the given random state instead of the global one.
+ * 
+ * Lets threads resolve attacks on disjoint players in parallel, each with its own state.
+ * 
+ * @param[in] attacker Pointer to player struct which is going to attack.
+ * @param[in] weapon_name Weapon name to attack to. Must be owned by the attacker.
+ * @param[in] target Pointer to player struct to attack.
+ * @param[in,out] rng Random state to draw from.
+ */
+void player_attack_r(struct player *attacker, const char *weapon_name, struct player *target, pcg32_random_t *rng);
+/**
+ * @brief Attacks another player like player_attack_r(), with the weapon at a position of the attacker's weapons.
+ * 
+ * Unlike a name, a position picks one weapon even if several share its name.
+ * 
+ * @param[in] attacker Pointer to player struct which is going to attack.
+ * @param[in] position Position of the weapon in the attacker's weapons.
+ * @param[in] target Pointer to player struct to attack.
+ * @param[in,out] rng Random state to draw from.
+ */
+void player_attack_at_r(struct player *attacker, const size_t position, struct player *target, pcg32_random_t *rng);
+/**
+ * @brief Rolls the damage of one hit with the damage model configured in damage.h.
+ * 
+ * @param[in] weapon_damage Base weapon damage.
+ * @param[in] armor_resistance Armor resistance, used for decreasing the total damage.
+ * @param[in,out] rng Random state to draw from.
+ * @return Damage dealt.
+ */
+unsigned int crit(const unsigned int weapon_damage, const unsigned int armor_resistance, pcg32_random_t *rng);
 /**
  * @brief Heals the player by increasing its health.
  * 
@@ -79,6 +247,38 @@ void player_attack(struct player *attacker, const char *weapon_name, struct play
  * @param[in] p Pointer to the player struct.
  */
 void player_heal(const unsigned int amount, struct player *p);
+/**
+ * @brief Damages the player by decreasing its health, never below 0. Armor is not applied.
+ * 
+ * @param[in] amount Amount of health to take away.
+ * @param[in] p Pointer to the player struct.
+ */
+void player_take_damage(const unsigned int amount, struct player *p);
+/**
+ * @brief Wears one of the player's weapons in place.
+ * 
+ * @param[in] weapon_name Name of the weapon to wear. Must be owned by the player.
+ * @param[in] amount Amount to decrease the weapon health by.
+ * @param[in] p Pointer to the player struct.
+ * @return true if the player owns the weapon, false otherwise.
+ */
+bool player_wear_weapon(const char *weapon_name, const unsigned int amount, struct player *p);
+/**
+ * @brief Wears the weapon at a position of the player's weapons in place, whatever its name.
+ * 
+ * @param[in] position Position of the weapon in the player's weapons.
+ * @param[in] amount Amount to decrease the weapon health by.
+ * @param[in] p Pointer to the player struct.
+ * @return true if the position is valid, false otherwise.
+ */
+bool player_wear_weapon_at(const size_t position, const unsigned int amount, struct player *p);
+/**
+ * @brief Wears the player's armor, if it wears one.
+ * 
+ * @param[in] amount Amount to decrease the armor health by.
+ * @param[in] p Pointer to the player struct.
+ */
+void player_wear_armor(const unsigned int amount, struct player *p);
 /**
  * @brief Makes the player equip the armor.
  * 
@@ -86,17 +286,34 @@ void player_heal(const unsigned int amount, struct player *p);
  * @param[in] p Pointer to player struct
  */
 void player_equip_armor(const struct armor *a, struct player *p);
+/**
+ * @brief Makes the player equip the armor and take it over, freeing the armor it owned before.
+ * 
+ * @param[in,out] a Pointer to armor struct, zeroed once taken over.
+ * @param[in] p Pointer to player struct
+ * @return true if the armor was taken over, false if the player already wears one.
+ */
+bool player_equip_armor_move(struct armor *a, struct player *p);
 /**
  * @brief Adds players by combining stats of both the players.
  * 
+ * The merged player owns copies of the weapons of both players and their combined armor, and frees them when
+ * deinitialized. add_player is left untouched on failure.
+ * 
  * @param[in] p1 Pointer to player struct to add to.
  * @param[in] p2 Pointer to player struct to add to.
  * @param[out] add_player Pointer to caller allocated player struct.
  */
 void player_add_player(const struct player *p1, const struct player *p2, struct player *add_player);
 /**
- * @brief Deinitializes player.
+ * @brief Deinitializes player, and the weapons and armor it owns.
  * 
  * @param[in] p Pointer to player struct
  */
-void player_deinitialize(struct player *p);
\ No newline at end of file
+void player_deinitialize(struct player *p);
+/**
+ * @brief Deinitializes the batch and every player in it.
+ * 
+ * @param[in] batch Pointer to batch struct.
+ */
+void player_batch_deinitialize(struct player_batch *batch);
\ No newline at end of file
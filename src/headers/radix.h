@@ -0,0 +1,125 @@
+/*! Radix tree declaration file */
+
+#pragma once
+
+#include "vector.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @struct radix_node
+ * @brief Node of a radix tree, reached through the edge labelled with its characters.
+ */
+struct radix_node {
+    /** Offset of the edge label in the label pool. */
+    uint32_t label_offset;
+    /** Length of the edge label, 0 only for the root. */
+    uint32_t label_length;
+    /** First child, 0 if none as the root is nobody's child. Children are ordered by their first character. */
+    uint32_t first_child;
+    /** Next child of the same parent, 0 if none. */
+    uint32_t next_sibling;
+    /** Value of the key ending here. */
+    size_t value;
+    /** Whether a key ends here. */
+    bool terminal;
+};
+
+/**
+ * @struct radix_tree
+ * @brief Maps strings to values, with prefix and typo-tolerant searches.
+ *
+ * Chains of single children are merged into one edge, and edge labels are slices of a single
+ * pool that splitting an edge does not copy. A lookup costs the key length plus the siblings tried
+ * at each branch, whatever the number of keys. Removing a key only unmarks it, the nodes stay.
+ */
+struct radix_tree {
+    /** Nodes, the root first. */
+    struct vector nodes;
+    /** Characters of every edge label. */
+    struct vector labels;
+    /** Number of keys. */
+    size_t size;
+    /** Length of the longest key ever inserted. */
+    size_t longest;
+};
+
+/**
+ * @brief Initializes the tree.
+ *
+ * @param[out] t Pointer to caller allocated tree struct.
+ * @return true if success, false otherwise.
+ */
+bool radix_tree_initialize(struct radix_tree *t);
+/**
+ * @brief Inserts a key. A key already there keeps its value.
+ *
+ * @param[in] key Key, cannot be empty.
+ * @param[in] value Value of the key.
+ * @param[in,out] t Pointer to tree struct.
+ * @return true if the key is in the tree, false otherwise.
+ */
+bool radix_tree_insert(const char *key, const size_t value, struct radix_tree *t);
+/**
+ * @brief Inserts the name of every weapon of a vector, with its position as value.
+ *
+ * Weapons sharing a name keep the first position, as name lookups on the vector would.
+ *
+ * @param[in] weapons Vector of struct weapon.
+ * @param[in,out] t Pointer to tree struct.
+ * @return true if success, false otherwise.
+ */
+bool radix_tree_insert_weapons(const struct vector *weapons, struct radix_tree *t);
+/**
+ * @brief Removes a key.
+ *
+ * @param[in] key Key to remove.
+ * @param[in,out] t Pointer to tree struct.
+ * @return true if the key was there, false otherwise.
+ */
+bool radix_tree_remove(const char *key, struct radix_tree *t);
+/**
+ * @brief Removes every key, keeping the memory for new ones.
+ *
+ * @param[in,out] t Pointer to tree struct.
+ */
+void radix_tree_clear(struct radix_tree *t);
+/**
+ * @brief Finds a key.
+ *
+ * @param[in] key Key to find.
+ * @param[in] t Pointer to tree struct.
+ * @param[out] value Value of the key, may be NULL.
+ * @return true if found, false otherwise.
+ */
+bool radix_tree_find(const char *key, const struct radix_tree *t, size_t *value);
+/**
+ * @brief Gets the values of keys starting with a prefix, in key order.
+ *
+ * @param[in] prefix Prefix, the empty prefix matches every key.
+ * @param[in] max Most values to get.
+ * @param[in] t Pointer to tree struct.
+ * @param[out] values Caller allocated array of max values.
+ * @return Number of values written.
+ */
+size_t radix_tree_complete(const char *prefix, const size_t max, const struct radix_tree *t, size_t *values);
+/**
+ * @brief Finds the key closest to a string in edit distance (insertions, deletions and substitutions).
+ *
+ * Branches that cannot get closer than the best key so far are not walked. Ties go to the first key in key order.
+ *
+ * @param[in] key String to match.
+ * @param[in] max_distance Largest distance accepted.
+ * @param[in] t Pointer to tree struct.
+ * @param[out] value Value of the closest key.
+ * @param[out] distance Distance to the closest key, may be NULL.
+ * @return true if a key within max_distance was found, false otherwise.
+ */
+bool radix_tree_find_closest(const char *key, const unsigned int max_distance, const struct radix_tree *t, size_t *value, unsigned int *distance);
+/**
+ * @brief Deinitializes the tree.
+ *
+ * @param[in] t Pointer to tree struct.
+ */
+void radix_tree_deinitialize(struct radix_tree *t);
@@ -0,0 +1,100 @@
+/*! Raid declaration file */
+
+#pragma once
+
+#include "player.h"
+#include "vector.h"
+#include "job_system.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+A raid tick resolves every attacker hitting one boss at once, with the outcome of calling
+player_attack_r() for each attacker in vector order:
+
+1. every attacker rolls its hit on its own, on a random stream picked by the raid seed, the tick
+   and its position, so the rolls do not depend on which thread makes them
+2. the hits are summed in per-chunk partial sums, combined in vector order
+3. if the sum reaches the boss health, the chunk where it does is walked to find the killing
+   blow, the attacker the serial calls would have credited
+4. attackers up to the killer, or all of them, wear their weapons like player_attack_r() would
+
+The boss is only written once, after the reduction. Attackers hit with their best weapon
+against the boss armor, and those with none getting through do not attack.
+*/
+
+/**
+ * @struct raid_hit
+ * @brief Hit rolled by one attacker in a tick.
+ */
+struct raid_hit {
+    /** Damage dealt. */
+    unsigned int damage;
+    /** Damage of a normal hit, less than damage for a critical one. */
+    unsigned int normal_damage;
+    /** Position of the weapon in the attacker's vector. */
+    size_t weapon;
+    /** Whether the attacker had a weapon getting through the armor. */
+    bool attacked;
+};
+
+/**
+ * @struct raid_result
+ * @brief Outcome of a tick.
+ */
+struct raid_result {
+    /** Damage dealt to the boss, not counting hits after the killing blow. */
+    uint64_t damage;
+    /** Attacks that hit the boss. */
+    size_t hits;
+    /** Whether the boss died this tick. */
+    bool killed;
+    /** Position of the attacker who dealt the killing blow, if killed. */
+    size_t killer;
+};
+
+/**
+ * @struct raid
+ * @brief State kept across the ticks of a raid.
+ */
+struct raid {
+    /** Hits of the current tick, one per attacker, reused across ticks. */
+    struct vector hits;
+    /** Job system running the ticks, NULL to run them on the calling thread. */
+    struct job_system *js;
+    /** Seed of the attackers' random streams. */
+    uint64_t seed;
+    /** Ticks resolved so far. */
+    uint64_t tick;
+};
+
+/**
+ * @brief Initializes the raid.
+ *
+ * @param[in] seed Seed of the attackers' random streams, the same seed replays the same raid.
+ * @param[in,out] js Pointer to job system struct, may be NULL.
+ * @param[out] r Pointer to caller allocated raid struct.
+ * @return true if success, false otherwise.
+ */
+bool raid_initialize(const uint64_t seed, struct job_system *js, struct raid *r);
+/**
+ * @brief Resolves one tick of every attacker hitting the boss.
+ *
+ * Must not be called from a job. A player may appear only once among the attackers, and never as the boss.
+ * No two attackers may share weapon storage, which by-value copies of one player with spilled weapons do,
+ * see vector.h: their weapons would wear from several threads, and once per sharer.
+ *
+ * @param[in,out] attackers Vector of struct player, their weapons wear.
+ * @param[in,out] boss Pointer to the player struct attacked.
+ * @param[in,out] r Pointer to raid struct.
+ * @param[out] result Pointer to caller allocated result struct.
+ * @return true if success, false on invalid arguments or allocation failure, leaving everybody untouched.
+ */
+bool raid_tick(struct vector *attackers, struct player *boss, struct raid *r, struct raid_result *result);
+/**
+ * @brief Deinitializes the raid. The job system is not touched.
+ *
+ * @param[in] r Pointer to raid struct.
+ */
+void raid_deinitialize(struct raid *r);
@@ -0,0 +1,114 @@
+/*! Report writer declaration file */
+
+#pragma once
+
+#include "weapon.h"
+#include "armor.h"
+#include "player.h"
+#include "game.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/** Default size of the report buffer, every flush writes at most this much at once. */
+#define REPORT_DEFAULT_CAPACITY (64 * 1024)
+
+/**
+ * @enum report_format
+ * @brief Output format of a report.
+ */
+enum report_format {
+    /** Readable text, same layout as the old per field prints. */
+    REPORT_FORMAT_HUMAN,
+    /** One row per entity: kind,owner,name,health,max_health,damage,resistance. */
+    REPORT_FORMAT_CSV,
+    /** A single JSON array of entity objects. */
+    REPORT_FORMAT_JSON
+};
+
+/**
+ * @struct report
+ * @brief Formats entity stats into a reusable buffer and writes it out in large blocks.
+ */
+struct report {
+    /** Pending output. */
+    char *buffer;
+    /** Bytes pending in the buffer. */
+    size_t size;
+    /** Allocated size of the buffer. */
+    size_t capacity;
+    /** Stream to flush to, owned by the caller. */
+    FILE *out;
+    /** Output format. */
+    enum report_format format;
+    /** Top level records written since report_begin(), used for separators. */
+    size_t records;
+    /** Set once an allocation or write failed, later output is dropped. */
+    bool failed;
+};
+
+/**
+ * @brief Initializes report.
+ *
+ * @param[in] format Output format.
+ * @param[in] capacity Buffer size in bytes, grows only if a single value does not fit.
+ * @param[in] out Stream to flush to.
+ * @param[out] r Pointer to caller allocated report struct.
+ * @return true if success, false otherwise.
+ */
+bool report_initialize(const enum report_format format, const size_t capacity, FILE *out, struct report *r);
+/**
+ * @brief Starts a document: the CSV header or the opening of the JSON array.
+ *
+ * @param[in,out] r Pointer to report struct.
+ */
+void report_begin(struct report *r);
+/**
+ * @brief Writes a weapon record.
+ *
+ * @param[in,out] r Pointer to report struct.
+ * @param[in] owner Name of the owning player, may be NULL.
+ * @param[in] w Pointer to weapon struct.
+ */
+void report_write_weapon(struct report *r, const char *owner, const struct weapon *w);
+/**
+ * @brief Writes an armor record.
+ *
+ * @param[in,out] r Pointer to report struct.
+ * @param[in] owner Name of the owning player, may be NULL.
+ * @param[in] a Pointer to armor struct.
+ */
+void report_write_armor(struct report *r, const char *owner, const struct armor *a);
+/**
+ * @brief Writes a player record along with its armor and weapons.
+ *
+ * @param[in,out] r Pointer to report struct.
+ * @param[in] p Pointer to player struct.
+ */
+void report_write_player(struct report *r, const struct player *p);
+/**
+ * @brief Writes every player of the game.
+ *
+ * @param[in,out] r Pointer to report struct.
+ * @param[in] g Pointer to game struct.
+ */
+void report_write_game(struct report *r, const struct game *g);
+/**
+ * @brief Ends a document started by report_begin().
+ *
+ * @param[in,out] r Pointer to report struct.
+ */
+void report_end(struct report *r);
+/**
+ * @brief Writes all pending output to the stream.
+ *
+ * @param[in,out] r Pointer to report struct.
+ * @return true if everything so far was written, false otherwise.
+ */
+bool report_flush(struct report *r);
+/**
+ * @brief Flushes and deinitializes report. The stream is not closed.
+ *
+ * @param[in] r Pointer to report struct.
+ */
+void report_deinitialize(struct report *r);
@@ -0,0 +1,107 @@
+/*! Server declaration file */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+/*
+Wire protocol, every integer is a little endian u32 and every string is a u8 length followed by its bytes.
+
+request:  [u8 opcode][u8 payload length][payload]
+response: [u8 status][u8 payload length][payload]
+
+Each connection is a session with its own game. Players are addressed by the order they joined.
+*/
+
+/** Most events handled per epoll_wait() call. */
+#define SERVER_MAX_EVENTS 256
+/** Largest request or response payload, bounded by the u8 length field. */
+#define SERVER_MAX_PAYLOAD 255
+
+/**
+ * @enum server_opcode
+ * @brief Request types understood by the server.
+ */
+enum server_opcode {
+    /** name, health, armor resistance -> player index */
+    SERVER_OP_JOIN = 1,
+    /** player, weapon name, weapon health, weapon damage -> nothing */
+    SERVER_OP_ADD_WEAPON = 2,
+    /** attacker, target, weapon name -> target health */
+    SERVER_OP_ATTACK = 3,
+    /** player, amount -> health */
+    SERVER_OP_HEAL = 4,
+    /** player -> health, armor resistance, weapon count */
+    SERVER_OP_STATS = 5,
+    /** nothing -> players alive, name of the winner if only one is left */
+    SERVER_OP_WINNER = 6
+};
+
+/**
+ * @enum server_status
+ * @brief Response status codes.
+ */
+enum server_status {
+    /** Request applied. */
+    SERVER_STATUS_OK = 0,
+    /** Unknown opcode or malformed payload. */
+    SERVER_STATUS_BAD_REQUEST = 1,
+    /** Referenced player does not exist. */
+    SERVER_STATUS_NOT_FOUND = 2,
+    /** Request was well formed but could not be applied. */
+    SERVER_STATUS_FAILED = 3
+};
+
+/** Forward declaration, sessions are private to the server. */
+struct session;
+
+/**
+ * @struct server
+ * @brief Hosts many game sessions on one thread, one per Unix domain socket connection.
+ */
+struct server {
+    /** Listening socket. */
+    int listen_fd;
+    /** epoll instance watching the listening socket and every session. */
+    int epoll_fd;
+    /** Path the socket is bound to, owned by the caller. */
+    const char *socket_path;
+    /** Connected sessions, as an intrusive list. */
+    struct session *sessions;
+    /** Number of connected sessions. */
+    size_t total_sessions;
+    /** Cleared by server_stop() to end server_run(). */
+    atomic_bool running;
+};
+
+/**
+ * @brief Initializes server by binding and listening on a Unix domain socket.
+ *
+ * A stale socket file at the path is removed first.
+ *
+ * @param[in] socket_path Path to bind to, must outlive the server.
+ * @param[out] s Pointer to caller allocated server struct.
+ * @return true if success, false otherwise.
+ */
+bool server_initialize(const char *socket_path, struct server *s);
+/**
+ * @brief Serves sessions until server_stop() is called.
+ *
+ * @param[in] s Pointer to server struct.
+ * @return true if stopped cleanly, false on error.
+ */
+bool server_run(struct server *s);
+/**
+ * @brief Asks server_run() to return. Safe to call from a signal handler.
+ *
+ * @param[in] s Pointer to server struct.
+ */
+void server_stop(struct server *s);
+/**
+ * @brief Closes every session and removes the socket file.
+ *
+ * @param[in] s Pointer to server struct.
+ */
+void server_deinitialize(struct server *s);
@@ -0,0 +1,210 @@
+/*! Spectator stream declaration file */
+
+#pragma once
+
+#include "game.h"
+#include "name.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+Stream format, every integer is an unsigned LEB128 varint and every string a varint length followed by its bytes.
+
+frame:   [length of the rest][u8 kind][tick][players in game][records, delta frames only][player records]
+kind:    SPECTATE_FRAME_KEYFRAME carries every player with every field,
+         SPECTATE_FRAME_DELTA carries only the players that changed since the previous tick.
+player:  [index, delta frames only][u8 player mask][fields of the set bits, in bit order]
+weapons: [weapons owned][changed weapons] then [index][u8 weapon mask][fields of the set bits] for each changed weapon
+
+Players and weapons are addressed by position, anything past the new count is dropped.
+*/
+
+/** Environment variable naming the file main() streams the game to. */
+#define SPECTATE_PATH_VARIABLE "GAME_SPECTATE"
+/** Default ticks between keyframes. */
+#define SPECTATE_DEFAULT_KEYFRAME_INTERVAL 64
+
+/**
+ * @enum spectate_frame_kind
+ * @brief Kind of a frame.
+ */
+enum spectate_frame_kind {
+    /** Full state, a viewer can start here. */
+    SPECTATE_FRAME_KEYFRAME = 0,
+    /** Changes since the previous frame. */
+    SPECTATE_FRAME_DELTA = 1
+};
+
+/**
+ * @enum spectate_player_field
+ * @brief Bits of a player mask.
+ */
+enum spectate_player_field {
+    SPECTATE_PLAYER_NAME = 1 << 0,
+    SPECTATE_PLAYER_HEALTH = 1 << 1,
+    SPECTATE_PLAYER_WEARING_ARMOR = 1 << 2,
+    SPECTATE_PLAYER_ARMOR_NAME = 1 << 3,
+    SPECTATE_PLAYER_ARMOR_HEALTH = 1 << 4,
+    SPECTATE_PLAYER_ARMOR_MAX_HEALTH = 1 << 5,
+    SPECTATE_PLAYER_ARMOR_RESISTANCE = 1 << 6,
+    SPECTATE_PLAYER_WEAPONS = 1 << 7
+};
+
+/**
+ * @enum spectate_weapon_field
+ * @brief Bits of a weapon mask.
+ */
+enum spectate_weapon_field {
+    SPECTATE_WEAPON_NAME = 1 << 0,
+    SPECTATE_WEAPON_HEALTH = 1 << 1,
+    SPECTATE_WEAPON_DAMAGE = 1 << 2
+};
+
+/**
+ * @struct spectate_weapon
+ * @brief What a spectator sees of a weapon.
+ */
+struct spectate_weapon {
+    /** Weapon name, owned. */
+    struct name name;
+    /** Weapon health. */
+    unsigned int health;
+    /** Weapon damage. */
+    unsigned int damage;
+};
+
+/**
+ * @struct spectate_player
+ * @brief What a spectator sees of a player.
+ */
+struct spectate_player {
+    /** Player name, owned. */
+    struct name name;
+    /** Player health. */
+    unsigned int health;
+    /** Whether the player wears its armor. */
+    bool wearing_armor;
+    /** Armor name, owned. */
+    struct name armor_name;
+    /** Armor health. */
+    unsigned int armor_health;
+    /** Armor max health. */
+    unsigned int armor_max_health;
+    /** Armor resistance. */
+    unsigned int armor_resistance;
+    /** Weapons, in the player's order. */
+    struct spectate_weapon *weapons;
+    /** Number of weapons. */
+    size_t total_weapons;
+    /** Number of weapons there is room for. */
+    size_t weapons_capacity;
+};
+
+/**
+ * @struct spectate_state
+ * @brief Players as last streamed, by the writer to diff against and by a viewer to apply frames to.
+ */
+struct spectate_state {
+    /** Players, in game order. */
+    struct spectate_player *players;
+    /** Number of players. */
+    size_t total_players;
+    /** Number of players there is room for. */
+    size_t capacity;
+};
+
+/**
+ * @struct spectate_stream
+ * @brief Writes a game tick by tick, as keyframes every so often and deltas in between.
+ */
+struct spectate_stream {
+    /** State as of the last frame. */
+    struct spectate_state last;
+    /** Frame being encoded. */
+    unsigned char *buffer;
+    /** Bytes in the buffer. */
+    size_t size;
+    /** Allocated size of the buffer. */
+    size_t capacity;
+    /** Stream to write to, a file or a socket, owned by the caller. */
+    FILE *out;
+    /** Ticks written. */
+    uint64_t tick;
+    /** Ticks between keyframes. */
+    unsigned int keyframe_interval;
+    /** Set once an allocation or write failed, later ticks are dropped. */
+    bool failed;
+};
+
+/**
+ * @struct spectate_view
+ * @brief Reads a stream, possibly joined mid-stream, back into players.
+ */
+struct spectate_view {
+    /** State as of the last frame applied. */
+    struct spectate_state state;
+    /** Frame being decoded. */
+    unsigned char *buffer;
+    /** Allocated size of the buffer. */
+    size_t capacity;
+    /** Tick of the last frame applied. */
+    uint64_t tick;
+    /** Set once a keyframe was applied, deltas before it are skipped. */
+    bool synced;
+};
+
+/**
+ * @brief Initializes the stream.
+ *
+ * @param[in] keyframe_interval Ticks between keyframes, cannot be 0.
+ * @param[in] out Stream to write to.
+ * @param[out] ss Pointer to caller allocated stream struct.
+ * @return true if success, false otherwise.
+ */
+bool spectate_stream_initialize(const unsigned int keyframe_interval, FILE *out, struct spectate_stream *ss);
+/**
+ * @brief Writes one tick of the game, a keyframe on the first tick and every keyframe_interval ticks.
+ *
+ * @param[in] g Pointer to game struct.
+ * @param[in,out] ss Pointer to stream struct.
+ * @return true if the frame was written, false otherwise.
+ */
+bool spectate_stream_write_tick(const struct game *g, struct spectate_stream *ss);
+/**
+ * @brief Deinitializes the stream. The output stream is flushed, not closed.
+ *
+ * @param[in] ss Pointer to stream struct.
+ */
+void spectate_stream_deinitialize(struct spectate_stream *ss);
+/**
+ * @brief Initializes the view.
+ *
+ * @param[out] v Pointer to caller allocated view struct.
+ * @return true if success, false otherwise.
+ */
+bool spectate_view_initialize(struct spectate_view *v);
+/**
+ * @brief Reads and applies the next frame.
+ *
+ * Deltas read before the first keyframe are skipped, v->synced tells when the state is usable.
+ *
+ * @param[in] in Stream to read from.
+ * @param[in,out] v Pointer to view struct.
+ * @return true if a frame was read, false at the end of the stream or on a malformed frame.
+ */
+bool spectate_view_read(FILE *in, struct spectate_view *v);
+/**
+ * @brief Skips the next frame without applying it, to join a stream mid-way.
+ *
+ * @param[in] in Stream to read from.
+ * @return true if a frame was skipped, false at the end of the stream or on a malformed frame.
+ */
+bool spectate_view_skip(FILE *in);
+/**
+ * @brief Deinitializes the view.
+ *
+ * @param[in] v Pointer to view struct.
+ */
+void spectate_view_deinitialize(struct spectate_view *v);
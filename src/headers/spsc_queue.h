@@ -0,0 +1,69 @@
+/*! Single producer single consumer queue declaration file */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+
+/** Assumed cache line size, keeps producer and consumer indices from false sharing. */
+#define SPSC_CACHE_LINE 64
+
+/**
+ * @brief A lock-free bounded ring buffer for exactly one producer and one consumer thread.
+ *
+ * Elements are copied in and out by value, like struct vector. Indices grow
+ * monotonically and are masked into the buffer, so the capacity is always a power of two.
+ */
+struct spsc_queue {
+    /** Pointer to the ring buffer. */
+    void *items;
+    /** Size of each element in bytes. */
+    size_t e_size;
+    /** Capacity in elements, power of two. */
+    size_t capacity;
+
+    // Each side's line holds what it writes: its own index and its cached copy of the other's
+    /** Next slot to read, written by the consumer only. */
+    alignas(SPSC_CACHE_LINE) atomic_size_t head;
+    /** Consumer's last seen value of tail. */
+    size_t cached_tail;
+
+    /** Next slot to write, written by the producer only. */
+    alignas(SPSC_CACHE_LINE) atomic_size_t tail;
+    /** Producer's last seen value of head. */
+    size_t cached_head;
+};
+
+/**
+ * @brief Initializes the queue.
+ *
+ * @param[in] capacity Minimum capacity in elements, rounded up to a power of two.
+ * @param[in] e_size Size in bytes of each element.
+ * @param[out] q Pointer to caller allocated queue struct.
+ * @return true if success, false otherwise.
+ */
+bool spsc_queue_initialize(const size_t capacity, const size_t e_size, struct spsc_queue *q);
+/**
+ * @brief Copies an element into the queue. Must only be called by the producer.
+ *
+ * @param[in,out] q Pointer to queue struct.
+ * @param[in] element Pointer to the element to push.
+ * @return true if pushed, false if the queue is full.
+ */
+bool spsc_queue_push(struct spsc_queue *q, const void *element);
+/**
+ * @brief Copies the oldest element out of the queue. Must only be called by the consumer.
+ *
+ * @param[in,out] q Pointer to queue struct.
+ * @param[out] element Buffer to store the element (`e_size` bytes).
+ * @return true if an element was popped, false if the queue is empty.
+ */
+bool spsc_queue_pop(struct spsc_queue *q, void *element);
+/**
+ * @brief Deinitializes the queue. No thread may be using it.
+ *
+ * @param[in] q Pointer to queue struct.
+ */
+void spsc_queue_deinitialize(struct spsc_queue *q);
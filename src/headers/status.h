@@ -0,0 +1,136 @@
+/*! Status effects declaration file */
+
+#pragma once
+
+#include "vector.h"
+#include "game.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Bits of a tick resolved by one wheel level. */
+#define STATUS_WHEEL_BITS 6
+/** Slots per wheel level. */
+#define STATUS_WHEEL_SLOTS (1u << STATUS_WHEEL_BITS)
+/** Number of wheel levels. */
+#define STATUS_WHEEL_LEVELS 4
+/** Longest period an effect can have, in ticks. */
+#define STATUS_MAX_PERIOD ((1ull << (STATUS_WHEEL_BITS * STATUS_WHEEL_LEVELS)) - 1)
+/** Longest weapon name a wear effect can target. */
+#define STATUS_WEAPON_NAME_SIZE 64
+
+/**
+ * @enum status_effect_kind
+ * @brief What an effect does each time it fires.
+ */
+enum status_effect_kind {
+    /** Takes magnitude health from the player, armor is not applied. */
+    STATUS_EFFECT_POISON,
+    /** Heals the player by magnitude. */
+    STATUS_EFFECT_REGENERATION,
+    /** Takes magnitude health from the player's armor. */
+    STATUS_EFFECT_ARMOR_DECAY,
+    /** Takes magnitude health from one of the player's weapons. */
+    STATUS_EFFECT_WEAPON_WEAR
+};
+
+/**
+ * @struct status_effect
+ * @brief An effect that fires every period ticks, a fixed number of times.
+ */
+struct status_effect {
+    /** What the effect does. */
+    enum status_effect_kind kind;
+    /** Index of the affected player in the game. */
+    size_t player_index;
+    /** Weapon worn by STATUS_EFFECT_WEAPON_WEAR, ignored otherwise. */
+    char weapon_name[STATUS_WEAPON_NAME_SIZE];
+    /** Amount applied each time the effect fires. */
+    unsigned int magnitude;
+    /** Ticks between two firings, from 1 to STATUS_MAX_PERIOD. */
+    unsigned int period;
+    /** Times the effect fires before it expires, cannot be 0. */
+    unsigned int remaining;
+};
+
+/**
+ * @struct status_wheel
+ * @brief Hierarchical timing wheel of status effects.
+ *
+ * Level l holds effects due within STATUS_WHEEL_SLOTS^(l + 1) ticks, in slots of
+ * STATUS_WHEEL_SLOTS^l ticks. A tick fires the level 0 slot it reaches and, when a lower
+ * level wraps, spreads the next slot of the level above over the levels below. A tick costs
+ * the effects it fires plus at most STATUS_WHEEL_LEVELS moves per effect over its lifetime,
+ * however many effects are waiting.
+ */
+struct status_wheel {
+    /** Pool of struct status_timer, indexed by effect ids. */
+    struct vector timers;
+    /** Head of the list of released timers. */
+    uint32_t free_head;
+    /** Head of every slot's list of timers. */
+    uint32_t slots[STATUS_WHEEL_LEVELS][STATUS_WHEEL_SLOTS];
+    /** Ticks advanced so far. */
+    uint64_t now;
+    /** Effects waiting to fire. */
+    size_t total_active;
+};
+
+/**
+ * @brief Initializes an empty wheel at tick 0.
+ *
+ * @param[in] initial_capacity Number of effects to make room for.
+ * @param[out] sw Pointer to caller allocated wheel struct.
+ * @return true if success, false otherwise.
+ */
+bool status_wheel_initialize(const size_t initial_capacity, struct status_wheel *sw);
+/**
+ * @brief Adds an effect, first firing period ticks from now.
+ *
+ * @param[in] effect Pointer to effect struct, copied.
+ * @param[out] id Id to cancel the effect with, may be NULL.
+ * @param[in,out] sw Pointer to wheel struct.
+ * @return true if added, false if the effect is invalid or on allocation failure.
+ */
+bool status_wheel_add(const struct status_effect *effect, uint64_t *id, struct status_wheel *sw);
+/**
+ * @brief Cancels an effect before it expires.
+ *
+ * @param[in] id Id given by status_wheel_add.
+ * @param[in,out] sw Pointer to wheel struct.
+ * @return true if the effect was still active, false otherwise.
+ */
+bool status_wheel_cancel(const uint64_t id, struct status_wheel *sw);
+/**
+ * @brief Cancels the effects of a player removed from the game and renumbers those after it.
+ *
+ * Call alongside game_remove_player_at. Walks the whole pool, removals are expected to be rare.
+ *
+ * @param[in] player_index Index the player had in the game.
+ * @param[in,out] sw Pointer to wheel struct.
+ */
+void status_wheel_remove_player(const size_t player_index, struct status_wheel *sw);
+/**
+ * @brief Advances time, applying every effect that fires on the way to the game.
+ *
+ * Effects whose player is dead or out of range are dropped when they fire.
+ *
+ * @param[in] ticks Number of ticks to advance.
+ * @param[in,out] g Pointer to the game the effects apply to.
+ * @param[in,out] sw Pointer to wheel struct.
+ * @return Number of effects fired.
+ */
+size_t status_wheel_advance(const uint64_t ticks, struct game *g, struct status_wheel *sw);
+/**
+ * @brief Gets the number of effects waiting to fire.
+ *
+ * @param[in] sw Pointer to wheel struct.
+ * @return Number of active effects.
+ */
+size_t status_wheel_get_total_active(const struct status_wheel *sw);
+/**
+ * @brief Deinitializes the wheel, dropping every active effect.
+ *
+ * @param[in] sw Pointer to wheel struct.
+ */
+void status_wheel_deinitialize(struct status_wheel *sw);
@@ -0,0 +1,159 @@
+/*! Tokenizer declaration file */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * @struct string_view
+ * @brief Non owning view over a span of characters, not necessarily NUL-terminated.
+ */
+struct string_view {
+    /** Pointer to the first character of the span. */
+    const char *data;
+    /** Number of characters in the span. */
+    size_t length;
+};
+
+/**
+ * @struct tokenizer
+ * @brief Walks a caller owned buffer and hands out lines and tokens as views into it.
+ */
+struct tokenizer {
+    /** Next character to be examined. */
+    const char *cursor;
+    /** One past the last character of the buffer. */
+    const char *end;
+};
+
+/**
+ * @struct line_reader
+ * @brief Reads a file in large blocks and hands out its lines as views into the block.
+ */
+struct line_reader {
+    /** File to read from, owned by the caller. */
+    FILE *file;
+    /** Block buffer holding the current and partially read lines. */
+    char *buffer;
+    /** Allocated size of the buffer in bytes. */
+    size_t capacity;
+    /** Offset of the first unread byte. */
+    size_t start;
+    /** Offset one past the last valid byte. */
+    size_t end;
+    /** Set once the file has no more data. */
+    bool eof;
+    /** Set once the buffer could not grow or the file could not be read, the reader hands out nothing more. */
+    bool failed;
+};
+
+/**
+ * @brief Creates a view over a NUL-terminated string.
+ *
+ * @param[in] str NUL-terminated string, may be NULL.
+ * @return View over the string, empty if str is NULL.
+ */
+struct string_view string_view_from_cstr(const char *str);
+/**
+ * @brief Checks if the view holds exactly the given string.
+ *
+ * @param[in] sv View to compare.
+ * @param[in] str NUL-terminated string to compare by.
+ * @return true if both hold the same characters, false otherwise.
+ */
+bool string_view_equals(const struct string_view sv, const char *str);
+/**
+ * @brief Strips leading and trailing whitespace from the view.
+ *
+ * @param[in] sv View to trim.
+ * @return Trimmed view into the same buffer.
+ */
+struct string_view string_view_trim(const struct string_view sv);
+/**
+ * @brief Copies the view into a caller allocated buffer and NUL-terminates it.
+ *
+ * @param[in] sv View to copy.
+ * @param[in] size Size of the destination buffer.
+ * @param[out] dest Caller allocated buffer.
+ * @return true if the whole view fit, false otherwise.
+ */
+bool string_view_copy(const struct string_view sv, const size_t size, char *dest);
+/**
+ * @brief Parses a base 10 unsigned integer spanning the whole view.
+ *
+ * Only digits are accepted, no sign or surrounding whitespace.
+ *
+ * @param[in] sv View to parse.
+ * @param[out] out_val Pointer to unsigned int to store the value.
+ * @return true if successful, false on empty input, stray characters or overflow.
+ */
+bool string_view_parse_uint(const struct string_view sv, unsigned int *out_val);
+/**
+ * @brief Initializes tokenizer over a caller owned buffer.
+ *
+ * The buffer must outlive every view handed out by the tokenizer.
+ *
+ * @param[in] buffer Buffer to tokenize, does not need to be NUL-terminated.
+ * @param[in] length Length of the buffer in bytes.
+ * @param[out] t Pointer to caller allocated tokenizer struct.
+ * @return true if success, false otherwise.
+ */
+bool tokenizer_initialize(const char *buffer, const size_t length, struct tokenizer *t);
+/**
+ * @brief Gets the next line, without its line terminator ("\n" or "\r\n").
+ *
+ * @param[in,out] t Pointer to tokenizer struct.
+ * @param[out] line View to hold the line.
+ * @return true if a line was read, false at the end of the buffer.
+ */
+bool tokenizer_next_line(struct tokenizer *t, struct string_view *line);
+/**
+ * @brief Gets the next whitespace separated token.
+ *
+ * @param[in,out] t Pointer to tokenizer struct.
+ * @param[out] token View to hold the token.
+ * @return true if a token was read, false at the end of the buffer.
+ */
+bool tokenizer_next_token(struct tokenizer *t, struct string_view *token);
+/**
+ * @brief Gets everything not yet consumed, trimmed of surrounding whitespace.
+ *
+ * @param[in] t Pointer to tokenizer struct.
+ * @return View over the rest of the buffer.
+ */
+struct string_view tokenizer_remaining(const struct tokenizer *t);
+/**
+ * @brief Initializes line reader.
+ *
+ * @param[in] file File to read from, owned by the caller.
+ * @param[in] block_size Size of each read, grows if a single line does not fit.
+ * @param[out] lr Pointer to caller allocated line reader struct.
+ * @return true if success, false otherwise.
+ */
+bool line_reader_initialize(FILE *file, const size_t block_size, struct line_reader *lr);
+/**
+ * @brief Gets the next line of the file, without its line terminator.
+ *
+ * The view is valid until the next call.
+ *
+ * @param[in,out] lr Pointer to line reader struct.
+ * @param[out] line View to hold the line.
+ * @return true if a line was read, false at the end of the file or on error, see line_reader_has_failed().
+ *         A line cut short by an error is never handed out.
+ */
+bool line_reader_next_line(struct line_reader *lr, struct string_view *line);
+/**
+ * @brief Tells an error apart from the end of the file, once line_reader_next_line() returned false.
+ *
+ * @param[in] lr Pointer to line reader struct.
+ * @return true if the buffer could not grow or the file could not be read, false otherwise.
+ */
+bool line_reader_has_failed(const struct line_reader *lr);
+/**
+ * @brief Deinitializes line reader. The file is not closed.
+ *
+ * @param[in] lr Pointer to line reader struct.
+ */
+void line_reader_deinitialize(struct line_reader *lr);
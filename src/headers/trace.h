@@ -0,0 +1,65 @@
+/*! Trace recorder declaration file */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Events each thread keeps, a power of two. Older events are overwritten once a thread records more. */
+#define TRACE_BUFFER_EVENTS 65536
+/** Environment variable naming the file main() writes the trace to. */
+#define TRACE_PATH_VARIABLE "GAME_TRACE"
+
+/*
+The TRACE_* macros compile to nothing unless GAME_TRACE is defined (the matching CMake option),
+so builds without it pay nothing. With it, they record only once trace_initialize() succeeded.
+Names must be string literals or otherwise outlive the tracer, only their pointer is recorded.
+*/
+
+#ifdef GAME_TRACE
+#define TRACE_BEGIN(name) trace_begin(name)
+#define TRACE_END(name) trace_end(name)
+#define TRACE_INSTANT(name) trace_instant(name)
+#else
+#define TRACE_BEGIN(name) ((void)0)
+#define TRACE_END(name) ((void)0)
+#define TRACE_INSTANT(name) ((void)0)
+#endif
+
+/**
+ * @brief Starts recording, and registers writing the trace to a file at exit.
+ *
+ * The file is in the Chrome trace event format, for chrome://tracing or Perfetto.
+ *
+ * @param[in] path Path of the file to write, nothing is recorded if NULL or empty.
+ * @return true if recording, false otherwise.
+ */
+bool trace_initialize(const char *path);
+/**
+ * @brief Records the beginning of a span on the calling thread.
+ *
+ * @param[in] name Name of the span.
+ */
+void trace_begin(const char *name);
+/**
+ * @brief Records the end of the last span begun on the calling thread.
+ *
+ * @param[in] name Name of the span.
+ */
+void trace_end(const char *name);
+/**
+ * @brief Records an instant event on the calling thread.
+ *
+ * @param[in] name Name of the event.
+ */
+void trace_instant(const char *name);
+/**
+ * @brief Stops recording, writes every thread's events and frees them.
+ *
+ * Runs at exit once trace_initialize() succeeded, and does nothing if called again.
+ * Other threads must not record while it runs.
+ *
+ * @return true if the trace was written, false otherwise.
+ */
+bool trace_deinitialize(void);
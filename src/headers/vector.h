@@ -3,8 +3,12 @@
 #pragma once
 
 #include <stdlib.h>
+#include <stddef.h>
 #include <stdbool.h>
 
+/** Bytes of elements a vector keeps inline before spilling to the heap, a typical loadout of weapons. */
+#define VECTOR_INLINE_SIZE 160
+
 /**
  * @typedef cmp_func
  * @brief Comparision function used by vector_search_element().
@@ -16,29 +20,58 @@
  */
 typedef bool (*cmp_func)(const void *element, const void *key);
 
+/**
+ * @typedef order_func
+ * @brief Ordering function used by the sorted vector functions, as for qsort().
+ * 
+ * @param[in] a Element to order.
+ * @param[in] b Element, or key shaped like one, to order by.
+ * 
+ * @return Negative if a goes before b, 0 if they are equivalent, positive if a goes after b.
+ */
+typedef int (*order_func)(const void *a, const void *b);
+
 /**
  * @brief A generic dynamically resizable array (vector).
  *
  * The vector stores raw memory blocks of uniform size, allowing generic storage
  * of elements. Supports automatic resizing and basic operations like insertion,
  * retrieval, search, and deletion.
+ *
+ * Elements fitting in `VECTOR_INLINE_SIZE` bytes live inside the struct and only
+ * move to the heap once the vector outgrows them. Reach the elements through
+ * `vector_items()`.
+ *
+ * Nothing points into the struct, so it can be moved by value, but a by-value copy
+ * shares the elements only once they spilled to the heap. Keep one owner per vector
+ * and give anything else that keeps it a `vector_copy()`, which stays inline and
+ * allocation-free whenever the elements fit, as the player and game constructors do.
+ *
+ * Failing functions return false and tell why through error_last(), see error.h.
  */
 struct vector {
-    /** Pointer to the contiguous memory block for elements. */
-    void *items;
+    /** Heap block of the elements, NULL while they are inline. */
+    void *_heap;
     /** Size of each element in bytes. */
     size_t e_size;
     /** Current number of elements in the vector. */
     size_t size;
     /** Allocated capacity in elements. */
     size_t capacity;
+    /** Inline block of the elements, aligned for any element type. */
+    union {
+        max_align_t _align;
+        unsigned char bytes[VECTOR_INLINE_SIZE];
+    } _inline;
 };
 
 /**
  * @brief Initializes a vector with a specified capacity and element size.
  *
  * The user is responsible for allocating the `struct vector` and calling
- * `free_vector()` afterward to release the internal memory.
+ * `free_vector()` afterward to release the internal memory. No memory is
+ * allocated if `capacity` elements fit inline, and the capacity is then
+ * everything that fits inline.
  *
  * @param[in]  capacity  Initial capacity (number of elements).
  * @param[in]  e_size    Size in bytes of each element.
@@ -48,6 +81,18 @@ struct vector {
  */
 bool vector_initialize(const size_t capacity, const size_t e_size, struct vector *vec);
 
+/**
+ * @brief Gets the elements of the vector, inline or on the heap.
+ *
+ * The pointer is invalidated by any insertion and, for inline elements, by
+ * moving or copying the vector.
+ *
+ * @param[in] vec  Pointer to the initialized vector.
+ *
+ * @return Pointer to the first element, `NULL` if `vec` is NULL.
+ */
+void *vector_items(const struct vector *vec);
+
 /**
  * @brief Searches for an element in the vector using a comparison function.
  *
@@ -88,6 +133,16 @@ bool vector_get_element(const struct vector *vec, const size_t index, void *elem
  */
 bool vector_push_back(struct vector *vec, const void *element);
 
+/**
+ * @brief Makes room for at least `capacity` elements, so pushing up to it cannot fail.
+ *
+ * @param[in,out] vec       Pointer to the initialized vector.
+ * @param[in]     capacity  Number of elements to make room for.
+ *
+ * @return `true` on success, `false` on allocation failure or invalid input.
+ */
+bool vector_reserve(struct vector *vec, const size_t capacity);
+
 /**
  * @brief Removes the first matching element from the vector.
  *
@@ -115,6 +170,107 @@ bool vector_pop_search(struct vector *vec, const void *element);
  */
 bool vector_pop_index(struct vector *vec, const size_t index, void *element);
 
+/**
+ * @brief Sorts the vector, which can then be used with the sorted vector functions.
+ *
+ * The sorted vector functions expect the vector to be sorted by the same `order`.
+ * `vector_push_back()` does not keep it sorted, `vector_insert_sorted()` does.
+ *
+ * @param[in,out] vec    Pointer to the initialized vector.
+ * @param[in]     order  Ordering function.
+ *
+ * @return `true` on success, `false` on invalid input.
+ */
+bool vector_sort(struct vector *vec, order_func order);
+
+/**
+ * @brief Finds the first element of a sorted vector that does not go before `key`.
+ *
+ * @param[in] vec    Pointer to the sorted vector.
+ * @param[in] key    Pointer to the key, shaped like an element.
+ * @param[in] order  Ordering function the vector is sorted by.
+ *
+ * @return Index of the element, `vec->size` if every element goes before `key`.
+ */
+size_t vector_lower_bound(const struct vector *vec, const void *key, order_func order);
+
+/**
+ * @brief Finds the first element of a sorted vector that goes after `key`.
+ *
+ * @param[in] vec    Pointer to the sorted vector.
+ * @param[in] key    Pointer to the key, shaped like an element.
+ * @param[in] order  Ordering function the vector is sorted by.
+ *
+ * @return Index of the element, `vec->size` if no element goes after `key`.
+ */
+size_t vector_upper_bound(const struct vector *vec, const void *key, order_func order);
+
+/**
+ * @brief Searches a sorted vector for an element equivalent to `key` in O(log n).
+ *
+ * If found, and if `element` is non-NULL, the first equivalent element is copied into it.
+ *
+ * @param[in]  vec      Pointer to the sorted vector.
+ * @param[in]  key      Pointer to the key, shaped like an element.
+ * @param[out] element  Optional pointer to store the found element.
+ * @param[in]  order    Ordering function the vector is sorted by.
+ *
+ * @return `true` if the element is found, `false` otherwise.
+ */
+bool vector_binary_search(const struct vector *vec, const void *key, void *element, order_func order);
+
+/**
+ * @brief Finds the elements of a sorted vector between `low` and `high`, both included.
+ *
+ * @param[in]  vec    Pointer to the sorted vector.
+ * @param[in]  low    Pointer to the lowest key, shaped like an element.
+ * @param[in]  high   Pointer to the highest key, shaped like an element.
+ * @param[out] first  Optional pointer to store the index of the first element in range.
+ * @param[in]  order  Ordering function the vector is sorted by.
+ *
+ * @return Number of elements in range, they are contiguous from `first`.
+ */
+size_t vector_range(const struct vector *vec, const void *low, const void *high, size_t *first, order_func order);
+
+/**
+ * @brief Inserts an element into a sorted vector, after any equivalent elements.
+ *
+ * @param[in,out] vec      Pointer to the sorted vector.
+ * @param[in]     element  Pointer to the element to insert.
+ * @param[in]     order    Ordering function the vector is sorted by.
+ *
+ * @return `true` on success, `false` on allocation failure or invalid input.
+ */
+bool vector_insert_sorted(struct vector *vec, const void *element, order_func order);
+
+/**
+ * @brief Inserts many elements into a sorted vector at once.
+ *
+ * The batch is sorted then merged into the vector in one pass from the back,
+ * O(n + m log m) instead of m shifting insertions. Equivalent elements keep
+ * existing ones first.
+ *
+ * @param[in,out] vec       Pointer to the sorted vector.
+ * @param[in]     elements  Pointer to the elements to insert, in any order.
+ * @param[in]     total     Number of elements to insert.
+ * @param[in]     order     Ordering function the vector is sorted by.
+ *
+ * @return `true` on success, `false` on allocation failure or invalid input.
+ */
+bool vector_merge_sorted(struct vector *vec, const void *elements, const size_t total, order_func order);
+
+/**
+ * @brief Initializes `dst` with a copy of the elements of `src`.
+ *
+ * Elements are copied byte for byte, whatever they point to is shared.
+ *
+ * @param[in]  src  Pointer to the initialized vector to copy.
+ * @param[out] dst  Pointer to the caller allocated vector to initialize.
+ *
+ * @return `true` on success, `false` on invalid input or allocation failure.
+ */
+bool vector_copy(const struct vector *src, struct vector *dst);
+
 /**
  * @brief Frees the internal memory used by the vector.
  *
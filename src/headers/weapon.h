@@ -1,7 +1,9 @@
 /*! Weapon declaration file */
 
 #pragma once
+#include "name.h"
 #include <stdbool.h>
+#include <stddef.h>
 
 /**
  * @struct weapon
@@ -9,13 +11,39 @@
  */
 struct weapon {
     /** Weapon name. */
-    char *weapon_name;
+    struct name weapon_name;
     /** Weapon health. */
     unsigned int weapon_health;
     /** Weapon damage. */
     unsigned int weapon_damage;
 };
 
+/**
+ * @struct weapon_spec
+ * @brief Arguments of weapon_initialize(), for building many weapons at once.
+ */
+struct weapon_spec {
+    /** Name of the weapon. */
+    const char *name;
+    /** Health of the weapon. */
+    unsigned int health;
+    /** Damage of the weapon. */
+    unsigned int damage;
+};
+
+/**
+ * @struct weapon_batch
+ * @brief Weapons built together, with one allocation for the structs and one for the names.
+ */
+struct weapon_batch {
+    /** Weapons, in the order of their specs. */
+    struct weapon *weapons;
+    /** Names too long to be inline, NULL if there are none. */
+    char *names;
+    /** Number of weapons. */
+    size_t size;
+};
+
 /**
  * @brief Initialize weapon.
  * 
@@ -26,6 +54,17 @@ struct weapon {
  * @return true if created, false otherwise. 
  */
 bool weapon_initialize(const char *name, const unsigned int health, const unsigned int damage, struct weapon *w);
+/**
+ * @brief Initializes weapons from specs, validated as weapon_initialize() does.
+ * 
+ * Copies of the weapons share their long names with the batch, so they must not outlive it.
+ * 
+ * @param[in] specs Specs of the weapons.
+ * @param[in] total Number of specs.
+ * @param[out] batch Pointer to caller allocated batch struct.
+ * @return true if every weapon was created, false otherwise.
+ */
+bool weapon_batch_initialize(const struct weapon_spec *specs, const size_t total, struct weapon_batch *batch);
 /**
  * @brief Gets weapon's name.
  * 
@@ -76,6 +115,14 @@ void weapon_enhance(const unsigned int enhance_damage, struct weapon *w);
  * @return true if weapon found, false otherwise.
  */
 bool weapon_name_cmp(const void *w, const void *k);
+/**
+ * @brief Ordering function to sort weapons by name, for the sorted vector functions.
+ * 
+ * @param[in] a Pointer to weapon struct.
+ * @param[in] b Pointer to weapon struct.
+ * @return Negative, 0 or positive as strcmp() of their names.
+ */
+int weapon_name_order(const void *a, const void *b);
 /**
  * @brief Checks if the both weapons are equal.
  * 
@@ -89,4 +136,10 @@ bool weapon_is_equal(const struct weapon *w1, const struct weapon *w2);
  * 
  * @param[in] w Pointer to weapon struct.
  */
-void weapon_deinitialize(struct weapon *w);
\ No newline at end of file
+void weapon_deinitialize(struct weapon *w);
+/**
+ * @brief Deinitializes the batch and every weapon in it.
+ * 
+ * @param[in] batch Pointer to batch struct.
+ */
+void weapon_batch_deinitialize(struct weapon_batch *batch);
\ No newline at end of file
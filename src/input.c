@@ -0,0 +1,199 @@
+/*! Input thread implementation file */
+
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "headers/input.h"
+#include "headers/tokenizer.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+void input_command_parse(const char *line, const size_t length, struct input_command *cmd)
+{
+    if (!cmd) {
+        return;
+    }
+
+    memset(cmd, 0, sizeof(*cmd));
+    struct string_view trimmed = { .data = line, .length = line ? length : 0 };
+    trimmed = string_view_trim(trimmed);
+    if (trimmed.length >= INPUT_LINE_SIZE) {
+        trimmed.length = INPUT_LINE_SIZE - 1;
+    }
+    string_view_copy(trimmed, sizeof(cmd->line), cmd->line);
+}
+
+/**
+ * @brief Trims a line and hands it to the consumer, waiting while the queue is full.
+ *
+ * @param[in] line Line to queue.
+ * @param[in] length Length of the line.
+ * @param[in] it Pointer to input thread struct.
+ */
+static void input_thread_emit(const char *line, const size_t length, struct input_thread *it)
+{
+    struct input_command cmd = {0};
+    input_command_parse(line, length, &cmd);
+
+    while (!spsc_queue_push(&it->commands, &cmd)) {
+        if (!atomic_load_explicit(&it->running, memory_order_relaxed)) {
+            return;
+        }
+        thrd_yield();
+    }
+}
+
+#ifndef _WIN32
+
+/**
+ * @brief Reader loop. Polls the descriptor so a stop request is noticed even while the player is idle.
+ *
+ * @param[in] arg Pointer to input thread struct.
+ * @return 0 always.
+ */
+static int input_thread_main(void *arg)
+{
+    struct input_thread *it = arg;
+    const int fd = fileno(it->stream);
+    char pending[INPUT_LINE_SIZE * 4];
+    size_t pending_length = 0;
+
+    while (atomic_load_explicit(&it->running, memory_order_relaxed)) {
+        struct pollfd pfd = { .fd = fd, .events = POLLIN, .revents = 0 };
+        const int ready = poll(&pfd, 1, INPUT_POLL_MS);
+        if (ready == 0 || (ready < 0 && errno == EINTR)) {
+            continue;
+        }
+        if (ready < 0) {
+            break;
+        }
+
+        const ssize_t read_bytes = read(fd, pending + pending_length, sizeof(pending) - pending_length);
+        if (read_bytes < 0 && errno == EINTR) {
+            continue;
+        }
+        if (read_bytes <= 0) {
+            break;
+        }
+        pending_length += (size_t)read_bytes;
+
+        // Queue every complete line and keep the partial one for the next read
+        size_t consumed = 0;
+        const char *newline = NULL;
+        while ((newline = memchr(pending + consumed, '\n', pending_length - consumed))) {
+            const size_t line_length = (size_t)(newline - (pending + consumed));
+            input_thread_emit(pending + consumed, line_length, it);
+            consumed += line_length + 1;
+        }
+
+        if (consumed == 0 && pending_length == sizeof(pending)) {
+            // No terminator in sight, cut the line here
+            input_thread_emit(pending, pending_length, it);
+            consumed = pending_length;
+        }
+        memmove(pending, pending + consumed, pending_length - consumed);
+        pending_length -= consumed;
+    }
+
+    if (pending_length > 0) {
+        input_thread_emit(pending, pending_length, it);
+    }
+    atomic_store_explicit(&it->closed, true, memory_order_release);
+    return 0;
+}
+
+#else
+
+/**
+ * @brief Reader loop. Console handles cannot be polled alongside stdio, so this blocks in fgets.
+ *
+ * @param[in] arg Pointer to input thread struct.
+ * @return 0 always.
+ */
+static int input_thread_main(void *arg)
+{
+    struct input_thread *it = arg;
+    char line[INPUT_LINE_SIZE];
+
+    while (atomic_load_explicit(&it->running, memory_order_relaxed) && fgets(line, sizeof(line), it->stream)) {
+        input_thread_emit(line, strlen(line), it);
+    }
+
+    atomic_store_explicit(&it->closed, true, memory_order_release);
+    return 0;
+}
+
+#endif
+
+bool input_thread_start(FILE *stream, const size_t queue_capacity, struct input_thread *it)
+{
+    if (!stream || queue_capacity == 0 || !it) {
+        return false;
+    }
+
+    if (!spsc_queue_initialize(queue_capacity, sizeof(struct input_command), &it->commands)) {
+        return false;
+    }
+    it->stream = stream;
+    atomic_init(&it->running, true);
+    atomic_init(&it->closed, false);
+
+    if (thrd_create(&it->thread, input_thread_main, it) != thrd_success) {
+        spsc_queue_deinitialize(&it->commands);
+        return false;
+    }
+
+    return true;
+}
+
+bool input_thread_poll(struct input_thread *it, struct input_command *cmd)
+{
+    if (!it || !cmd) {
+        return false;
+    }
+
+    return spsc_queue_pop(&it->commands, cmd);
+}
+
+bool input_thread_is_closed(struct input_thread *it)
+{
+    if (!it) {
+        return true;
+    }
+
+    if (!atomic_load_explicit(&it->closed, memory_order_acquire)) {
+        return false;
+    }
+
+    // The reader is done, so tail is final
+    return atomic_load_explicit(&it->commands.head, memory_order_relaxed) ==
+    atomic_load_explicit(&it->commands.tail, memory_order_acquire);
+}
+
+void input_thread_stop(struct input_thread *it)
+{
+    if (!it || !it->commands.items) {
+        return;
+    }
+
+    atomic_store_explicit(&it->running, false, memory_order_relaxed);
+#ifndef _WIN32
+    thrd_join(it->thread, NULL);
+    spsc_queue_deinitialize(&it->commands);
+#else
+    if (atomic_load_explicit(&it->closed, memory_order_acquire)) {
+        thrd_join(it->thread, NULL);
+        spsc_queue_deinitialize(&it->commands);
+    } else {
+        // Still blocked in fgets, the queue stays alive for it until the process exits
+        thrd_detach(it->thread);
+    }
+#endif
+}
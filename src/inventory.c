@@ -0,0 +1,351 @@
+/*! Inventory index implementation file */
+
+#include "headers/inventory.h"
+#include "headers/alloc.h"
+#include "headers/damage.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @typedef inventory_before_func
+ * @brief Strict order of an index, true if weapon a goes before weapon b.
+ */
+typedef bool (*inventory_before_func)(const struct inventory_index *idx, const size_t a, const size_t b);
+
+static bool inventory_key_usable(const struct inventory_key *k)
+{
+    return k->health > 0 && k->damage > 0;
+}
+
+static bool inventory_damage_before(const struct inventory_index *idx, const size_t a, const size_t b)
+{
+    const struct inventory_key *ka = &idx->keys[a];
+    const struct inventory_key *kb = &idx->keys[b];
+    if (inventory_key_usable(ka) != inventory_key_usable(kb)) {
+        return inventory_key_usable(ka);
+    }
+    if (ka->damage != kb->damage) {
+        return ka->damage > kb->damage;
+    }
+    if (ka->health != kb->health) {
+        return ka->health > kb->health;
+    }
+    return a < b;
+}
+
+static bool inventory_durability_before(const struct inventory_index *idx, const size_t a, const size_t b)
+{
+    const struct inventory_key *ka = &idx->keys[a];
+    const struct inventory_key *kb = &idx->keys[b];
+    if (inventory_key_usable(ka) != inventory_key_usable(kb)) {
+        return inventory_key_usable(ka);
+    }
+    if (ka->health != kb->health) {
+        return ka->health > kb->health;
+    }
+    if (ka->damage != kb->damage) {
+        return ka->damage > kb->damage;
+    }
+    return a < b;
+}
+
+/**
+ * @brief Finds the first of total entries that does not go before the weapon, its own slot if indexed.
+ */
+static size_t inventory_lower_bound(const struct inventory_index *idx, const size_t *order, const size_t total, const size_t weapon, inventory_before_func before)
+{
+    size_t low = 0;
+    size_t high = total;
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        if (before(idx, order[mid], weapon)) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+/**
+ * @brief Inserts a weapon into an order of total entries, which has room for one more.
+ */
+static void inventory_order_insert(const struct inventory_index *idx, size_t *order, const size_t total, const size_t weapon, inventory_before_func before)
+{
+    const size_t at = inventory_lower_bound(idx, order, total, weapon, before);
+    memmove(&order[at + 1], &order[at], (total - at) * sizeof(*order));
+    order[at] = weapon;
+}
+
+/**
+ * @brief Removes an indexed weapon from an order of total entries, using its current key.
+ */
+static void inventory_order_erase(const struct inventory_index *idx, size_t *order, const size_t total, const size_t weapon, inventory_before_func before)
+{
+    const size_t at = inventory_lower_bound(idx, order, total, weapon, before);
+    if (at < total && order[at] == weapon) {
+        memmove(&order[at], &order[at + 1], (total - at - 1) * sizeof(*order));
+    }
+}
+
+static void inventory_index_set_key(const struct vector *weapons, const size_t position, struct inventory_index *idx)
+{
+    const struct weapon *w = (const struct weapon *)vector_items(weapons) + position;
+    idx->keys[position].damage = w->weapon_damage;
+    idx->keys[position].health = w->weapon_health;
+}
+
+/**
+ * @brief Indexes every weapon of the vector into an empty index with room for them.
+ */
+static void inventory_index_build(const struct vector *weapons, struct inventory_index *idx)
+{
+    for (size_t i = 0; i < weapons->size; i++) {
+        inventory_index_set_key(weapons, i, idx);
+        inventory_order_insert(idx, idx->by_damage, i, i, inventory_damage_before);
+        inventory_order_insert(idx, idx->by_durability, i, i, inventory_durability_before);
+    }
+    idx->size = weapons->size;
+}
+
+bool inventory_index_initialize(const struct vector *weapons, struct inventory_index *idx)
+{
+    if (!weapons || !idx) {
+        return false;
+    }
+
+    memset(idx, 0, sizeof(*idx));
+    if (!inventory_index_reserve(weapons->size ? weapons->size : 1, idx)) {
+        inventory_index_deinitialize(idx);
+        return false;
+    }
+    inventory_index_build(weapons, idx);
+    return true;
+}
+
+size_t inventory_index_storage_size(const size_t total)
+{
+    const size_t entries = total ? total : 1;
+    const size_t bytes = entries * (2 * sizeof(size_t) + sizeof(struct inventory_key));
+    return (bytes + sizeof(size_t) - 1) / sizeof(size_t) * sizeof(size_t);
+}
+
+bool inventory_index_initialize_in(const struct vector *weapons, void *storage, struct inventory_index *idx)
+{
+    if (!weapons || !storage || !idx) {
+        return false;
+    }
+
+    const size_t entries = weapons->size ? weapons->size : 1;
+    memset(idx, 0, sizeof(*idx));
+    idx->by_damage = storage;
+    idx->by_durability = idx->by_damage + entries;
+    idx->keys = (struct inventory_key *)(idx->by_durability + entries);
+    idx->capacity = entries;
+    idx->_borrowed = true;
+    inventory_index_build(weapons, idx);
+    return true;
+}
+
+bool inventory_index_copy(const struct inventory_index *src, struct inventory_index *dst)
+{
+    if (!src || !dst) {
+        return false;
+    }
+
+    memset(dst, 0, sizeof(*dst));
+    if (!inventory_index_reserve(src->size ? src->size : 1, dst)) {
+        inventory_index_deinitialize(dst);
+        return false;
+    }
+    if (src->size) {
+        memcpy(dst->keys, src->keys, src->size * sizeof(*src->keys));
+        memcpy(dst->by_damage, src->by_damage, src->size * sizeof(*src->by_damage));
+        memcpy(dst->by_durability, src->by_durability, src->size * sizeof(*src->by_durability));
+    }
+    dst->size = src->size;
+    return true;
+}
+
+bool inventory_index_reserve(const size_t total, struct inventory_index *idx)
+{
+    if (!idx) {
+        return false;
+    }
+    if (total <= idx->capacity) {
+        return true;
+    }
+
+    size_t capacity = idx->capacity ? idx->capacity : 1;
+    while (capacity < total) {
+        capacity *= 2;
+    }
+
+    if (idx->_borrowed) {
+        // The storage is not ours to grow, move to the heap
+        struct inventory_key *keys = alloc_malloc(capacity * sizeof(*keys), ALLOC_TAG_PLAYER);
+        size_t *by_damage = alloc_malloc(capacity * sizeof(*by_damage), ALLOC_TAG_PLAYER);
+        size_t *by_durability = alloc_malloc(capacity * sizeof(*by_durability), ALLOC_TAG_PLAYER);
+        if (!keys || !by_damage || !by_durability) {
+            alloc_free(keys);
+            alloc_free(by_damage);
+            alloc_free(by_durability);
+            return false;
+        }
+        memcpy(keys, idx->keys, idx->size * sizeof(*keys));
+        memcpy(by_damage, idx->by_damage, idx->size * sizeof(*by_damage));
+        memcpy(by_durability, idx->by_durability, idx->size * sizeof(*by_durability));
+        idx->keys = keys;
+        idx->by_damage = by_damage;
+        idx->by_durability = by_durability;
+        idx->_borrowed = false;
+        idx->capacity = capacity;
+        return true;
+    }
+
+    struct inventory_key *keys = alloc_realloc(idx->keys, capacity * sizeof(*keys), ALLOC_TAG_PLAYER);
+    if (!keys) {
+        return false;
+    }
+    idx->keys = keys;
+    size_t *by_damage = alloc_realloc(idx->by_damage, capacity * sizeof(*by_damage), ALLOC_TAG_PLAYER);
+    if (!by_damage) {
+        return false;
+    }
+    idx->by_damage = by_damage;
+    size_t *by_durability = alloc_realloc(idx->by_durability, capacity * sizeof(*by_durability), ALLOC_TAG_PLAYER);
+    if (!by_durability) {
+        return false;
+    }
+    idx->by_durability = by_durability;
+
+    idx->capacity = capacity;
+    return true;
+}
+
+void inventory_index_push_back(const struct vector *weapons, struct inventory_index *idx)
+{
+    if (!weapons || !idx || weapons->size != idx->size + 1 || idx->size >= idx->capacity) {
+        return;
+    }
+
+    const size_t position = idx->size;
+    inventory_index_set_key(weapons, position, idx);
+    inventory_order_insert(idx, idx->by_damage, idx->size, position, inventory_damage_before);
+    inventory_order_insert(idx, idx->by_durability, idx->size, position, inventory_durability_before);
+    idx->size++;
+}
+
+void inventory_index_remove(const size_t position, struct inventory_index *idx)
+{
+    if (!idx || position >= idx->size) {
+        return;
+    }
+
+    inventory_order_erase(idx, idx->by_damage, idx->size, position, inventory_damage_before);
+    inventory_order_erase(idx, idx->by_durability, idx->size, position, inventory_durability_before);
+    idx->size--;
+
+    // Later weapons move down one slot in the vector, renumbering keeps both orders valid
+    memmove(&idx->keys[position], &idx->keys[position + 1], (idx->size - position) * sizeof(*idx->keys));
+    for (size_t i = 0; i < idx->size; i++) {
+        idx->by_damage[i] -= idx->by_damage[i] > position;
+        idx->by_durability[i] -= idx->by_durability[i] > position;
+    }
+}
+
+void inventory_index_update(const struct vector *weapons, const size_t position, struct inventory_index *idx)
+{
+    if (!weapons || !idx || position >= idx->size || position >= weapons->size) {
+        return;
+    }
+
+    const struct weapon *w = (const struct weapon *)vector_items(weapons) + position;
+    if (idx->keys[position].damage == w->weapon_damage && idx->keys[position].health == w->weapon_health) {
+        return;
+    }
+
+    inventory_order_erase(idx, idx->by_damage, idx->size, position, inventory_damage_before);
+    inventory_order_erase(idx, idx->by_durability, idx->size, position, inventory_durability_before);
+    inventory_index_set_key(weapons, position, idx);
+    inventory_order_insert(idx, idx->by_damage, idx->size - 1, position, inventory_damage_before);
+    inventory_order_insert(idx, idx->by_durability, idx->size - 1, position, inventory_durability_before);
+}
+
+bool inventory_index_strongest(const struct inventory_index *idx, size_t *position)
+{
+    if (!idx || !position || idx->size == 0 || !inventory_key_usable(&idx->keys[idx->by_damage[0]])) {
+        return false;
+    }
+
+    *position = idx->by_damage[0];
+    return true;
+}
+
+bool inventory_index_most_durable(const struct inventory_index *idx, size_t *position)
+{
+    if (!idx || !position || idx->size == 0 || !inventory_key_usable(&idx->keys[idx->by_durability[0]])) {
+        return false;
+    }
+
+    *position = idx->by_durability[0];
+    return true;
+}
+
+bool inventory_index_best_against(const struct inventory_index *idx, const unsigned int armor_resistance, size_t *position)
+{
+    size_t strongest = 0;
+    if (!inventory_index_strongest(idx, &strongest) || !position) {
+        return false;
+    }
+
+    // Armor formulas never reward less damage, so the best hit is the strongest weapon's
+    const unsigned int best = damage_mitigate(idx->keys[strongest].damage, armor_resistance);
+    if (best == 0) {
+        return false;
+    }
+
+    // Last usable weapon that still hits that hard
+    size_t low = 0;
+    size_t high = idx->size;
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        const struct inventory_key *k = &idx->keys[idx->by_damage[mid]];
+        if (inventory_key_usable(k) && damage_mitigate(k->damage, armor_resistance) == best) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    const size_t end = low;
+    const unsigned int lowest_damage = idx->keys[idx->by_damage[end - 1]].damage;
+
+    // First weapon with that damage, the one with the most health
+    low = 0;
+    high = end;
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        if (idx->keys[idx->by_damage[mid]].damage > lowest_damage) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    *position = idx->by_damage[low];
+    return true;
+}
+
+void inventory_index_deinitialize(struct inventory_index *idx)
+{
+    if (!idx) {
+        return;
+    }
+
+    if (!idx->_borrowed) {
+        alloc_free(idx->keys);
+        alloc_free(idx->by_damage);
+        alloc_free(idx->by_durability);
+    }
+    memset(idx, 0, sizeof(*idx));
+}
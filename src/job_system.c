@@ -0,0 +1,422 @@
+/*! Job system implementation file */
+
+#include "headers/job_system.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+/**
+ * @struct job
+ * @brief A submitted job as kept in the injection queue.
+ */
+struct job {
+    /** Job function. */
+    job_func func;
+    /** Job argument. */
+    void *arg;
+};
+
+/** Worker running on the current thread, NULL outside the pool. */
+static _Thread_local struct job_worker *current_worker = NULL;
+
+size_t job_system_default_workers(void)
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (size_t)info.dwNumberOfProcessors : 1;
+#else
+    const long online = sysconf(_SC_NPROCESSORS_ONLN);
+    return online > 0 ? (size_t)online : 1;
+#endif
+}
+
+/**
+ * @brief Initializes a deque.
+ *
+ * @param[out] d Pointer to deque struct.
+ * @return true if success, false otherwise.
+ */
+static bool job_deque_initialize(struct job_deque *d)
+{
+    d->funcs = malloc(JOB_DEQUE_CAPACITY * sizeof(*d->funcs));
+    d->args = malloc(JOB_DEQUE_CAPACITY * sizeof(*d->args));
+    if (!d->funcs || !d->args) {
+        free(d->funcs);
+        free(d->args);
+        return false;
+    }
+
+    for (size_t i = 0; i < JOB_DEQUE_CAPACITY; i++) {
+        atomic_init(&d->funcs[i], NULL);
+        atomic_init(&d->args[i], NULL);
+    }
+    atomic_init(&d->top, 0);
+    atomic_init(&d->bottom, 0);
+
+    return true;
+}
+
+/**
+ * @brief Pushes a job at the bottom. Owner only.
+ *
+ * @param[in,out] d Pointer to deque struct.
+ * @param[in] func Job function.
+ * @param[in] arg Job argument.
+ * @return true if pushed, false if the deque is full.
+ */
+static bool job_deque_push(struct job_deque *d, job_func func, void *arg)
+{
+    const int64_t bottom = atomic_load_explicit(&d->bottom, memory_order_relaxed);
+    const int64_t top = atomic_load_explicit(&d->top, memory_order_acquire);
+    if (bottom - top >= JOB_DEQUE_CAPACITY) {
+        return false;
+    }
+
+    const size_t slot = (size_t)bottom % JOB_DEQUE_CAPACITY;
+    atomic_store_explicit(&d->funcs[slot], func, memory_order_relaxed);
+    atomic_store_explicit(&d->args[slot], arg, memory_order_relaxed);
+    // seq_cst pairs with the sleeping counter, see job_worker_sleep()
+    atomic_store_explicit(&d->bottom, bottom + 1, memory_order_seq_cst);
+
+    return true;
+}
+
+/**
+ * @brief Pops the most recently pushed job. Owner only.
+ *
+ * @param[in,out] d Pointer to deque struct.
+ * @param[out] out Popped job.
+ * @return true if a job was popped, false if the deque is empty.
+ */
+static bool job_deque_pop(struct job_deque *d, struct job *out)
+{
+    const int64_t bottom = atomic_load_explicit(&d->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&d->bottom, bottom, memory_order_seq_cst);
+    int64_t top = atomic_load_explicit(&d->top, memory_order_seq_cst);
+
+    if (top > bottom) {
+        atomic_store_explicit(&d->bottom, bottom + 1, memory_order_relaxed);
+        return false;
+    }
+
+    const size_t slot = (size_t)bottom % JOB_DEQUE_CAPACITY;
+    out->func = atomic_load_explicit(&d->funcs[slot], memory_order_relaxed);
+    out->arg = atomic_load_explicit(&d->args[slot], memory_order_relaxed);
+    if (top < bottom) {
+        return true;
+    }
+
+    // Last job, race the thieves for it
+    const bool won = atomic_compare_exchange_strong_explicit(&d->top, &top, top + 1,
+        memory_order_seq_cst, memory_order_relaxed);
+    atomic_store_explicit(&d->bottom, bottom + 1, memory_order_relaxed);
+    return won;
+}
+
+/**
+ * @brief Steals the oldest job. Any thread.
+ *
+ * @param[in,out] d Pointer to deque struct.
+ * @param[out] out Stolen job.
+ * @return true if a job was stolen, false if the deque was empty or the race was lost.
+ */
+static bool job_deque_steal(struct job_deque *d, struct job *out)
+{
+    int64_t top = atomic_load_explicit(&d->top, memory_order_seq_cst);
+    const int64_t bottom = atomic_load_explicit(&d->bottom, memory_order_seq_cst);
+    if (top >= bottom) {
+        return false;
+    }
+
+    const size_t slot = (size_t)top % JOB_DEQUE_CAPACITY;
+    out->func = atomic_load_explicit(&d->funcs[slot], memory_order_relaxed);
+    out->arg = atomic_load_explicit(&d->args[slot], memory_order_relaxed);
+
+    return atomic_compare_exchange_strong_explicit(&d->top, &top, top + 1,
+        memory_order_seq_cst, memory_order_relaxed);
+}
+
+/**
+ * @brief Checks if a deque looks non empty, used before going to sleep.
+ *
+ * @param[in] d Pointer to deque struct.
+ * @return true if it holds jobs, false otherwise.
+ */
+static bool job_deque_has_work(struct job_deque *d)
+{
+    return atomic_load_explicit(&d->top, memory_order_seq_cst) <
+    atomic_load_explicit(&d->bottom, memory_order_seq_cst);
+}
+
+/**
+ * @brief Deinitializes a deque.
+ *
+ * @param[in] d Pointer to deque struct.
+ */
+static void job_deque_deinitialize(struct job_deque *d)
+{
+    free(d->funcs);
+    free(d->args);
+    d->funcs = NULL;
+    d->args = NULL;
+}
+
+/**
+ * @brief Runs a job and reports its completion.
+ *
+ * @param[in,out] js Pointer to job system struct.
+ * @param[in] job Job to run.
+ * @param[in,out] rng Random state of the running worker.
+ */
+static void job_system_run(struct job_system *js, const struct job *job, pcg32_random_t *rng)
+{
+    job->func(job->arg, rng);
+
+    if (atomic_fetch_sub_explicit(&js->pending, 1, memory_order_acq_rel) == 1) {
+        mtx_lock(&js->lock);
+        cnd_broadcast(&js->done);
+        mtx_unlock(&js->lock);
+    }
+}
+
+/**
+ * @brief Wakes a sleeping worker if there is one.
+ *
+ * @param[in,out] js Pointer to job system struct.
+ */
+static void job_system_notify(struct job_system *js)
+{
+    if (atomic_load_explicit(&js->sleeping, memory_order_seq_cst) == 0) {
+        return;
+    }
+
+    mtx_lock(&js->lock);
+    cnd_signal(&js->wake);
+    mtx_unlock(&js->lock);
+}
+
+/**
+ * @brief Finds a job: own deque first, then the injection queue, then the other workers.
+ *
+ * @param[in,out] w Pointer to worker struct.
+ * @param[out] out Found job.
+ * @return true if a job was found, false otherwise.
+ */
+static bool job_worker_find(struct job_worker *w, struct job *out)
+{
+    struct job_system *js = w->system;
+    if (job_deque_pop(&w->deque, out)) {
+        return true;
+    }
+
+    mtx_lock(&js->lock);
+    const bool injected = js->injected.size > 0 && vector_pop_index(&js->injected, js->injected.size - 1, out);
+    mtx_unlock(&js->lock);
+    if (injected) {
+        return true;
+    }
+
+    for (size_t i = 1; i < js->total_workers; i++) {
+        struct job_worker *victim = &js->workers[(w->index + i) % js->total_workers];
+        if (job_deque_steal(&victim->deque, out)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Sleeps until work may be available or the system shuts down.
+ *
+ * The sleeping counter is raised before the final check, and submitters push
+ * before reading it, so either the check sees the job or the submitter sees the sleeper.
+ *
+ * @param[in,out] w Pointer to worker struct.
+ */
+static void job_worker_sleep(struct job_worker *w)
+{
+    struct job_system *js = w->system;
+
+    mtx_lock(&js->lock);
+    atomic_fetch_add_explicit(&js->sleeping, 1, memory_order_seq_cst);
+
+    bool has_work = js->injected.size > 0;
+    for (size_t i = 0; i < js->total_workers && !has_work; i++) {
+        has_work = job_deque_has_work(&js->workers[i].deque);
+    }
+    if (!has_work && atomic_load_explicit(&js->running, memory_order_relaxed)) {
+        cnd_wait(&js->wake, &js->lock);
+    }
+
+    atomic_fetch_sub_explicit(&js->sleeping, 1, memory_order_seq_cst);
+    mtx_unlock(&js->lock);
+}
+
+/**
+ * @brief Worker loop.
+ *
+ * @param[in] arg Pointer to worker struct.
+ * @return 0 always.
+ */
+static int job_worker_main(void *arg)
+{
+    struct job_worker *w = arg;
+    struct job_system *js = w->system;
+    current_worker = w;
+
+    struct job job = {0};
+    while (atomic_load_explicit(&js->running, memory_order_relaxed)) {
+        if (job_worker_find(w, &job)) {
+            job_system_run(js, &job, &w->rng);
+            continue;
+        }
+        job_worker_sleep(w);
+    }
+
+    current_worker = NULL;
+    return 0;
+}
+
+/**
+ * @brief Stops and joins the started workers and releases everything.
+ *
+ * @param[in] js Pointer to job system struct.
+ * @param[in] started_workers Number of worker threads that were started.
+ */
+static void job_system_release(struct job_system *js, const size_t started_workers)
+{
+    mtx_lock(&js->lock);
+    atomic_store_explicit(&js->running, false, memory_order_relaxed);
+    cnd_broadcast(&js->wake);
+    mtx_unlock(&js->lock);
+
+    for (size_t i = 0; i < started_workers; i++) {
+        thrd_join(js->workers[i].thread, NULL);
+    }
+    for (size_t i = 0; i < js->total_workers; i++) {
+        job_deque_deinitialize(&js->workers[i].deque);
+    }
+
+    cnd_destroy(&js->wake);
+    cnd_destroy(&js->done);
+    mtx_destroy(&js->lock);
+    vector_deinitialize(&js->injected);
+    free(js->workers);
+    memset(js, 0, sizeof(*js));
+}
+
+bool job_system_initialize(const size_t total_workers, const uint64_t seed, struct job_system *js)
+{
+    if (total_workers == 0 || !js) {
+        return false;
+    }
+
+    memset(js, 0, sizeof(*js));
+    js->workers = calloc(total_workers, sizeof(struct job_worker));
+    if (!js->workers) {
+        fprintf(stderr, "calloc failed at job_system_initialize()\n");
+        return false;
+    }
+    if (!vector_initialize(16, sizeof(struct job), &js->injected)) {
+        free(js->workers);
+        return false;
+    }
+    if (mtx_init(&js->lock, mtx_plain) != thrd_success) {
+        vector_deinitialize(&js->injected);
+        free(js->workers);
+        return false;
+    }
+    cnd_init(&js->wake);
+    cnd_init(&js->done);
+    atomic_init(&js->pending, 0);
+    atomic_init(&js->sleeping, 0);
+    atomic_init(&js->running, true);
+
+    for (size_t i = 0; i < total_workers; i++) {
+        struct job_worker *w = &js->workers[i];
+        w->system = js;
+        w->index = i;
+        // Same seed, a distinct stream per worker
+        pcg32_srandom_r(&w->rng, seed, (uint64_t)i);
+        if (!job_deque_initialize(&w->deque)) {
+            job_system_release(js, 0);
+            return false;
+        }
+        js->total_workers = i + 1;
+    }
+
+    for (size_t i = 0; i < total_workers; i++) {
+        if (thrd_create(&js->workers[i].thread, job_worker_main, &js->workers[i]) != thrd_success) {
+            fprintf(stderr, "thrd_create failed at job_system_initialize()\n");
+            job_system_release(js, i);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool job_system_submit(struct job_system *js, job_func func, void *arg)
+{
+    if (!js || !js->workers || !func) {
+        return false;
+    }
+
+    atomic_fetch_add_explicit(&js->pending, 1, memory_order_relaxed);
+
+    struct job_worker *w = current_worker;
+    if (w && w->system == js) {
+        if (!job_deque_push(&w->deque, func, arg)) {
+            // Deque full, running it here keeps the worker busy anyway
+            const struct job job = { .func = func, .arg = arg };
+            job_system_run(js, &job, &w->rng);
+            return true;
+        }
+        job_system_notify(js);
+        return true;
+    }
+
+    const struct job job = { .func = func, .arg = arg };
+    mtx_lock(&js->lock);
+    const bool pushed = vector_push_back(&js->injected, &job);
+    if (pushed) {
+        cnd_signal(&js->wake);
+    }
+    mtx_unlock(&js->lock);
+
+    if (!pushed) {
+        atomic_fetch_sub_explicit(&js->pending, 1, memory_order_relaxed);
+    }
+    return pushed;
+}
+
+void job_system_wait(struct job_system *js)
+{
+    if (!js || !js->workers) {
+        return;
+    }
+
+    mtx_lock(&js->lock);
+    while (atomic_load_explicit(&js->pending, memory_order_acquire) > 0) {
+        cnd_wait(&js->done, &js->lock);
+    }
+    mtx_unlock(&js->lock);
+}
+
+void job_system_deinitialize(struct job_system *js)
+{
+    if (!js || !js->workers) {
+        return;
+    }
+
+    job_system_wait(js);
+    job_system_release(js, js->total_workers);
+}
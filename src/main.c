@@ -3,30 +3,115 @@
 #include "headers/player.h"
 #include "headers/vector.h"
 #include "headers/game.h"
+#include "headers/tokenizer.h"
+#include "headers/input.h"
+#include "headers/server.h"
+#include "headers/balance.h"
+#include "headers/job_system.h"
+#include "headers/trace.h"
+#include "headers/alloc.h"
+#include "headers/analytics.h"
+#include "headers/error.h"
+#include "headers/spectate.h"
+#include "headers/command.h"
+#include "headers/raid.h"
+#include "headers/status.h"
+#include "headers/ai.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
-#include <limits.h>
+#include <threads.h>
+#include <signal.h>
+
+/** Length of one game tick while waiting for input, in milliseconds. */
+#define TICK_MS 10
+/** Time the enemy spends choosing its attack, in microseconds. */
+#define ENEMY_THINK_US 20000
+/** Transposition table entries of the enemy's search. */
+#define ENEMY_TABLE_ENTRIES 4096
+/** Health the enemy's venom takes each time it fires. */
+#define VENOM_DAMAGE 1
+/** Ticks between two firings of the venom. */
+#define VENOM_PERIOD 50
+/** Times the venom fires before it wears off. */
+#define VENOM_FIRINGS 10
 
 /**
- * @brief Used for getting user input.
+ * @typedef tick_func
+ * @brief Advances the game by one tick while waiting for input.
+ *
+ * @param[in,out] arg Caller data passed to get_input().
+ */
+typedef void (*tick_func)(void *arg);
+
+/**
+ * @brief Used for getting user input. Runs one game tick, then drains the input queue, every TICK_MS until a line arrives.
  * 
+ * @param[in] it Pointer to running input thread.
  * @param[in] msg Message to display to user.
  * @param[in] size Size of the user input.
  * @param[out] buffer User allocated buffer to hold user input.
+ * @param[in] tick Function advancing the game each tick, may be NULL before the game exists.
+ * @param[in,out] tick_arg Argument passed to tick.
  */
-void get_input(const char *msg, size_t size, char *buffer)
+void get_input(struct input_thread *it, const char *msg, size_t size, char *buffer, tick_func tick, void *tick_arg)
 {
     printf("%s", msg);
     fflush(stdout);
-    if (fgets(buffer, size, stdin)) {
-        size_t len = strlen(buffer);
-        if (len > 0 && buffer[len - 1] == '\n') {
-            buffer[len - 1] = '\0';
+
+    const struct timespec pause = { .tv_sec = 0, .tv_nsec = TICK_MS * 1000000L };
+    struct input_command cmd = {0};
+    TRACE_BEGIN("input wait");
+    for (;;) {
+        if (tick) {
+            tick(tick_arg);
         }
-    } else {
-        fprintf(stderr, "Error reading input.\n");
-        buffer[0] = '\0';  // Clear buffer instead of buffer = NULL
+        if (input_thread_poll(it, &cmd)) {
+            break;
+        }
+        if (input_thread_is_closed(it)) {
+            TRACE_END("input wait");
+            fprintf(stderr, "Error reading input.\n");
+            buffer[0] = '\0';  // Clear buffer instead of buffer = NULL
+            return;
+        }
+        thrd_sleep(&pause, NULL);
+    }
+    TRACE_END("input wait");
+
+    const size_t len = strlen(cmd.line);
+    if (len >= size) {
+        memcpy(buffer, cmd.line, size - 1);
+        buffer[size - 1] = '\0';
+        return;
+    }
+    memcpy(buffer, cmd.line, len + 1);
+}
+
+/**
+ * @struct game_clock
+ * @brief What advances while the interactive game waits for the player.
+ */
+struct game_clock {
+    /** Game the effects apply to. */
+    struct game *g;
+    /** Status effects of the game's players. */
+    struct status_wheel effects;
+    /** Spectator stream, written whenever an effect fires. */
+    struct spectate_stream *spectate;
+};
+
+/**
+ * @brief Advances the status effects of the game by one tick, see tick_func.
+ *
+ * @param[in,out] arg Pointer to game clock struct.
+ */
+static void game_clock_tick(void *arg)
+{
+    struct game_clock *clock = arg;
+    if (status_wheel_advance(1, clock->g, &clock->effects) > 0) {
+        spectate_stream_write_tick(clock->g, clock->spectate);
     }
 }
 
@@ -41,36 +126,343 @@ bool parse_int(const char *str, unsigned int *out_val)
 {
     if (!str || !out_val) return false;
 
-    char *endptr;
-    unsigned long val = strtoul(str, &endptr, 10);
+    return string_view_parse_uint(string_view_from_cstr(str), out_val);
+}
+
+/** Server stopped by handle_stop_signal(). */
+static struct server *running_server = NULL;
+
+/**
+ * @brief Stops the running server on SIGINT or SIGTERM.
+ * 
+ * @param[in] sig Signal number.
+ */
+static void handle_stop_signal(int sig)
+{
+    (void)sig;
+    server_stop(running_server);
+}
+
+/**
+ * @brief Hosts game sessions on a Unix domain socket until interrupted.
+ * 
+ * @param[in] socket_path Path to bind the socket to.
+ * @return 0 on success, 1 otherwise.
+ */
+int run_server(const char *socket_path)
+{
+    struct server s = {0};
+    if (!server_initialize(socket_path, &s)) {
+        return 1;
+    }
+
+    running_server = &s;
+    signal(SIGINT, handle_stop_signal);
+    signal(SIGTERM, handle_stop_signal);
+
+    const bool ok = server_run(&s);
+    server_deinitialize(&s);
+    running_server = NULL;
+
+    return ok ? 0 : 1;
+}
+
+/**
+ * @brief Prints the win probability and time to kill of every weapon and armor matchup of a catalog as CSV.
+ * 
+ * @param[in] argc Number of arguments.
+ * @param[in] argv Arguments: --balance <catalog> [health] [heal per turn] [weapon wear 0/1].
+ * @return 0 on success, 1 otherwise.
+ */
+int run_balance(int argc, char **argv)
+{
+    struct balance_config config = balance_default_config();
+    unsigned int wear = 0;
+    if ((argc > 3 && !parse_int(argv[3], &config.health)) ||
+        (argc > 4 && !parse_int(argv[4], &config.heal_per_turn)) ||
+        (argc > 5 && !parse_int(argv[5], &wear))) {
+        fprintf(stderr, "usage: %s --balance <catalog> [health] [heal per turn] [weapon wear 0/1]\n", argv[0]);
+        return 1;
+    }
+    config.weapon_wear = wear != 0;
+
+    struct vector weapons = {0};
+    struct vector armors = {0};
+    if (!balance_load_catalog(argv[2], &weapons, &armors)) {
+        return 1;
+    }
+
+    struct job_system js = {0};
+    const bool threaded = job_system_initialize(job_system_default_workers(), 42u, &js);
+    struct balance_matrix m = {0};
+    const bool ok = balance_analyze(&weapons, &armors, &config, threaded ? &js : NULL, &m);
+    if (threaded) {
+        job_system_deinitialize(&js);
+    }
+    if (ok) {
+        balance_print_csv(&m, stdout);
+        fprintf(stderr, "%zu loadouts, %zu of %zu matchups sampled\n", m.total_loadouts, m.total_sampled, m.total_loadouts * m.total_loadouts);
+    } else {
+        fprintf(stderr, "balance analysis failed\n");
+    }
+
+    balance_matrix_deinitialize(&m);
+    struct weapon *w = vector_items(&weapons);
+    for (size_t i = 0; i < weapons.size; i++) {
+        weapon_deinitialize(&w[i]);
+    }
+    struct armor *a = vector_items(&armors);
+    for (size_t i = 0; i < armors.size; i++) {
+        armor_deinitialize(&a[i]);
+    }
+    vector_deinitialize(&weapons);
+    vector_deinitialize(&armors);
+
+    return ok ? 0 : 1;
+}
+
+/**
+ * @brief Dumps the allocation stats to stderr, registered at exit when asked for.
+ */
+static void dump_allocations(void)
+{
+    alloc_dump(stderr);
+}
+
+/**
+ * @brief Runs a raid of identical attackers against one boss until it dies or nobody can hit it, and prints the outcome.
+ * 
+ * @param[in] argc Number of arguments.
+ * @param[in] argv Arguments: --raid <attackers> [boss health].
+ * @return 0 on success, 1 otherwise.
+ */
+int run_raid(int argc, char **argv)
+{
+    unsigned int total = 0;
+    unsigned int boss_health = 10000000;
+    if (!parse_int(argv[2], &total) || total == 0 || (argc > 3 && !parse_int(argv[3], &boss_health)) || boss_health == 0) {
+        fprintf(stderr, "usage: %s --raid <attackers> [boss health]\n", argv[0]);
+        return 1;
+    }
+
+    struct weapon sword = {0};
+    struct vector weapons = {0};
+    struct armor basic_armor = {0};
+    struct armor boss_armor = {0};
+    weapon_initialize("Sword", 100, 10, &sword);
+    vector_initialize(1, sizeof(struct weapon), &weapons);
+    vector_push_back(&weapons, &sword);
+    armor_initialize("BASIC", 10, 100, 1, &basic_armor);
+    armor_initialize("Boss plate", 1000, 1000, 2, &boss_armor);
+
+    // Attackers are built in one batch, each with its own copy of the weapons, then moved into the vector the raid walks
+    struct player_spec *specs = malloc(total * sizeof(*specs));
+    struct player_batch batch = {0};
+    struct vector attackers = {0};
+    struct player boss = {0};
+    bool ok = specs && vector_initialize(total, sizeof(struct player), &attackers);
+    for (size_t i = 0; ok && i < total; i++) {
+        specs[i] = (struct player_spec){ .name = "raider", .health = 100, .weapons = &weapons, .armor = &basic_armor };
+    }
+    ok = ok && player_batch_initialize(specs, total, &batch);
+    for (size_t i = 0; ok && i < batch.size; i++) {
+        ok = vector_push_back(&attackers, &batch.players[i]);
+    }
+    ok = ok && player_initialize("boss", boss_health, &weapons, &boss_armor, &boss);
+    free(specs);
+
+    struct job_system js = {0};
+    const bool threaded = ok && job_system_initialize(job_system_default_workers(), 42u, &js);
+    struct raid r = {0};
+    ok = ok && raid_initialize(42u, threaded ? &js : NULL, &r);
+
+    struct raid_result result = {0};
+    struct timespec start = {0};
+    struct timespec end = {0};
+    timespec_get(&start, TIME_UTC);
+    while (ok && boss.health > 0) {
+        ok = raid_tick(&attackers, &boss, &r, &result);
+        if (ok && result.hits == 0) {
+            break;
+        }
+    }
+    timespec_get(&end, TIME_UTC);
+
+    if (!ok) {
+        fprintf(stderr, "raid failed\n");
+    } else if (result.killed) {
+        printf("boss killed by attacker %zu on tick %llu\n", result.killer, (unsigned long long)r.tick);
+    } else {
+        printf("boss survived with %u health after %llu ticks\n", boss.health, (unsigned long long)r.tick);
+    }
+    const double seconds = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+    fprintf(stderr, "%u attackers, %llu ticks in %.3f s\n", total, (unsigned long long)r.tick, seconds);
 
-    if (*endptr != '\0') return false;
-    if (val > UINT_MAX) return false;
+    raid_deinitialize(&r);
+    if (threaded) {
+        job_system_deinitialize(&js);
+    }
+    player_deinitialize(&boss);
+    vector_deinitialize(&attackers);
+    player_batch_deinitialize(&batch);
+    armor_deinitialize(&boss_armor);
+    armor_deinitialize(&basic_armor);
+    vector_deinitialize(&weapons);
+    weapon_deinitialize(&sword);
+
+    return ok ? 0 : 1;
+}
+
+/**
+ * @brief Prints a spectator stream as written with GAME_SPECTATE, one block of players per tick.
+ * 
+ * @param[in] argc Number of arguments.
+ * @param[in] argv Arguments: --spectate <stream file> [frames to skip], skipping frames to join mid-stream.
+ * @return 0 on success, 1 otherwise.
+ */
+int run_spectate(int argc, char **argv)
+{
+    unsigned int skip = 0;
+    FILE *in = fopen(argv[2], "rb");
+    if (!in || (argc > 3 && !parse_int(argv[3], &skip))) {
+        fprintf(stderr, "usage: %s --spectate <stream file> [frames to skip]\n", argv[0]);
+        if (in) {
+            fclose(in);
+        }
+        return 1;
+    }
+
+    bool ok = true;
+    for (unsigned int i = 0; ok && i < skip; i++) {
+        ok = spectate_view_skip(in);
+    }
+
+    struct spectate_view view = {0};
+    ok = ok && spectate_view_initialize(&view);
+    while (ok && spectate_view_read(in, &view)) {
+        // Deltas before the first keyframe only have something to apply to once synced
+        if (!view.synced) {
+            continue;
+        }
+        printf("tick %llu\n", (unsigned long long)view.tick);
+        for (size_t i = 0; i < view.state.total_players; i++) {
+            const struct spectate_player *p = &view.state.players[i];
+            printf("  %s: %u health, %s %u/%u resistance %u%s\n", name_get(&p->name), p->health, name_get(&p->armor_name),
+                p->armor_health, p->armor_max_health, p->armor_resistance, p->wearing_armor ? "" : " (not worn)");
+            for (size_t j = 0; j < p->total_weapons; j++) {
+                const struct spectate_weapon *w = &p->weapons[j];
+                printf("    %s: %u health, %u damage\n", name_get(&w->name), w->health, w->damage);
+            }
+        }
+    }
+    ok = ok && feof(in);
+    if (!ok) {
+        fprintf(stderr, "malformed spectator stream\n");
+    }
+
+    spectate_view_deinitialize(&view);
+    fclose(in);
+
+    return ok ? 0 : 1;
+}
+
+/** Stream the error log writes to, closed at exit. */
+static FILE *error_log_out = NULL;
+
+/**
+ * @brief Stops the error log once it wrote everything, registered with atexit().
+ */
+static void stop_error_log(void)
+{
+    error_log_stop();
+    fclose(error_log_out);
+    error_log_out = NULL;
+}
 
-    *out_val = (unsigned int)val;
-    return true;
+/**
+ * @brief Writes the combat analytics to the file named by GAME_ANALYTICS, registered with atexit().
+ */
+static void dump_analytics(void)
+{
+    FILE *out = fopen(getenv(ANALYTICS_PATH_VARIABLE), "w");
+    if (!out) {
+        fprintf(stderr, "failed to open the analytics file\n");
+        return;
+    }
+    analytics_dump(out);
+    fclose(out);
 }
 
 /**
  * @brief Main function.
  * 
+ * Runs an interactive game, or with `--server <socket path>` hosts sessions over a Unix domain socket,
+ * or with `--balance <catalog>` analyzes the catalog's matchups, or with `--raid <attackers>` runs a raid
+ * of that many players against one boss, see raid.h. Built with GAME_TRACE, writes a Chrome trace to the
+ * file named by the GAME_TRACE environment variable at exit. With GAME_MEMORY_REPORT set,
+ * dumps the allocation stats of every subsystem at exit. With GAME_SPECTATE set, streams the interactive
+ * game to the file it names, see spectate.h, which `--spectate <stream file>` prints back. With GAME_ANALYTICS
+ * set, writes the combat analytics of every attack to the file it names at exit, see analytics.h. With
+ * GAME_ERROR_LOG set, logs failed calls to the file it names from a background thread, see error.h.
+ * 
+ * @param[in] argc Number of arguments.
+ * @param[in] argv Arguments.
  * @return 0 on success, 1 otherwise. 
  */
-int main(void)
+int main(int argc, char **argv)
 {
+#ifdef GAME_TRACE
+    trace_initialize(getenv(TRACE_PATH_VARIABLE));
+#endif
+    if (getenv(ALLOC_REPORT_VARIABLE)) {
+        atexit(dump_allocations);
+    }
+    const char *error_log_path = getenv(ERROR_LOG_PATH_VARIABLE);
+    error_log_out = error_log_path ? fopen(error_log_path, "w") : NULL;
+    if (error_log_out && error_log_start(error_log_out)) {
+        atexit(stop_error_log);
+    } else if (error_log_out) {
+        fclose(error_log_out);
+        error_log_out = NULL;
+    }
+    if (getenv(ANALYTICS_PATH_VARIABLE)) {
+        analytics_enable(true);
+        atexit(dump_analytics);
+    }
+
+    if (argc == 3 && strcmp(argv[1], "--server") == 0) {
+        return run_server(argv[2]);
+    }
+    if (argc >= 3 && argc <= 6 && strcmp(argv[1], "--balance") == 0) {
+        return run_balance(argc, argv);
+    }
+    if (argc >= 3 && argc <= 4 && strcmp(argv[1], "--raid") == 0) {
+        return run_raid(argc, argv);
+    }
+    if (argc >= 3 && argc <= 4 && strcmp(argv[1], "--spectate") == 0) {
+        return run_spectate(argc, argv);
+    }
+
+    struct input_thread input = {0};
+    if (!input_thread_start(stdin, 16, &input)) {
+        fprintf(stderr, "failed to start input thread\n");
+        return 1;
+    }
+
     char p_name[100] = {'\0'};
-    get_input("Enter your player name: ", sizeof(p_name), p_name);
+    get_input(&input, "Enter your player name: ", sizeof(p_name), p_name, NULL, NULL);
 
     char w_name[100] = {'\0'};
-    get_input("Enter weapon name: ", sizeof(w_name), w_name);
+    get_input(&input, "Enter weapon name: ", sizeof(w_name), w_name, NULL, NULL);
 
     char w_dmg_input[10] = {'\0'};
-    get_input("Enter weapon damage: ", sizeof(w_dmg_input), w_dmg_input);
+    get_input(&input, "Enter weapon damage: ", sizeof(w_dmg_input), w_dmg_input, NULL, NULL);
 
     unsigned int w_dmg = 0;
 
     if (!parse_int(w_dmg_input, &w_dmg)) {
         fprintf(stderr, "failed to parse weapon damage\n");
+        input_thread_stop(&input);
         return 1;
     }
 
@@ -78,58 +470,123 @@ int main(void)
     weapon_initialize(w_name, 100, w_dmg, &first_weapon);
 
     struct vector player_weapons = {0};
-    vector_initialize(10, sizeof(struct weapon), &player_weapons);
+    vector_initialize(1, sizeof(struct weapon), &player_weapons);
     vector_push_back(&player_weapons, &first_weapon);
 
-    struct armor basic_armor = {0};
-    armor_initialize("BASIC", 10, 100, 1, &basic_armor);
+    struct armor player_armor = {0};
+    armor_initialize("BASIC", 10, 100, 1, &player_armor);
 
     struct player cata = {0};
-    player_initialize(p_name, 100, &player_weapons, &basic_armor, &cata);
+    player_initialize_move(p_name, 100, &player_weapons, &player_armor, &cata);
 
     struct weapon sword = {0};
     weapon_initialize("Sword", 100, 10, &sword);
 
     struct vector enemy_weapons = {0};
-    vector_initialize(10, sizeof(struct weapon), &enemy_weapons);
+    vector_initialize(1, sizeof(struct weapon), &enemy_weapons);
     vector_push_back(&enemy_weapons, &sword);
 
+    struct armor enemy_armor = {0};
+    armor_initialize("BASIC", 10, 100, 1, &enemy_armor);
+
     struct player enemy = {0};
-    player_initialize("enemy", 50, &enemy_weapons, &basic_armor, &enemy);
+    player_initialize_move("enemy", 50, &enemy_weapons, &enemy_armor, &enemy);
+
+    const char *spectate_path = getenv(SPECTATE_PATH_VARIABLE);
+    FILE *spectate_out = spectate_path ? fopen(spectate_path, "wb") : NULL;
+    struct spectate_stream spectate = {0};
+    if (spectate_out) {
+        spectate_stream_initialize(SPECTATE_DEFAULT_KEYFRAME_INTERVAL, spectate_out, &spectate);
+    }
 
+    // Both players are moved into the game, which frees them and everything they own
     struct game g = {0};
-    game_initialize(2, &g);
-    game_insert_player(&cata, &g);
-    game_insert_player(&enemy, &g);
+    if (!game_initialize(2, &g) || !game_insert_player_move(&cata, &g) || !game_insert_player_move(&enemy, &g)) {
+        fprintf(stderr, "failed to start the game\n");
+        player_deinitialize(&cata);
+        player_deinitialize(&enemy);
+        game_deinitialize(&g);
+        spectate_stream_deinitialize(&spectate);
+        if (spectate_out) {
+            fclose(spectate_out);
+        }
+        input_thread_stop(&input);
+        return 1;
+    }
+    struct player *me = game_get_player_mut(0, &g);
+    struct player *foe = game_get_player_mut(1, &g);
+    spectate_stream_write_tick(&g, &spectate);
+
+    // Effects tick while the player types
+    struct game_clock clock = { .g = &g, .spectate = &spectate };
+    const tick_func tick = status_wheel_initialize(0, &clock.effects) ? game_clock_tick : NULL;
 
-    player_attack(&enemy, "Sword", &cata);
-    if (enemy.health == 0) {
-        game_remove_player(&enemy, &g);
+    // The enemy's blade is venomous: a hit that lands keeps hurting while the player thinks
+    // The enemy picks its attack with the combat AI, see ai.h, and swings its sword if the engine cannot start
+    const unsigned int health_before = me->health;
+    struct ai_engine enemy_ai = {0};
+    pcg32_random_t enemy_rng = {0};
+    pcg32_srandom_r(&enemy_rng, 42u, 54u);
+    if (ai_engine_initialize(ENEMY_TABLE_ENTRIES, 42u, &enemy_ai)) {
+        ai_take_turn(1, ENEMY_THINK_US, &g, &enemy_ai, &enemy_rng);
+        ai_engine_deinitialize(&enemy_ai);
+    } else {
+        player_attack_r(foe, "Sword", me, &enemy_rng);
+    }
+    if (tick && me->health < health_before) {
+        const struct status_effect venom = {
+            .kind = STATUS_EFFECT_POISON,
+            .player_index = 0,
+            .magnitude = VENOM_DAMAGE,
+            .period = VENOM_PERIOD,
+            .remaining = VENOM_FIRINGS
+        };
+        status_wheel_add(&venom, NULL, &clock.effects);
+    }
+    if (foe->health == 0) {
+        game_remove_player_at(1, &g);
+        status_wheel_remove_player(1, &clock.effects);
+        foe = NULL;
+        me = game_get_player_mut(0, &g);
     }
+    spectate_stream_write_tick(&g, &spectate);
 
-    get_input("Enter the name of the weapon you want to use: ", sizeof(w_name), w_name);
+    // Console commands until the player attacks, see command.h
+    struct command_context console = {0};
+    const bool has_console = command_context_initialize(me, foe, &console);
+    char line[INPUT_LINE_SIZE] = {'\0'};
+    while (has_console && !console.turn_over && me->health > 0) {
+        get_input(&input, "Enter a command (attack <weapon> ends your turn): ", sizeof(line), line, tick, &clock);
+        if (line[0] == '\0' && input_thread_is_closed(&input)) {
+            break;
+        }
+        if (!command_execute(string_view_from_cstr(line), &console)) {
+            fprintf(stderr, "cannot run \"%s\"\n", line);
+        }
+    }
+    command_context_deinitialize(&console);
 
-    player_attack(&cata, w_name, &enemy);
-    if (cata.health == 0) {
-        game_remove_player(&cata, &g);
+    if (me->health == 0) {
+        game_remove_player_at(0, &g);
+        status_wheel_remove_player(0, &clock.effects);
     }
+    spectate_stream_write_tick(&g, &spectate);
 
     struct player winner = {0};
     game_get_winner(&winner, &g);
-    if (winner.player_name) {
-        printf("%s has won!\n", winner.player_name);
+    if (!name_is_empty(&winner.player_name)) {
+        printf("%s has won!\n", name_get(&winner.player_name));
     } else {
         printf("No body won!\n");
     }
 
-    weapon_deinitialize(&first_weapon);
-    vector_deinitialize(&player_weapons);
-    armor_deinitialize(&basic_armor);
-    player_deinitialize(&cata);
-    player_deinitialize(&enemy);
-    weapon_deinitialize(&sword);
-    vector_deinitialize(&enemy_weapons);
+    status_wheel_deinitialize(&clock.effects);
     game_deinitialize(&g);
+    spectate_stream_deinitialize(&spectate);
+    if (spectate_out) {
+        fclose(spectate_out);
+    }
+    input_thread_stop(&input);
 
     return 0;
 }
\ No newline at end of file
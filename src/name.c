@@ -0,0 +1,148 @@
+/*! Name implementation file */
+
+#include "headers/name.h"
+#include "headers/alloc.h"
+#include "headers/error.h"
+#include <stdlib.h>
+#include <string.h>
+
+/** Tag of a name whose characters are on the heap and owned by it. */
+#define NAME_TAG_HEAP 1
+/** Tag of a name whose characters are in storage owned by someone else. */
+#define NAME_TAG_BORROWED 2
+
+static unsigned char name_tag(const struct name *n)
+{
+    return (unsigned char)n->bytes[NAME_SIZE - 1];
+}
+
+static char *name_heap_pointer(const struct name *n)
+{
+    char *heap = NULL;
+    memcpy(&heap, n->bytes, sizeof(heap));
+    return heap;
+}
+
+/**
+ * @brief Makes room for length characters, inline if they fit.
+ *
+ * @return Where to write the characters and the terminator, NULL on allocation failure.
+ */
+static char *name_reserve(const size_t length, struct name *n)
+{
+    memset(n->bytes, 0, NAME_SIZE);
+    if (length < NAME_SIZE) {
+        return n->bytes;
+    }
+
+    char *heap = alloc_malloc(length + 1, ALLOC_TAG_NAME);
+    if (!heap) {
+        return NULL;
+    }
+    memcpy(n->bytes, &heap, sizeof(heap));
+    n->bytes[NAME_SIZE - 1] = NAME_TAG_HEAP;
+    return heap;
+}
+
+bool name_initialize(const char *str, struct name *n)
+{
+    if (!str || !n) {
+        return error_set(ERROR_NULL_ARGUMENT, "name_initialize");
+    }
+
+    const size_t length = strlen(str);
+    char *dest = name_reserve(length, n);
+    if (!dest) {
+        return error_set(ERROR_OUT_OF_MEMORY, "name_initialize");
+    }
+    memcpy(dest, str, length + 1);
+
+    return true;
+}
+
+bool name_join(const char *first, const char separator, const char *second, struct name *n)
+{
+    if (!first || !second || !n) {
+        return error_set(ERROR_NULL_ARGUMENT, "name_join");
+    }
+
+    const size_t first_length = strlen(first);
+    const size_t second_length = strlen(second);
+    char *dest = name_reserve(first_length + 1 + second_length, n);
+    if (!dest) {
+        return error_set(ERROR_OUT_OF_MEMORY, "name_join");
+    }
+    memcpy(dest, first, first_length);
+    dest[first_length] = separator;
+    memcpy(dest + first_length + 1, second, second_length + 1);
+
+    return true;
+}
+
+size_t name_external_size(const char *str)
+{
+    if (!str) {
+        return 0;
+    }
+
+    const size_t length = strlen(str);
+    return length < NAME_SIZE ? 0 : length + 1;
+}
+
+bool name_initialize_in(const char *str, char *storage, struct name *n)
+{
+    if (!str || !n) {
+        return false;
+    }
+
+    memset(n->bytes, 0, NAME_SIZE);
+    const size_t length = strlen(str);
+    if (length < NAME_SIZE) {
+        memcpy(n->bytes, str, length + 1);
+        return true;
+    }
+    if (!storage) {
+        return false;
+    }
+
+    memcpy(storage, str, length + 1);
+    memcpy(n->bytes, &storage, sizeof(storage));
+    n->bytes[NAME_SIZE - 1] = NAME_TAG_BORROWED;
+
+    return true;
+}
+
+const char *name_get(const struct name *n)
+{
+    if (!n) {
+        return NULL;
+    }
+
+    return name_tag(n) ? name_heap_pointer(n) : n->bytes;
+}
+
+bool name_equals(const struct name *n, const char *str)
+{
+    if (!n || !str) {
+        return false;
+    }
+
+    return strcmp(name_get(n), str) == 0;
+}
+
+bool name_is_empty(const struct name *n)
+{
+    return !n || name_get(n)[0] == '\0';
+}
+
+void name_deinitialize(struct name *n)
+{
+    if (!n) {
+        return;
+    }
+
+    if (name_tag(n) == NAME_TAG_HEAP) {
+        alloc_free(name_heap_pointer(n));
+    }
+    memset(n->bytes, 0, NAME_SIZE);
+}
@@ -0,0 +1,333 @@
+/*! Parallel algorithms implementation file */
+
+#include "headers/parallel.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @struct parallel_context
+ * @brief State shared by every job of one algorithm call.
+ */
+struct parallel_context {
+    /** Elements read, the vector's or a sort buffer. */
+    char *items;
+    /** Elements written by transform and sort merges. */
+    char *out;
+    /** Size of an element of items. */
+    size_t e_size;
+    /** Size of an element of out, or of a partial result. */
+    size_t out_size;
+    /** First element of the range, the one written to the start of out by transform. */
+    size_t first;
+    /** Partial results of reduce, one per chunk. */
+    char *partials;
+    /** Function of for_each. */
+    parallel_each_func each;
+    /** Function of transform. */
+    parallel_transform_func transform;
+    /** Function of reduce. */
+    parallel_fold_func fold;
+    /** Function of sort. */
+    order_func order;
+    /** Argument of the user functions. */
+    void *arg;
+};
+
+/**
+ * @struct parallel_task
+ * @brief Job argument for one chunk, or for one merge of two runs.
+ */
+struct parallel_task {
+    /** Shared state. */
+    const struct parallel_context *ctx;
+    /** Position of the chunk, indexes its partial result. */
+    size_t index;
+    /** First element. */
+    size_t first;
+    /** First element of the second run of a merge. */
+    size_t middle;
+    /** One past the last element. */
+    size_t last;
+};
+
+/**
+ * @brief Gets how many chunks a range is split into, 1 to run it on the calling thread.
+ */
+static size_t parallel_total_chunks(const size_t total, const struct job_system *js)
+{
+    if (!js || !js->workers || total < 2 * PARALLEL_MIN_CHUNK) {
+        return 1;
+    }
+
+    const size_t most = js->total_workers * PARALLEL_CHUNKS_PER_WORKER;
+    const size_t chunks = total / PARALLEL_MIN_CHUNK;
+    return chunks < most ? chunks : most;
+}
+
+/**
+ * @brief Splits [first, last) into even chunks and fills one task per chunk.
+ */
+static void parallel_split(const struct parallel_context *ctx, const size_t first, const size_t last, const size_t total_chunks, struct parallel_task *tasks)
+{
+    const size_t total = last - first;
+    for (size_t i = 0; i < total_chunks; i++) {
+        tasks[i].ctx = ctx;
+        tasks[i].index = i;
+        tasks[i].first = first + total * i / total_chunks;
+        tasks[i].last = first + total * (i + 1) / total_chunks;
+        tasks[i].middle = tasks[i].last;
+    }
+}
+
+/**
+ * @brief Runs every task as a job, inline if it cannot be submitted, and waits for all of them.
+ */
+static void parallel_run(struct parallel_task *tasks, const size_t total_tasks, job_func func, struct job_system *js)
+{
+    for (size_t i = 0; i < total_tasks; i++) {
+        if (total_tasks == 1 || !js || !job_system_submit(js, func, &tasks[i])) {
+            func(&tasks[i], NULL);
+        }
+    }
+    if (total_tasks > 1) {
+        job_system_wait(js);
+    }
+}
+
+static void parallel_each_job(void *arg, pcg32_random_t *rng)
+{
+    (void)rng;
+    const struct parallel_task *task = arg;
+    const struct parallel_context *ctx = task->ctx;
+    for (size_t i = task->first; i < task->last; i++) {
+        ctx->each(ctx->items + i * ctx->e_size, ctx->arg);
+    }
+}
+
+static void parallel_transform_job(void *arg, pcg32_random_t *rng)
+{
+    (void)rng;
+    const struct parallel_task *task = arg;
+    const struct parallel_context *ctx = task->ctx;
+    for (size_t i = task->first; i < task->last; i++) {
+        ctx->transform(ctx->items + i * ctx->e_size, ctx->out + (i - ctx->first) * ctx->out_size, ctx->arg);
+    }
+}
+
+static void parallel_fold_job(void *arg, pcg32_random_t *rng)
+{
+    (void)rng;
+    const struct parallel_task *task = arg;
+    const struct parallel_context *ctx = task->ctx;
+    void *partial = ctx->partials + task->index * ctx->out_size;
+    for (size_t i = task->first; i < task->last; i++) {
+        ctx->fold(partial, ctx->items + i * ctx->e_size, ctx->arg);
+    }
+}
+
+static void parallel_sort_job(void *arg, pcg32_random_t *rng)
+{
+    (void)rng;
+    const struct parallel_task *task = arg;
+    const struct parallel_context *ctx = task->ctx;
+    qsort(ctx->items + task->first * ctx->e_size, task->last - task->first, ctx->e_size, ctx->order);
+}
+
+/**
+ * @brief Merges the sorted runs [first, middle) and [middle, last) of items into out.
+ */
+static void parallel_merge_job(void *arg, pcg32_random_t *rng)
+{
+    (void)rng;
+    const struct parallel_task *task = arg;
+    const struct parallel_context *ctx = task->ctx;
+    const size_t e_size = ctx->e_size;
+    size_t left = task->first;
+    size_t right = task->middle;
+    char *dest = ctx->out + task->first * e_size;
+
+    while (left < task->middle && right < task->last) {
+        // Ties take the left run first
+        if (ctx->order(ctx->items + right * e_size, ctx->items + left * e_size) < 0) {
+            memcpy(dest, ctx->items + right++ * e_size, e_size);
+        } else {
+            memcpy(dest, ctx->items + left++ * e_size, e_size);
+        }
+        dest += e_size;
+    }
+    memcpy(dest, ctx->items + left * e_size, (task->middle - left) * e_size);
+    dest += (task->middle - left) * e_size;
+    memcpy(dest, ctx->items + right * e_size, (task->last - right) * e_size);
+}
+
+/**
+ * @brief Splits [first, last) into total_chunks tasks, runs them and waits for all of them.
+ */
+static bool parallel_run_chunks(const struct parallel_context *ctx, const size_t first, const size_t last, const size_t total_chunks, job_func func, struct job_system *js)
+{
+    struct parallel_task single = {0};
+    struct parallel_task *tasks = total_chunks > 1 ? malloc(total_chunks * sizeof(*tasks)) : &single;
+    if (!tasks) {
+        return false;
+    }
+
+    parallel_split(ctx, first, last, total_chunks, tasks);
+    parallel_run(tasks, total_chunks, func, js);
+
+    if (tasks != &single) {
+        free(tasks);
+    }
+    return true;
+}
+
+/**
+ * @brief Checks that [first, last) is a range of the vector.
+ */
+static bool parallel_check_range(const struct vector *vec, const size_t first, const size_t last)
+{
+    return vec && vec->e_size > 0 && first <= last && last <= vec->size;
+}
+
+bool parallel_for_each(struct vector *vec, const size_t first, const size_t last, parallel_each_func func, void *arg, struct job_system *js)
+{
+    if (!parallel_check_range(vec, first, last) || !func) {
+        return false;
+    }
+
+    const struct parallel_context ctx = { .items = vector_items(vec), .e_size = vec->e_size, .each = func, .arg = arg };
+    return parallel_run_chunks(&ctx, first, last, parallel_total_chunks(last - first, js), parallel_each_job, js);
+}
+
+bool parallel_transform(const struct vector *src, const size_t first, const size_t last, parallel_transform_func func, void *arg, struct job_system *js, struct vector *dst)
+{
+    if (!parallel_check_range(src, first, last) || !func || !dst || dst == src || dst->e_size == 0) {
+        return false;
+    }
+
+    if (!vector_reserve(dst, last - first)) {
+        return false;
+    }
+
+    const struct parallel_context ctx = {
+        .items = vector_items(src),
+        .out = vector_items(dst),
+        .e_size = src->e_size,
+        .out_size = dst->e_size,
+        .first = first,
+        .transform = func,
+        .arg = arg
+    };
+    if (!parallel_run_chunks(&ctx, first, last, parallel_total_chunks(last - first, js), parallel_transform_job, js)) {
+        return false;
+    }
+    dst->size = last - first;
+
+    return true;
+}
+
+bool parallel_reduce(const struct vector *vec, const size_t first, const size_t last, const void *identity, const size_t result_size, parallel_fold_func fold, parallel_combine_func combine, void *arg, struct job_system *js, void *result)
+{
+    if (!parallel_check_range(vec, first, last) || !identity || result_size == 0 || !fold || !combine || !result) {
+        return false;
+    }
+
+    const size_t total_chunks = parallel_total_chunks(last - first, js);
+    char *partials = malloc(total_chunks * result_size);
+    if (!partials) {
+        return false;
+    }
+    for (size_t i = 0; i < total_chunks; i++) {
+        memcpy(partials + i * result_size, identity, result_size);
+    }
+
+    const struct parallel_context ctx = {
+        .items = vector_items(vec),
+        .e_size = vec->e_size,
+        .out_size = result_size,
+        .partials = partials,
+        .fold = fold,
+        .arg = arg
+    };
+    if (!parallel_run_chunks(&ctx, first, last, total_chunks, parallel_fold_job, js)) {
+        free(partials);
+        return false;
+    }
+
+    memcpy(result, identity, result_size);
+    for (size_t i = 0; i < total_chunks; i++) {
+        combine(result, partials + i * result_size, arg);
+    }
+
+    free(partials);
+    return true;
+}
+
+/*
+sorting 4 chunks: each chunk is sorted, then runs merge back and forth between the vector and a buffer
+
+vector: [3 1|4 2|8 5|7 6] -> [1 3|2 4|5 8|6 7]          sort round
+buffer:                      [1 2 3 4|5 6 7 8]          merge round, width 1
+vector:                      [1 2 3 4 5 6 7 8]          merge round, width 2
+*/
+
+bool parallel_sort(struct vector *vec, const size_t first, const size_t last, order_func order, struct job_system *js)
+{
+    if (!parallel_check_range(vec, first, last) || !order) {
+        return false;
+    }
+
+    const size_t total = last - first;
+    const size_t total_chunks = parallel_total_chunks(total, js);
+    char *items = (char *)vector_items(vec) + first * vec->e_size;
+    if (total_chunks == 1) {
+        if (total > 1) {
+            qsort(items, total, vec->e_size, order);
+        }
+        return true;
+    }
+
+    struct parallel_task *tasks = malloc(total_chunks * sizeof(*tasks));
+    char *buffer = malloc(total * vec->e_size);
+    size_t *bounds = malloc((total_chunks + 1) * sizeof(*bounds));
+    if (!tasks || !buffer || !bounds) {
+        free(tasks);
+        free(buffer);
+        free(bounds);
+        return false;
+    }
+
+    struct parallel_context ctx = { .items = items, .out = buffer, .e_size = vec->e_size, .order = order };
+    parallel_split(&ctx, 0, total, total_chunks, tasks);
+    for (size_t i = 0; i < total_chunks; i++) {
+        bounds[i] = tasks[i].first;
+    }
+    bounds[total_chunks] = total;
+    parallel_run(tasks, total_chunks, parallel_sort_job, js);
+
+    for (size_t width = 1; width < total_chunks; width *= 2) {
+        size_t total_tasks = 0;
+        for (size_t i = 0; i < total_chunks; i += 2 * width) {
+            struct parallel_task *task = &tasks[total_tasks++];
+            task->ctx = &ctx;
+            task->index = i;
+            task->first = bounds[i];
+            task->middle = bounds[(i + width < total_chunks) ? i + width : total_chunks];
+            task->last = bounds[(i + 2 * width < total_chunks) ? i + 2 * width : total_chunks];
+        }
+        parallel_run(tasks, total_tasks, parallel_merge_job, js);
+
+        char *swap = ctx.items;
+        ctx.items = ctx.out;
+        ctx.out = swap;
+    }
+
+    // An odd number of rounds leaves the sorted elements in the buffer
+    if (ctx.items != items) {
+        memcpy(items, ctx.items, total * vec->e_size);
+    }
+
+    free(tasks);
+    free(buffer);
+    free(bounds);
+    return true;
+}
@@ -1,8 +1,14 @@
 /*! Player implementation file */
 
 #include "headers/player.h"
+#include "headers/alloc.h"
+#include "headers/analytics.h"
+#include "headers/report.h"
+#include "headers/damage.h"
+#include "headers/trace.h"
+#include "headers/error.h"
 #include "third_party/pcg_basic.h"
-#include "headers/compatibility.h"
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -10,22 +16,158 @@
 /** Random state */
 pcg32_random_t pcg_state;
 
-bool player_initialize(const char *name, const unsigned int health, const struct vector *weapons, const struct armor *armor, struct player *p)
+static bool player_is_valid(const char *name, const unsigned int health, const struct vector *weapons, const struct armor *armor)
 {
-    if (!name || name[0] == '\0' || health == 0 || !weapons || !armor || !p) {
-        return false;
-    }
+    return name && name[0] != '\0' && health > 0 && weapons && armor;
+}
 
-    size_t name_length = strlen(name);
-    p->player_name = malloc(name_length + 1);
-    if (!p->player_name) {
+/**
+ * @brief Initializes a player that takes the weapons vector as is, validated by the caller.
+ */
+static bool player_initialize_with(const char *name, const unsigned int health, const struct vector *weapons, const struct armor *armor, struct player *p)
+{
+    if (!name_initialize(name, &p->player_name)) {
         return false;
     }
-    strcpy_s(p->player_name, name_length + 1, name);
+    if (!inventory_index_initialize(weapons, &p->_weapon_index)) {
+        name_deinitialize(&p->player_name);
+        return error_set(ERROR_OUT_OF_MEMORY, "player_initialize");
+    }
     p->health = health;
     p->_weapons = *weapons;
     p->current_armor = *armor;
     p->_isWearingArmor = true;
+    p->_owns_weapons = false;
+    p->_owns_armor = false;
+    p->_hits_taken = 0;
+
+    return true;
+}
+
+bool player_initialize(const char *name, const unsigned int health, const struct vector *weapons, const struct armor *armor, struct player *p)
+{
+    if (!player_is_valid(name, health, weapons, armor) || !p) {
+        return error_set(!name || !weapons || !armor || !p ? ERROR_NULL_ARGUMENT : ERROR_INVALID_ARGUMENT, "player_initialize");
+    }
+
+    // The player gets its own vector whatever its size, see vector.h, while the weapons in it stay the caller's
+    struct vector own = {0};
+    if (!vector_copy(weapons, &own)) {
+        return false;
+    }
+    if (!player_initialize_with(name, health, &own, armor, p)) {
+        vector_deinitialize(&own);
+        return false;
+    }
+
+    return true;
+}
+
+bool player_initialize_move(const char *name, const unsigned int health, struct vector *weapons, struct armor *armor, struct player *p)
+{
+    if (!player_is_valid(name, health, weapons, armor) || !p) {
+        return error_set(!name || !weapons || !armor || !p ? ERROR_NULL_ARGUMENT : ERROR_INVALID_ARGUMENT, "player_initialize_move");
+    }
+
+    if (!player_initialize_with(name, health, weapons, armor, p)) {
+        return false;
+    }
+    p->_owns_weapons = true;
+    p->_owns_armor = true;
+    memset(weapons, 0, sizeof(*weapons));
+    memset(armor, 0, sizeof(*armor));
+
+    return true;
+}
+
+bool player_copy(const struct player *src, struct player *dst)
+{
+    if (!src || !dst) {
+        return false;
+    }
+
+    // Everything is copied, so the copy owns all of it
+    struct player p = {0};
+    p._owns_weapons = true;
+    p._owns_armor = true;
+    if (!name_initialize(name_get(&src->player_name), &p.player_name)) {
+        return false;
+    }
+
+    bool ok = vector_initialize(src->_weapons.size ? src->_weapons.size : 1, sizeof(struct weapon), &p._weapons);
+    const struct weapon *weapons = vector_items(&src->_weapons);
+    for (size_t i = 0; ok && i < src->_weapons.size; i++) {
+        struct weapon w = weapons[i];
+        ok = name_initialize(name_get(&weapons[i].weapon_name), &w.weapon_name);
+        if (ok && !vector_push_back(&p._weapons, &w)) {
+            weapon_deinitialize(&w);
+            ok = false;
+        }
+    }
+    ok = ok && inventory_index_copy(&src->_weapon_index, &p._weapon_index);
+
+    p.current_armor = src->current_armor;
+    memset(&p.current_armor.armor_name, 0, sizeof(p.current_armor.armor_name));
+    ok = ok && name_initialize(name_get(&src->current_armor.armor_name), &p.current_armor.armor_name);
+    if (!ok) {
+        player_deinitialize(&p);
+        return false;
+    }
+    p.health = src->health;
+    p._isWearingArmor = src->_isWearingArmor;
+    p._hits_taken = src->_hits_taken;
+    *dst = p;
+
+    return true;
+}
+
+bool player_batch_initialize(const struct player_spec *specs, const size_t total, struct player_batch *batch)
+{
+    if (!specs || total == 0 || total > SIZE_MAX / sizeof(struct player) || !batch) {
+        return error_set(!specs || !batch ? ERROR_NULL_ARGUMENT : ERROR_INVALID_ARGUMENT, "player_batch_initialize");
+    }
+
+    memset(batch, 0, sizeof(*batch));
+    size_t names_size = 0;
+    size_t indexes_size = 0;
+    for (size_t i = 0; i < total; i++) {
+        if (!player_is_valid(specs[i].name, specs[i].health, specs[i].weapons, specs[i].armor)) {
+            return error_set(ERROR_INVALID_ARGUMENT, "player_batch_initialize");
+        }
+        names_size += name_external_size(specs[i].name);
+        indexes_size += inventory_index_storage_size(specs[i].weapons->size);
+    }
+
+    batch->players = alloc_malloc(total * sizeof(*batch->players), ALLOC_TAG_PLAYER);
+    batch->names = names_size ? alloc_malloc(names_size, ALLOC_TAG_PLAYER) : NULL;
+    batch->indexes = alloc_malloc(indexes_size, ALLOC_TAG_PLAYER);
+    if (!batch->players || (names_size && !batch->names) || !batch->indexes) {
+        player_batch_deinitialize(batch);
+        return error_set(ERROR_OUT_OF_MEMORY, "player_batch_initialize");
+    }
+
+    char *name_storage = batch->names;
+    char *index_storage = batch->indexes;
+    for (size_t i = 0; i < total; i++) {
+        struct player *p = &batch->players[i];
+        // Like player_initialize(), each player gets its own vector, only allocated if it does not fit inline
+        if (!vector_copy(specs[i].weapons, &p->_weapons)) {
+            batch->size = i;
+            player_batch_deinitialize(batch);
+            return false;
+        }
+        name_initialize_in(specs[i].name, name_storage, &p->player_name);
+        name_storage += name_external_size(specs[i].name);
+        inventory_index_initialize_in(specs[i].weapons, index_storage, &p->_weapon_index);
+        index_storage += inventory_index_storage_size(specs[i].weapons->size);
+        p->health = specs[i].health;
+        p->current_armor = *specs[i].armor;
+        p->_isWearingArmor = true;
+        p->_owns_weapons = false;
+        p->_owns_armor = false;
+        p->_hits_taken = 0;
+    }
+    batch->size = total;
 
     return true;
 }
@@ -54,15 +196,12 @@ void player_get_stats(const struct player *p)
         return;
     }
 
-    printf("----GETTING STATS FOR %s----\n", p->player_name);
-    printf("Health: %u", p->health);
-    struct weapon w = {0};
-    for (unsigned int i = 0; i <= p->_weapons.size; i++) {
-        vector_get_element(&p->_weapons, i, &w);
-        printf("%s:%u", w.weapon_name, w.weapon_damage);
+    struct report r = {0};
+    if (!report_initialize(REPORT_FORMAT_HUMAN, 512, stdout, &r)) {
+        return;
     }
-    printf("Total weapon size: %zu\n", p->_weapons.size);
-    printf("----STATS END----\n");
+    report_write_player(&r, p);
+    report_deinitialize(&r);
 }
 
 void player_update_weapons(const char *type, const struct weapon *w, struct player *p)
@@ -72,46 +211,175 @@ void player_update_weapons(const char *type, const struct weapon *w, struct play
     }
 
     if (strcmp(type, "add") == 0) {
-        vector_push_back(&p->_weapons, w);
+        player_add_weapon(w, p);
         return;
     }
 
     if (strcmp(type, "remove") == 0) {
-        vector_pop_search(&p->_weapons, w);
+        player_remove_weapon(w, p);
         return;
     }
 }
 
+bool player_add_weapon(const struct weapon *w, struct player *p)
+{
+    if (!w || !p) {
+        return error_set(ERROR_NULL_ARGUMENT, "player_add_weapon");
+    }
+
+    if (!inventory_index_reserve(p->_weapons.size + 1, &p->_weapon_index)) {
+        return error_set(ERROR_OUT_OF_MEMORY, "player_add_weapon");
+    }
+    if (!vector_push_back(&p->_weapons, w)) {
+        return false;
+    }
+    inventory_index_push_back(&p->_weapons, &p->_weapon_index);
+
+    return true;
+}
+
+bool player_remove_weapon(const struct weapon *w, struct player *p)
+{
+    if (!w || !p) {
+        return error_set(ERROR_NULL_ARGUMENT, "player_remove_weapon");
+    }
+
+    for (size_t i = 0; i < p->_weapons.size; i++) {
+        if (memcmp((const struct weapon *)vector_items(&p->_weapons) + i, w, sizeof(*w)) == 0) {
+            struct weapon removed = {0};
+            inventory_index_remove(i, &p->_weapon_index);
+            return vector_pop_index(&p->_weapons, i, &removed);
+        }
+    }
+
+    return error_set(ERROR_NOT_FOUND, "player_remove_weapon");
+}
+
 /**
- * @brief Used to determine critical damage. Gets a random value from 1 to 4 and applying critical damage if the value is 1.
+ * @brief Finds one of the player's weapons in place.
  * 
- * @param[in] weapon_damage Base weapon damage.
- * @param[in] armor_resistance Armor resistance, used for decreasing the total damage.
- * @return damage/resistance * 1.5 or damage/resistance.
+ * @param[in] weapon_name Name of the weapon.
+ * @param[in] p Pointer to player struct.
+ * @param[out] position Position of the weapon in the player's weapons.
+ * @return Pointer to the weapon, NULL if the player does not own it, with error_last() telling why.
  */
-unsigned int crit(const unsigned int weapon_damage, const unsigned int armor_resistance)
+static struct weapon *player_find_weapon(const char *weapon_name, const struct player *p, size_t *position)
+{
+    if (!weapon_name || !p) {
+        error_set(ERROR_NULL_ARGUMENT, "player_find_weapon");
+        return NULL;
+    }
+
+    struct weapon *weapons = vector_items(&p->_weapons);
+    for (size_t i = 0; i < p->_weapons.size; i++) {
+        if (weapon_name_cmp(&weapons[i], weapon_name)) {
+            *position = i;
+            return &weapons[i];
+        }
+    }
+    error_set(ERROR_NOT_FOUND, "player_find_weapon");
+    return NULL;
+}
+
+bool player_enhance_weapon(const char *weapon_name, const unsigned int enhance_damage, struct player *p)
+{
+    size_t position = 0;
+    struct weapon *w = player_find_weapon(weapon_name, p, &position);
+    if (!w) {
+        return false;
+    }
+
+    weapon_enhance(enhance_damage, w);
+    inventory_index_update(&p->_weapons, position, &p->_weapon_index);
+    return true;
+}
+
+bool player_repair_weapon(const char *weapon_name, const unsigned int repair_health, struct player *p)
+{
+    size_t position = 0;
+    struct weapon *w = player_find_weapon(weapon_name, p, &position);
+    if (!w) {
+        return false;
+    }
+
+    weapon_repair(repair_health, w);
+    inventory_index_update(&p->_weapons, position, &p->_weapon_index);
+    return true;
+}
+
+const struct weapon *player_get_strongest_weapon(const struct player *p)
 {
-    if (weapon_damage == 0 || armor_resistance == 0) {
-        return 0;
+    size_t position = 0;
+    if (!p || !inventory_index_strongest(&p->_weapon_index, &position)) {
+        return NULL;
     }
-    const unsigned int rrand_num = pcg32_random_r(&pcg_state);
-    const unsigned int rand_num = (unsigned int) (rrand_num % (4 - 1 + 1)) + 1;
-    return (rand_num == 1)
-    ? (unsigned int)((weapon_damage / armor_resistance) * 1.5)
-    : (weapon_damage / armor_resistance);
+
+    return (const struct weapon *)vector_items(&p->_weapons) + position;
+}
+
+const struct weapon *player_get_most_durable_weapon(const struct player *p)
+{
+    size_t position = 0;
+    if (!p || !inventory_index_most_durable(&p->_weapon_index, &position)) {
+        return NULL;
+    }
+
+    return (const struct weapon *)vector_items(&p->_weapons) + position;
+}
+
+const struct weapon *player_get_best_weapon_against(const unsigned int armor_resistance, const struct player *p)
+{
+    size_t position = 0;
+    if (!p || !inventory_index_best_against(&p->_weapon_index, armor_resistance, &position)) {
+        return NULL;
+    }
+
+    return (const struct weapon *)vector_items(&p->_weapons) + position;
+}
+
+unsigned int crit(const unsigned int weapon_damage, const unsigned int armor_resistance, pcg32_random_t *rng)
+{
+    TRACE_INSTANT("crit roll");
+    return damage_roll(weapon_damage, armor_resistance, rng);
 }
 
 void player_attack(struct player *attacker, const char *weapon_name, struct player *target)
 {
-    struct weapon w = {0};
-    if (!attacker || !weapon_name || weapon_name[0] == '\0' || !target || target->health == 0 
-        || !vector_search_element(&attacker->_weapons, weapon_name, &w, weapon_name_cmp)) {
+    player_attack_r(attacker, weapon_name, target, &pcg_state);
+}
+
+void player_attack_r(struct player *attacker, const char *weapon_name, struct player *target, pcg32_random_t *rng)
+{
+    size_t position = 0;
+    if (!player_find_weapon(weapon_name, attacker, &position)) {
         return;
     }
 
-    const unsigned int damage = crit(w.weapon_damage, target->current_armor._armor_resistance_force);
+    player_attack_at_r(attacker, position, target, rng);
+}
+
+void player_attack_at_r(struct player *attacker, const size_t position, struct player *target, pcg32_random_t *rng)
+{
+    if (!attacker || position >= attacker->_weapons.size) {
+        return;
+    }
+    struct weapon *w = (struct weapon *)vector_items(&attacker->_weapons) + position;
+    if (w->weapon_health == 0 || !target || target->health == 0 || !rng) {
+        return;
+    }
+
+    TRACE_BEGIN("attack");
+    const unsigned int damage = crit(w->weapon_damage, target->current_armor._armor_resistance_force, rng);
     target->health = (target->health > damage) ? target->health - damage : 0;
-    weapon_use(damage / 10, &w);
+    target->_hits_taken++;
+    if (analytics_is_enabled()) {
+        analytics_record_attack(name_get(&w->weapon_name), target->_isWearingArmor ? name_get(&target->current_armor.armor_name) : NULL,
+                                w->weapon_damage, damage_mitigate(w->weapon_damage, target->current_armor._armor_resistance_force),
+                                damage, target->health == 0 ? target->_hits_taken : 0);
+    }
+    weapon_use(damage / 10, w);
+    inventory_index_update(&attacker->_weapons, position, &attacker->_weapon_index);
+    TRACE_END("attack");
 }
 
 void player_heal(const unsigned int amount, struct player *p)
@@ -123,6 +391,48 @@ void player_heal(const unsigned int amount, struct player *p)
     p->health += amount;
 }
 
+void player_take_damage(const unsigned int amount, struct player *p)
+{
+    if (amount == 0 || !p) {
+        return;
+    }
+
+    p->health = (p->health > amount) ? p->health - amount : 0;
+}
+
+bool player_wear_weapon(const char *weapon_name, const unsigned int amount, struct player *p)
+{
+    size_t position = 0;
+    if (!player_find_weapon(weapon_name, p, &position)) {
+        return false;
+    }
+
+    return player_wear_weapon_at(position, amount, p);
+}
+
+bool player_wear_weapon_at(const size_t position, const unsigned int amount, struct player *p)
+{
+    if (!p) {
+        return error_set(ERROR_NULL_ARGUMENT, "player_wear_weapon_at");
+    }
+    if (position >= p->_weapons.size) {
+        return error_set(ERROR_OUT_OF_RANGE, "player_wear_weapon_at");
+    }
+
+    weapon_use(amount, (struct weapon *)vector_items(&p->_weapons) + position);
+    inventory_index_update(&p->_weapons, position, &p->_weapon_index);
+    return true;
+}
+
+void player_wear_armor(const unsigned int amount, struct player *p)
+{
+    if (!p || !p->_isWearingArmor) {
+        return;
+    }
+
+    armor_wear_armor(amount, &p->current_armor);
+}
+
 void player_equip_armor(const struct armor *a, struct player *p)
 {
     if (!a || !p || p->_isWearingArmor) {
@@ -133,53 +443,101 @@ void player_equip_armor(const struct armor *a, struct player *p)
     p->_isWearingArmor = true;
 }
 
+bool player_equip_armor_move(struct armor *a, struct player *p)
+{
+    if (!a || !p || p->_isWearingArmor) {
+        return false;
+    }
+
+    if (p->_owns_armor) {
+        armor_deinitialize(&p->current_armor);
+    }
+    p->current_armor = *a;
+    p->_isWearingArmor = true;
+    p->_owns_armor = true;
+    memset(a, 0, sizeof(*a));
+
+    return true;
+}
+
 void player_add_player(const struct player *p1, const struct player *p2, struct player *add_player)
 {
     if (!p1 || !p2 || !add_player) {
         return;
     }
 
-    size_t total_size = strlen(p1->player_name) + 1 + strlen(p2->player_name) + 1;
-    add_player->player_name = malloc(total_size);
-    if (!add_player->player_name) {
+    // Weapons and armor are copied with their own names, so the merged player owns all of it
+    struct player p = {0};
+    p._owns_weapons = true;
+    p._owns_armor = true;
+    if (!name_join(name_get(&p1->player_name), ':', name_get(&p2->player_name), &p.player_name)) {
         return;
     }
-    strcpy_s(add_player->player_name, total_size,  p1->player_name);
-    strcat_s(add_player->player_name, total_size, ":");
-    strcat_s(add_player->player_name, total_size, p2->player_name);
-    add_player->health = p1->health + p2->health;
+    p.health = p1->health + p2->health;
 
     const size_t bigger_size = (p1->_weapons.size > p2->_weapons.size) ? p1->_weapons.size : p2->_weapons.size;
-    struct vector new_weapons = {0};
-    vector_initialize(bigger_size * 2, sizeof(struct weapon), &new_weapons);
-
-    struct weapon temp_1 = {0};
-    struct weapon temp_2 = {0};
-
-    for (size_t i = 0; i < bigger_size; i++) {
-        if (i < p1->_weapons.size) {
-            vector_get_element(&p1->_weapons, i, &temp_1);
-            vector_push_back(&new_weapons, &temp_1);
+    bool ok = vector_initialize(bigger_size ? bigger_size * 2 : 1, sizeof(struct weapon), &p._weapons);
+    // Weapons alternate between the two players, as long as each has some left
+    for (size_t i = 0; ok && i < bigger_size * 2; i++) {
+        const struct vector *from = (i % 2 == 0) ? &p1->_weapons : &p2->_weapons;
+        if (i / 2 >= from->size) {
+            continue;
         }
-        if (i < p2->_weapons.size) {
-            vector_get_element(&p2->_weapons, i, &temp_2);
-            vector_push_back(&new_weapons, &temp_2);
+        const struct weapon *src = (const struct weapon *)vector_items(from) + i / 2;
+        struct weapon w = *src;
+        ok = name_initialize(name_get(&src->weapon_name), &w.weapon_name);
+        if (ok && !vector_push_back(&p._weapons, &w)) {
+            weapon_deinitialize(&w);
+            ok = false;
         }
     }
+    ok = ok && inventory_index_initialize(&p._weapons, &p._weapon_index);
 
-    armor_add_armor(&p1->current_armor, &p2->current_armor, &add_player->current_armor);
-    add_player->_isWearingArmor = true;
+    armor_add_armor(&p1->current_armor, &p2->current_armor, &p.current_armor);
+    if (!ok || name_is_empty(&p.current_armor.armor_name)) {
+        player_deinitialize(&p);
+        return;
+    }
+    p._isWearingArmor = true;
+    *add_player = p;
 }
 
 void player_deinitialize(struct player *p)
 {
-    if (!p || !p->player_name) {
+    if (!p || name_is_empty(&p->player_name)) {
         return;
     }
 
-    free(p->player_name);
-    p->player_name = NULL;
+    name_deinitialize(&p->player_name);
+    inventory_index_deinitialize(&p->_weapon_index);
+    if (p->_owns_weapons) {
+        struct weapon *weapons = vector_items(&p->_weapons);
+        for (size_t i = 0; i < p->_weapons.size; i++) {
+            weapon_deinitialize(&weapons[i]);
+        }
+    }
+    vector_deinitialize(&p->_weapons);
+    if (p->_owns_armor) {
+        armor_deinitialize(&p->current_armor);
+    }
     p->health = 0;
     p->_isWearingArmor = false;
     memset(p, 0, sizeof(*p));
+}
+
+void player_batch_deinitialize(struct player_batch *batch)
+{
+    if (!batch) {
+        return;
+    }
+
+    // Indexes that outgrew the batch storage moved to the heap
+    for (size_t i = 0; i < batch->size; i++) {
+        inventory_index_deinitialize(&batch->players[i]._weapon_index);
+        vector_deinitialize(&batch->players[i]._weapons);
+    }
+    alloc_free(batch->players);
+    alloc_free(batch->names);
+    alloc_free(batch->indexes);
+    memset(batch, 0, sizeof(*batch));
 }
\ No newline at end of file
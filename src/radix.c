@@ -0,0 +1,437 @@
+/*! Radix tree implementation file */
+
+#include "headers/radix.h"
+#include "headers/alloc.h"
+#include "headers/weapon.h"
+#include <limits.h>
+#include <string.h>
+
+/**
+ * @struct radix_search
+ * @brief State of radix_tree_find_closest().
+ */
+struct radix_search {
+    /** Tree searched. */
+    const struct radix_tree *t;
+    /** String to match. */
+    const char *key;
+    /** Length of the string. */
+    size_t key_length;
+    /** Edit distance rows, one per depth, key_length + 1 entries each. */
+    unsigned int *rows;
+    /** Distance keys must beat, one more than the largest accepted at first. */
+    unsigned int best;
+    /** Value of the best key so far. */
+    size_t value;
+    /** Set once a key beat the initial bound. */
+    bool found;
+};
+
+static struct radix_node *radix_node_at(const struct radix_tree *t, const uint32_t index)
+{
+    return (struct radix_node *)vector_items(&t->nodes) + index;
+}
+
+static const char *radix_label(const struct radix_tree *t, const struct radix_node *n)
+{
+    return (const char *)vector_items(&t->labels) + n->label_offset;
+}
+
+/**
+ * @brief Finds the child of a node whose label starts with a character.
+ *
+ * @param[out] prev Last child starting with a smaller character, 0 if none, may be NULL.
+ * @return Index of the child, 0 if none.
+ */
+static uint32_t radix_child(const struct radix_tree *t, const uint32_t node, const char c, uint32_t *prev)
+{
+    uint32_t last = 0;
+    for (uint32_t i = radix_node_at(t, node)->first_child; i != 0; i = radix_node_at(t, i)->next_sibling) {
+        const unsigned char first = (unsigned char)radix_label(t, radix_node_at(t, i))[0];
+        if (first == (unsigned char)c) {
+            return i;
+        }
+        if (first > (unsigned char)c) {
+            break;
+        }
+        last = i;
+    }
+    if (prev) {
+        *prev = last;
+    }
+
+    return 0;
+}
+
+static bool radix_new_node(const uint32_t label_offset, const uint32_t label_length, struct radix_tree *t, uint32_t *index)
+{
+    if (t->nodes.size >= UINT32_MAX) {
+        return false;
+    }
+
+    const struct radix_node n = { .label_offset = label_offset, .label_length = label_length };
+    if (!vector_push_back(&t->nodes, &n)) {
+        return false;
+    }
+    *index = (uint32_t)(t->nodes.size - 1);
+
+    return true;
+}
+
+static bool radix_append_label(const char *str, const size_t length, struct radix_tree *t, uint32_t *offset)
+{
+    if (length > UINT32_MAX - t->labels.size || !vector_reserve(&t->labels, t->labels.size + length)) {
+        return false;
+    }
+
+    memcpy((char *)vector_items(&t->labels) + t->labels.size, str, length);
+    *offset = (uint32_t)t->labels.size;
+    t->labels.size += length;
+
+    return true;
+}
+
+/**
+ * @brief Links a node as the child of parent right after prev, or first if prev is 0.
+ */
+static void radix_link(const uint32_t parent, const uint32_t prev, const uint32_t child, struct radix_tree *t)
+{
+    struct radix_node *c = radix_node_at(t, child);
+    if (prev == 0) {
+        struct radix_node *p = radix_node_at(t, parent);
+        c->next_sibling = p->first_child;
+        p->first_child = child;
+        return;
+    }
+
+    struct radix_node *before = radix_node_at(t, prev);
+    c->next_sibling = before->next_sibling;
+    before->next_sibling = child;
+}
+
+/**
+ * @brief Splits the edge of a node after length characters, moving the rest and everything below to a new child.
+ */
+static bool radix_split(const uint32_t node, const uint32_t length, struct radix_tree *t)
+{
+    const struct radix_node *n = radix_node_at(t, node);
+    uint32_t rest = 0;
+    if (!radix_new_node(n->label_offset + length, n->label_length - length, t, &rest)) {
+        return false;
+    }
+
+    // The push may have moved the nodes
+    struct radix_node *top = radix_node_at(t, node);
+    struct radix_node *bottom = radix_node_at(t, rest);
+    bottom->first_child = top->first_child;
+    bottom->value = top->value;
+    bottom->terminal = top->terminal;
+    top->label_length = length;
+    top->first_child = rest;
+    top->value = 0;
+    top->terminal = false;
+
+    return true;
+}
+
+/**
+ * @brief Walks the tree along a key.
+ *
+ * @param[in] prefix Whether the key may end inside an edge, which then gives the node below it.
+ * @param[out] index Node the key ends at.
+ * @return true if the tree has the key, or a key starting with it if prefix, false otherwise.
+ */
+static bool radix_walk(const char *key, const bool prefix, const struct radix_tree *t, uint32_t *index)
+{
+    const size_t length = strlen(key);
+    size_t pos = 0;
+    uint32_t node = 0;
+    while (pos < length) {
+        const uint32_t child = radix_child(t, node, key[pos], NULL);
+        if (child == 0) {
+            return false;
+        }
+
+        const struct radix_node *c = radix_node_at(t, child);
+        const char *label = radix_label(t, c);
+        const size_t remaining = length - pos;
+        if (remaining < c->label_length) {
+            if (!prefix || memcmp(label, key + pos, remaining) != 0) {
+                return false;
+            }
+            *index = child;
+            return true;
+        }
+        if (memcmp(label, key + pos, c->label_length) != 0) {
+            return false;
+        }
+        pos += c->label_length;
+        node = child;
+    }
+    *index = node;
+
+    return true;
+}
+
+bool radix_tree_initialize(struct radix_tree *t)
+{
+    if (!t) {
+        return false;
+    }
+
+    memset(t, 0, sizeof(*t));
+    uint32_t root = 0;
+    if (!vector_initialize(1, sizeof(struct radix_node), &t->nodes) ||
+        !vector_initialize(1, sizeof(char), &t->labels) ||
+        !radix_new_node(0, 0, t, &root)) {
+        vector_deinitialize(&t->nodes);
+        vector_deinitialize(&t->labels);
+        return false;
+    }
+
+    return true;
+}
+
+bool radix_tree_insert(const char *key, const size_t value, struct radix_tree *t)
+{
+    if (!key || key[0] == '\0' || !t || t->nodes.size == 0) {
+        return false;
+    }
+
+    const size_t length = strlen(key);
+    size_t pos = 0;
+    uint32_t node = 0;
+    while (pos < length) {
+        uint32_t prev = 0;
+        const uint32_t child = radix_child(t, node, key[pos], &prev);
+        if (child == 0) {
+            // Nothing shares the rest of the key, it becomes one leaf
+            uint32_t offset = 0;
+            uint32_t leaf = 0;
+            if (length - pos > UINT32_MAX ||
+                !radix_append_label(key + pos, length - pos, t, &offset) ||
+                !radix_new_node(offset, (uint32_t)(length - pos), t, &leaf)) {
+                return false;
+            }
+            radix_link(node, prev, leaf, t);
+            node = leaf;
+            break;
+        }
+
+        const struct radix_node *c = radix_node_at(t, child);
+        const char *label = radix_label(t, c);
+        uint32_t common = 0;
+        while (common < c->label_length && pos + common < length && label[common] == key[pos + common]) {
+            common++;
+        }
+        if (common < c->label_length && !radix_split(child, common, t)) {
+            return false;
+        }
+        node = child;
+        pos += common;
+    }
+
+    struct radix_node *n = radix_node_at(t, node);
+    if (!n->terminal) {
+        n->terminal = true;
+        n->value = value;
+        t->size++;
+        if (length > t->longest) {
+            t->longest = length;
+        }
+    }
+
+    return true;
+}
+
+bool radix_tree_insert_weapons(const struct vector *weapons, struct radix_tree *t)
+{
+    if (!weapons || !t) {
+        return false;
+    }
+
+    const struct weapon *w = vector_items(weapons);
+    for (size_t i = 0; i < weapons->size; i++) {
+        if (!name_is_empty(&w[i].weapon_name) && !radix_tree_insert(name_get(&w[i].weapon_name), i, t)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool radix_tree_remove(const char *key, struct radix_tree *t)
+{
+    uint32_t node = 0;
+    if (!key || key[0] == '\0' || !t || t->nodes.size == 0 || !radix_walk(key, false, t, &node)) {
+        return false;
+    }
+
+    struct radix_node *n = radix_node_at(t, node);
+    if (!n->terminal) {
+        return false;
+    }
+    n->terminal = false;
+    t->size--;
+
+    return true;
+}
+
+void radix_tree_clear(struct radix_tree *t)
+{
+    if (!t || t->nodes.size == 0) {
+        return;
+    }
+
+    memset(radix_node_at(t, 0), 0, sizeof(struct radix_node));
+    t->nodes.size = 1;
+    t->labels.size = 0;
+    t->size = 0;
+    t->longest = 0;
+}
+
+bool radix_tree_find(const char *key, const struct radix_tree *t, size_t *value)
+{
+    uint32_t node = 0;
+    if (!key || !t || t->nodes.size == 0 || !radix_walk(key, false, t, &node)) {
+        return false;
+    }
+
+    const struct radix_node *n = radix_node_at(t, node);
+    if (!n->terminal) {
+        return false;
+    }
+    if (value) {
+        *value = n->value;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Writes the values below a node, the node first and then its children in order.
+ */
+static void radix_collect(const struct radix_tree *t, const uint32_t node, const size_t max, size_t *values, size_t *count)
+{
+    const struct radix_node *n = radix_node_at(t, node);
+    if (n->terminal && *count < max) {
+        values[(*count)++] = n->value;
+    }
+    for (uint32_t i = n->first_child; i != 0 && *count < max; i = radix_node_at(t, i)->next_sibling) {
+        radix_collect(t, i, max, values, count);
+    }
+}
+
+size_t radix_tree_complete(const char *prefix, const size_t max, const struct radix_tree *t, size_t *values)
+{
+    uint32_t node = 0;
+    if (!prefix || max == 0 || !t || t->nodes.size == 0 || !values || !radix_walk(prefix, true, t, &node)) {
+        return 0;
+    }
+
+    size_t count = 0;
+    radix_collect(t, node, max, values, &count);
+
+    return count;
+}
+
+/**
+ * @brief Walks the children of a node, extending the edit distance rows one character at a time.
+ */
+static void radix_closest_walk(struct radix_search *s, const uint32_t node, const size_t depth)
+{
+    const size_t width = s->key_length + 1;
+    for (uint32_t i = radix_node_at(s->t, node)->first_child; i != 0; i = radix_node_at(s->t, i)->next_sibling) {
+        const struct radix_node *c = radix_node_at(s->t, i);
+        const char *label = radix_label(s->t, c);
+        size_t d = depth;
+        bool hopeless = false;
+        for (uint32_t k = 0; k < c->label_length && !hopeless; k++, d++) {
+            const unsigned int *above = s->rows + d * width;
+            unsigned int *row = s->rows + (d + 1) * width;
+            row[0] = (unsigned int)(d + 1);
+            unsigned int smallest = row[0];
+            for (size_t j = 1; j < width; j++) {
+                const unsigned int substitute = above[j - 1] + (s->key[j - 1] != label[k]);
+                const unsigned int remove = above[j] + 1;
+                const unsigned int insert = row[j - 1] + 1;
+                unsigned int cost = substitute < remove ? substitute : remove;
+                cost = insert < cost ? insert : cost;
+                row[j] = cost;
+                smallest = cost < smallest ? cost : smallest;
+            }
+            // Every key below is at least this far
+            hopeless = smallest >= s->best;
+        }
+        if (hopeless) {
+            continue;
+        }
+
+        const unsigned int distance = s->rows[d * width + s->key_length];
+        if (c->terminal && distance < s->best) {
+            s->best = distance;
+            s->value = c->value;
+            s->found = true;
+        }
+        radix_closest_walk(s, i, d);
+    }
+}
+
+bool radix_tree_find_closest(const char *key, const unsigned int max_distance, const struct radix_tree *t, size_t *value, unsigned int *distance)
+{
+    if (!key || !t || t->nodes.size == 0 || !value) {
+        return false;
+    }
+
+    if (radix_tree_find(key, t, value)) {
+        if (distance) {
+            *distance = 0;
+        }
+        return true;
+    }
+
+    const size_t width = strlen(key) + 1;
+    if (t->longest >= SIZE_MAX / width || (t->longest + 1) * width > SIZE_MAX / sizeof(unsigned int)) {
+        return false;
+    }
+    unsigned int *rows = alloc_malloc((t->longest + 1) * width * sizeof(unsigned int), ALLOC_TAG_VECTOR);
+    if (!rows) {
+        return false;
+    }
+    for (size_t j = 0; j < width; j++) {
+        rows[j] = (unsigned int)j;
+    }
+
+    struct radix_search s = {
+        .t = t,
+        .key = key,
+        .key_length = width - 1,
+        .rows = rows,
+        .best = max_distance < UINT_MAX ? max_distance + 1 : max_distance,
+        .value = 0,
+        .found = false
+    };
+    radix_closest_walk(&s, 0, 0);
+    alloc_free(rows);
+
+    if (!s.found) {
+        return false;
+    }
+    *value = s.value;
+    if (distance) {
+        *distance = s.best;
+    }
+
+    return true;
+}
+
+void radix_tree_deinitialize(struct radix_tree *t)
+{
+    if (!t) {
+        return;
+    }
+
+    vector_deinitialize(&t->nodes);
+    vector_deinitialize(&t->labels);
+    memset(t, 0, sizeof(*t));
+}
@@ -0,0 +1,245 @@
+/*! Raid implementation file */
+
+#include "headers/raid.h"
+#include "headers/analytics.h"
+#include "headers/damage.h"
+#include "headers/parallel.h"
+#include "headers/trace.h"
+#include <stdint.h>
+#include <string.h>
+
+/** Spreads the ticks over the seed space, so consecutive ticks get unrelated streams. */
+#define RAID_TICK_MIX UINT64_C(0x9E3779B97F4A7C15)
+
+/**
+ * @struct raid_context
+ * @brief What the jobs of a tick share.
+ */
+struct raid_context {
+    /** First attacker, to turn element pointers into positions. */
+    struct player *attackers;
+    /** Hits of the tick, one per attacker. */
+    const struct raid_hit *hits;
+    /** Boss attacked. */
+    const struct player *boss;
+    /** Initial state of the attackers' random streams this tick. */
+    uint64_t stream_seed;
+    /** Health of the boss before the tick. */
+    uint64_t health;
+    /** Position of the killer, or the number of attackers if the boss survives. */
+    size_t killer;
+    /** Hits the boss takes this tick. */
+    size_t hits_landed;
+};
+
+/**
+ * @struct raid_sum
+ * @brief Partial sum of a chunk of hits, and the total once combined.
+ */
+struct raid_sum {
+    /** Damage dealt. */
+    uint64_t damage;
+    /** Attacks made. */
+    size_t hits;
+    /** First hit of the chunk, SIZE_MAX if none was folded. */
+    size_t first;
+    /** One past the last hit of the chunk. */
+    size_t last;
+    /** Set in the total once a chunk brought the damage to the boss health. */
+    bool crossed;
+    /** Chunk holding the killing blow. */
+    size_t cross_first;
+    /** End of the chunk holding the killing blow. */
+    size_t cross_last;
+    /** Damage before that chunk. */
+    uint64_t damage_before;
+    /** Attacks before that chunk. */
+    size_t hits_before;
+};
+
+/**
+ * @brief Rolls the hit of one attacker on its own random stream.
+ */
+static void raid_roll(const void *element, void *out, void *arg)
+{
+    const struct player *attacker = element;
+    const struct raid_context *ctx = arg;
+    struct raid_hit *hit = out;
+    const unsigned int resistance = ctx->boss->current_armor._armor_resistance_force;
+
+    memset(hit, 0, sizeof(*hit));
+    const struct weapon *w = player_get_best_weapon_against(resistance, attacker);
+    if (!w) {
+        return;
+    }
+
+    pcg32_random_t rng = {0};
+    pcg32_srandom_r(&rng, ctx->stream_seed, (uint64_t)(attacker - ctx->attackers));
+    hit->weapon = (size_t)(w - (const struct weapon *)vector_items(&attacker->_weapons));
+    hit->normal_damage = damage_mitigate(w->weapon_damage, resistance);
+    hit->damage = damage_roll(w->weapon_damage, resistance, &rng);
+    hit->attacked = true;
+}
+
+static void raid_fold(void *partial, const void *element, void *arg)
+{
+    const struct raid_context *ctx = arg;
+    const struct raid_hit *hit = element;
+    struct raid_sum *sum = partial;
+    const size_t position = (size_t)(hit - ctx->hits);
+
+    if (sum->first == SIZE_MAX) {
+        sum->first = position;
+    }
+    sum->last = position + 1;
+    if (hit->attacked) {
+        sum->damage += hit->damage;
+        sum->hits++;
+    }
+}
+
+/**
+ * @brief Adds the next chunk to the total, noting the chunk where the damage reaches the boss health.
+ */
+static void raid_combine(void *result, const void *partial, void *arg)
+{
+    const struct raid_context *ctx = arg;
+    const struct raid_sum *chunk = partial;
+    struct raid_sum *total = result;
+
+    if (!total->crossed && chunk->first != SIZE_MAX && total->damage + chunk->damage >= ctx->health) {
+        total->crossed = true;
+        total->cross_first = chunk->first;
+        total->cross_last = chunk->last;
+        total->damage_before = total->damage;
+        total->hits_before = total->hits;
+    }
+    total->damage += chunk->damage;
+    total->hits += chunk->hits;
+}
+
+/**
+ * @brief Wears the weapon of one attacker that hit the boss, as player_attack_r() would.
+ *
+ * Walks the hits rather than the attackers, so attackers whose weapon does not wear are never touched.
+ */
+static void raid_wear(void *element, void *arg)
+{
+    const struct raid_hit *hit = element;
+    const struct raid_context *ctx = arg;
+    const size_t position = (size_t)(hit - ctx->hits);
+    if (!hit->attacked || (hit->damage / 10 == 0 && !analytics_is_enabled())) {
+        return;
+    }
+
+    struct player *attacker = &ctx->attackers[position];
+    const struct weapon *w = (const struct weapon *)vector_items(&attacker->_weapons) + hit->weapon;
+    if (analytics_is_enabled()) {
+        const struct player *boss = ctx->boss;
+        analytics_record_attack(name_get(&w->weapon_name), boss->_isWearingArmor ? name_get(&boss->current_armor.armor_name) : NULL,
+                                w->weapon_damage, hit->normal_damage, hit->damage,
+                                position == ctx->killer ? boss->_hits_taken + (unsigned int)ctx->hits_landed : 0);
+    }
+    // By position, a name could pick another weapon with the same name
+    if (hit->damage / 10 > 0) {
+        player_wear_weapon_at(hit->weapon, hit->damage / 10, attacker);
+    }
+}
+
+bool raid_initialize(const uint64_t seed, struct job_system *js, struct raid *r)
+{
+    if (!r) {
+        return false;
+    }
+
+    if (!vector_initialize(1, sizeof(struct raid_hit), &r->hits)) {
+        return false;
+    }
+    r->js = js;
+    r->seed = seed;
+    r->tick = 0;
+
+    return true;
+}
+
+bool raid_tick(struct vector *attackers, struct player *boss, struct raid *r, struct raid_result *result)
+{
+    if (!attackers || attackers->e_size != sizeof(struct player) || !boss || !r || !result) {
+        return false;
+    }
+
+    memset(result, 0, sizeof(*result));
+    // Serial attacks on a dead boss all return early, nothing happens
+    if (boss->health == 0 || attackers->size == 0) {
+        r->tick++;
+        return true;
+    }
+
+    TRACE_BEGIN("raid tick");
+    struct raid_context ctx = {
+        .attackers = vector_items(attackers),
+        .boss = boss,
+        .stream_seed = r->seed ^ ((r->tick + 1) * RAID_TICK_MIX),
+        .health = boss->health,
+        .killer = attackers->size
+    };
+    if (!parallel_transform(attackers, 0, attackers->size, raid_roll, &ctx, r->js, &r->hits)) {
+        TRACE_END("raid tick");
+        return false;
+    }
+    ctx.hits = vector_items(&r->hits);
+
+    const struct raid_sum identity = { .first = SIZE_MAX };
+    struct raid_sum total = {0};
+    if (!parallel_reduce(&r->hits, 0, r->hits.size, &identity, sizeof(identity), raid_fold, raid_combine, &ctx, r->js, &total)) {
+        TRACE_END("raid tick");
+        return false;
+    }
+
+    // Only the chunk holding the killing blow is walked again, hits after it never land
+    result->damage = total.damage;
+    result->hits = total.hits;
+    if (total.crossed) {
+        uint64_t damage = total.damage_before;
+        size_t hits = total.hits_before;
+        for (size_t i = total.cross_first; i < total.cross_last; i++) {
+            if (!ctx.hits[i].attacked) {
+                continue;
+            }
+            damage += ctx.hits[i].damage;
+            hits++;
+            if (damage >= ctx.health) {
+                ctx.killer = i;
+                break;
+            }
+        }
+        result->damage = damage;
+        result->hits = hits;
+        result->killed = true;
+        result->killer = ctx.killer;
+    }
+    ctx.hits_landed = result->hits;
+
+    const size_t end = result->killed ? result->killer + 1 : attackers->size;
+    if (!parallel_for_each(&r->hits, 0, end, raid_wear, &ctx, r->js)) {
+        TRACE_END("raid tick");
+        return false;
+    }
+
+    boss->health = result->killed ? 0 : boss->health - (unsigned int)result->damage;
+    boss->_hits_taken += (unsigned int)result->hits;
+    r->tick++;
+    TRACE_END("raid tick");
+
+    return true;
+}
+
+void raid_deinitialize(struct raid *r)
+{
+    if (!r) {
+        return;
+    }
+
+    vector_deinitialize(&r->hits);
+    r->js = NULL;
+}
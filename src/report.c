@@ -0,0 +1,454 @@
+/*! Report writer implementation file */
+
+#include "headers/report.h"
+#include <stdlib.h>
+#include <string.h>
+
+/** CSV header, one column per stat any entity kind can have. */
+static const char csv_header[] = "kind,owner,name,health,max_health,damage,resistance\n";
+
+bool report_initialize(const enum report_format format, const size_t capacity, FILE *out, struct report *r)
+{
+    if (capacity == 0 || !out || !r) {
+        return false;
+    }
+
+    r->buffer = malloc(capacity);
+    if (!r->buffer) {
+        return false;
+    }
+    r->size = 0;
+    r->capacity = capacity;
+    r->out = out;
+    r->format = format;
+    r->records = 0;
+    r->failed = false;
+
+    return true;
+}
+
+bool report_flush(struct report *r)
+{
+    if (!r || !r->buffer) {
+        return false;
+    }
+
+    if (r->size > 0 && !r->failed) {
+        if (fwrite(r->buffer, 1, r->size, r->out) != r->size) {
+            r->failed = true;
+        }
+    }
+    r->size = 0;
+
+    return !r->failed && fflush(r->out) == 0;
+}
+
+/**
+ * @brief Makes room for length more bytes, flushing first and growing only if that is not enough.
+ *
+ * @param[in,out] r Pointer to report struct.
+ * @param[in] length Bytes about to be appended.
+ * @return Pointer to where the bytes go, NULL on failure.
+ */
+static char *report_reserve(struct report *r, const size_t length)
+{
+    if (r->failed) {
+        return NULL;
+    }
+
+    if (r->size + length > r->capacity) {
+        if (r->size > 0 && fwrite(r->buffer, 1, r->size, r->out) != r->size) {
+            r->failed = true;
+            return NULL;
+        }
+        r->size = 0;
+    }
+
+    if (length > r->capacity) {
+        char *new_block = realloc(r->buffer, length);
+        if (!new_block) {
+            r->failed = true;
+            return NULL;
+        }
+        r->buffer = new_block;
+        r->capacity = length;
+    }
+
+    char *dest = r->buffer + r->size;
+    r->size += length;
+    return dest;
+}
+
+/**
+ * @brief Appends raw bytes.
+ *
+ * @param[in,out] r Pointer to report struct.
+ * @param[in] data Bytes to append.
+ * @param[in] length Number of bytes.
+ */
+static void report_append(struct report *r, const char *data, const size_t length)
+{
+    char *dest = report_reserve(r, length);
+    if (dest) {
+        memcpy(dest, data, length);
+    }
+}
+
+/**
+ * @brief Appends a NUL-terminated string as is.
+ *
+ * @param[in,out] r Pointer to report struct.
+ * @param[in] str String to append.
+ */
+static void report_append_cstr(struct report *r, const char *str)
+{
+    report_append(r, str, strlen(str));
+}
+
+/**
+ * @brief Appends an unsigned int in base 10.
+ *
+ * @param[in,out] r Pointer to report struct.
+ * @param[in] value Value to append.
+ */
+static void report_append_uint(struct report *r, unsigned int value)
+{
+    char digits[10];
+    size_t count = 0;
+    do {
+        digits[sizeof(digits) - ++count] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value);
+
+    report_append(r, digits + sizeof(digits) - count, count);
+}
+
+/**
+ * @brief Appends a name, quoted and escaped as the format requires.
+ *
+ * @param[in,out] r Pointer to report struct.
+ * @param[in] str Name to append, NULL is written as empty.
+ */
+static void report_append_text(struct report *r, const char *str)
+{
+    if (!str) {
+        str = "";
+    }
+
+    if (r->format == REPORT_FORMAT_HUMAN) {
+        report_append_cstr(r, str);
+        return;
+    }
+
+    if (r->format == REPORT_FORMAT_CSV) {
+        if (!strpbrk(str, ",\"\r\n")) {
+            report_append_cstr(r, str);
+            return;
+        }
+        report_append(r, "\"", 1);
+        for (const char *c = str; *c; c++) {
+            if (*c == '"') {
+                report_append(r, "\"", 1);
+            }
+            report_append(r, c, 1);
+        }
+        report_append(r, "\"", 1);
+        return;
+    }
+
+    static const char hex[] = "0123456789abcdef";
+    report_append(r, "\"", 1);
+    const char *run = str;
+    for (const char *c = str; *c; c++) {
+        const unsigned char ch = (unsigned char)*c;
+        if (ch >= 0x20 && ch != '"' && ch != '\\') {
+            continue;
+        }
+        // Copy the clean run in one go, then the escape
+        report_append(r, run, (size_t)(c - run));
+        if (ch == '"' || ch == '\\') {
+            const char escaped[2] = { '\\', (char)ch };
+            report_append(r, escaped, sizeof(escaped));
+        } else {
+            const char escaped[6] = { '\\', 'u', '0', '0', hex[ch >> 4], hex[ch & 0xF] };
+            report_append(r, escaped, sizeof(escaped));
+        }
+        run = c + 1;
+    }
+    report_append_cstr(r, run);
+    report_append(r, "\"", 1);
+}
+
+/**
+ * @brief Appends the separator needed before a top level JSON record.
+ *
+ * @param[in,out] r Pointer to report struct.
+ */
+static void report_next_record(struct report *r)
+{
+    if (r->format == REPORT_FORMAT_JSON && r->records > 0) {
+        report_append(r, ",\n", 2);
+    }
+    r->records++;
+}
+
+/**
+ * @brief Appends a weapon as a JSON object.
+ *
+ * @param[in,out] r Pointer to report struct.
+ * @param[in] owner Name of the owning player, omitted if NULL.
+ * @param[in] w Pointer to weapon struct.
+ */
+static void report_append_weapon_json(struct report *r, const char *owner, const struct weapon *w)
+{
+    report_append_cstr(r, "{\"kind\":\"weapon\",");
+    if (owner) {
+        report_append_cstr(r, "\"owner\":");
+        report_append_text(r, owner);
+        report_append(r, ",", 1);
+    }
+    report_append_cstr(r, "\"name\":");
+    report_append_text(r, name_get(&w->weapon_name));
+    report_append_cstr(r, ",\"health\":");
+    report_append_uint(r, w->weapon_health);
+    report_append_cstr(r, ",\"damage\":");
+    report_append_uint(r, w->weapon_damage);
+    report_append(r, "}", 1);
+}
+
+/**
+ * @brief Appends an armor as a JSON object.
+ *
+ * @param[in,out] r Pointer to report struct.
+ * @param[in] owner Name of the owning player, omitted if NULL.
+ * @param[in] a Pointer to armor struct.
+ */
+static void report_append_armor_json(struct report *r, const char *owner, const struct armor *a)
+{
+    report_append_cstr(r, "{\"kind\":\"armor\",");
+    if (owner) {
+        report_append_cstr(r, "\"owner\":");
+        report_append_text(r, owner);
+        report_append(r, ",", 1);
+    }
+    report_append_cstr(r, "\"name\":");
+    report_append_text(r, name_get(&a->armor_name));
+    report_append_cstr(r, ",\"health\":");
+    report_append_uint(r, a->_armor_health);
+    report_append_cstr(r, ",\"max_health\":");
+    report_append_uint(r, a->_armor_max_health);
+    report_append_cstr(r, ",\"resistance\":");
+    report_append_uint(r, a->_armor_resistance_force);
+    report_append(r, "}", 1);
+}
+
+void report_begin(struct report *r)
+{
+    if (!r || !r->buffer) {
+        return;
+    }
+
+    r->records = 0;
+    if (r->format == REPORT_FORMAT_CSV) {
+        report_append(r, csv_header, sizeof(csv_header) - 1);
+    } else if (r->format == REPORT_FORMAT_JSON) {
+        report_append(r, "[\n", 2);
+    }
+}
+
+/**
+ * @brief Appends a weapon in the report's format.
+ *
+ * @param[in,out] r Pointer to report struct.
+ * @param[in] owner Name of the owning player, may be NULL.
+ * @param[in] w Pointer to weapon struct.
+ */
+static void report_append_weapon(struct report *r, const char *owner, const struct weapon *w)
+{
+    switch (r->format) {
+    case REPORT_FORMAT_HUMAN:
+        report_append_cstr(r, "Weapon name: ");
+        report_append_text(r, name_get(&w->weapon_name));
+        report_append_cstr(r, "\nWeapon health: ");
+        report_append_uint(r, w->weapon_health);
+        report_append_cstr(r, "\nWeapon damage: ");
+        report_append_uint(r, w->weapon_damage);
+        report_append(r, "\n", 1);
+        break;
+    case REPORT_FORMAT_CSV:
+        report_append_cstr(r, "weapon,");
+        report_append_text(r, owner);
+        report_append(r, ",", 1);
+        report_append_text(r, name_get(&w->weapon_name));
+        report_append(r, ",", 1);
+        report_append_uint(r, w->weapon_health);
+        report_append(r, ",,", 2);
+        report_append_uint(r, w->weapon_damage);
+        report_append(r, ",\n", 2);
+        break;
+    case REPORT_FORMAT_JSON:
+        report_append_weapon_json(r, owner, w);
+        break;
+    }
+}
+
+/**
+ * @brief Appends an armor in the report's format.
+ *
+ * @param[in,out] r Pointer to report struct.
+ * @param[in] owner Name of the owning player, may be NULL.
+ * @param[in] a Pointer to armor struct.
+ */
+static void report_append_armor(struct report *r, const char *owner, const struct armor *a)
+{
+    switch (r->format) {
+    case REPORT_FORMAT_HUMAN:
+        report_append_cstr(r, "Armor name: ");
+        report_append_text(r, name_get(&a->armor_name));
+        report_append_cstr(r, "\nArmor health: ");
+        report_append_uint(r, a->_armor_health);
+        report_append_cstr(r, "\nArmor max health: ");
+        report_append_uint(r, a->_armor_max_health);
+        report_append_cstr(r, "\nArmor resistance: ");
+        report_append_uint(r, a->_armor_resistance_force);
+        report_append(r, "\n", 1);
+        break;
+    case REPORT_FORMAT_CSV:
+        report_append_cstr(r, "armor,");
+        report_append_text(r, owner);
+        report_append(r, ",", 1);
+        report_append_text(r, name_get(&a->armor_name));
+        report_append(r, ",", 1);
+        report_append_uint(r, a->_armor_health);
+        report_append(r, ",", 1);
+        report_append_uint(r, a->_armor_max_health);
+        report_append(r, ",,", 2);
+        report_append_uint(r, a->_armor_resistance_force);
+        report_append(r, "\n", 1);
+        break;
+    case REPORT_FORMAT_JSON:
+        report_append_armor_json(r, owner, a);
+        break;
+    }
+}
+
+void report_write_weapon(struct report *r, const char *owner, const struct weapon *w)
+{
+    if (!r || !r->buffer || !w) {
+        return;
+    }
+
+    report_next_record(r);
+    report_append_weapon(r, owner, w);
+}
+
+void report_write_armor(struct report *r, const char *owner, const struct armor *a)
+{
+    if (!r || !r->buffer || !a) {
+        return;
+    }
+
+    report_next_record(r);
+    report_append_armor(r, owner, a);
+}
+
+void report_write_player(struct report *r, const struct player *p)
+{
+    if (!r || !r->buffer || !p) {
+        return;
+    }
+
+    const struct weapon *weapons = vector_items(&p->_weapons);
+    const size_t total_weapons = weapons ? p->_weapons.size : 0;
+
+    report_next_record(r);
+    switch (r->format) {
+    case REPORT_FORMAT_HUMAN:
+        report_append_cstr(r, "----GETTING STATS FOR ");
+        report_append_text(r, name_get(&p->player_name));
+        report_append_cstr(r, "----\nHealth: ");
+        report_append_uint(r, p->health);
+        report_append(r, "\n", 1);
+        if (p->_isWearingArmor) {
+            report_append_armor(r, NULL, &p->current_armor);
+        }
+        for (size_t i = 0; i < total_weapons; i++) {
+            report_append_cstr(r, "Weapon: ");
+            report_append_text(r, name_get(&weapons[i].weapon_name));
+            report_append(r, ":", 1);
+            report_append_uint(r, weapons[i].weapon_damage);
+            report_append(r, "\n", 1);
+        }
+        report_append_cstr(r, "Total weapon size: ");
+        report_append_uint(r, (unsigned int)total_weapons);
+        report_append_cstr(r, "\n----STATS END----\n");
+        break;
+    case REPORT_FORMAT_CSV:
+        report_append_cstr(r, "player,,");
+        report_append_text(r, name_get(&p->player_name));
+        report_append(r, ",", 1);
+        report_append_uint(r, p->health);
+        report_append_cstr(r, ",,,\n");
+        if (p->_isWearingArmor) {
+            report_append_armor(r, name_get(&p->player_name), &p->current_armor);
+        }
+        for (size_t i = 0; i < total_weapons; i++) {
+            report_append_weapon(r, name_get(&p->player_name), &weapons[i]);
+        }
+        break;
+    case REPORT_FORMAT_JSON:
+        report_append_cstr(r, "{\"kind\":\"player\",\"name\":");
+        report_append_text(r, name_get(&p->player_name));
+        report_append_cstr(r, ",\"health\":");
+        report_append_uint(r, p->health);
+        report_append_cstr(r, ",\"armor\":");
+        if (p->_isWearingArmor) {
+            report_append_armor_json(r, NULL, &p->current_armor);
+        } else {
+            report_append_cstr(r, "null");
+        }
+        report_append_cstr(r, ",\"weapons\":[");
+        for (size_t i = 0; i < total_weapons; i++) {
+            if (i > 0) {
+                report_append(r, ",", 1);
+            }
+            report_append_weapon_json(r, NULL, &weapons[i]);
+        }
+        report_append_cstr(r, "]}");
+        break;
+    }
+}
+
+void report_write_game(struct report *r, const struct game *g)
+{
+    if (!r || !r->buffer || !g) {
+        return;
+    }
+
+    const size_t total_players = game_get_total_players(g);
+    for (size_t i = 0; i < total_players; i++) {
+        report_write_player(r, game_get_player(i, g));
+    }
+}
+
+void report_end(struct report *r)
+{
+    if (!r || !r->buffer) {
+        return;
+    }
+
+    if (r->format == REPORT_FORMAT_JSON) {
+        report_append(r, "\n]\n", 3);
+    }
+}
+
+void report_deinitialize(struct report *r)
+{
+    if (!r || !r->buffer) {
+        return;
+    }
+
+    report_flush(r);
+    free(r->buffer);
+    memset(r, 0, sizeof(*r));
+}
@@ -0,0 +1,739 @@
+/*! Server implementation file */
+
+#ifdef __linux__
+#define _GNU_SOURCE
+#endif
+
+#include "headers/server.h"
+#include <stdio.h>
+
+#ifdef __linux__
+
+#include "headers/game.h"
+#include "headers/player.h"
+#include "headers/weapon.h"
+#include "headers/armor.h"
+#include "headers/vector.h"
+#include "headers/tokenizer.h"
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/** Size of a frame header: status or opcode, then payload length. */
+#define FRAME_HEADER_SIZE 2
+/** Size of a full frame. */
+#define FRAME_MAX_SIZE (FRAME_HEADER_SIZE + SERVER_MAX_PAYLOAD)
+/** Per session input buffer, enough for several pipelined requests. */
+#define SESSION_IN_SIZE 4096
+/** Per session output buffer. Reading pauses while it cannot hold one more response. */
+#define SESSION_OUT_SIZE 8192
+/** Players a new session has room for before its game grows. */
+#define SESSION_INITIAL_PLAYERS 4
+/** Weapons a joining player has room for before its vector grows. */
+#define SESSION_INITIAL_WEAPONS 4
+/** Armor health given to joining players. */
+#define SESSION_ARMOR_HEALTH 100
+
+/**
+ * @struct session
+ * @brief One client connection and the game it plays.
+ */
+struct session {
+    /** Connected socket. */
+    int fd;
+    /** Game owned by this session. */
+    struct game game;
+    /** Bytes received but not yet handled. */
+    unsigned char in[SESSION_IN_SIZE];
+    /** Number of bytes in the input buffer. */
+    size_t in_length;
+    /** Responses not yet sent. */
+    unsigned char out[SESSION_OUT_SIZE];
+    /** Number of bytes in the output buffer. */
+    size_t out_length;
+    /** Previous session in the server list. */
+    struct session *prev;
+    /** Next session in the server list. */
+    struct session *next;
+};
+
+/**
+ * @struct payload_reader
+ * @brief Bounds checked cursor over a request payload.
+ */
+struct payload_reader {
+    /** Payload bytes. */
+    const unsigned char *data;
+    /** Payload length. */
+    size_t length;
+    /** Next byte to read. */
+    size_t offset;
+    /** Cleared once a read ran past the end. */
+    bool ok;
+};
+
+/**
+ * @brief Reads a little endian u32.
+ *
+ * @param[in,out] pr Pointer to payload reader struct.
+ * @return The value, 0 if the payload is too short.
+ */
+static unsigned int payload_read_u32(struct payload_reader *pr)
+{
+    if (!pr->ok || pr->length - pr->offset < 4) {
+        pr->ok = false;
+        return 0;
+    }
+
+    const unsigned char *b = pr->data + pr->offset;
+    pr->offset += 4;
+    return (unsigned int)b[0] | (unsigned int)b[1] << 8 | (unsigned int)b[2] << 16 | (unsigned int)b[3] << 24;
+}
+
+/**
+ * @brief Reads a length prefixed string into a NUL-terminated buffer of at least SERVER_MAX_PAYLOAD + 1 bytes.
+ *
+ * @param[in,out] pr Pointer to payload reader struct.
+ * @param[out] dest Caller allocated buffer.
+ */
+static void payload_read_str(struct payload_reader *pr, char *dest)
+{
+    dest[0] = '\0';
+    if (!pr->ok || pr->length - pr->offset < 1) {
+        pr->ok = false;
+        return;
+    }
+
+    const size_t length = pr->data[pr->offset];
+    if (pr->length - pr->offset - 1 < length) {
+        pr->ok = false;
+        return;
+    }
+
+    const struct string_view sv = { .data = (const char *)pr->data + pr->offset + 1, .length = length };
+    string_view_copy(sv, SERVER_MAX_PAYLOAD + 1, dest);
+    pr->offset += 1 + length;
+}
+
+/**
+ * @brief Checks that the whole payload was read and nothing ran past its end.
+ *
+ * @param[in] pr Pointer to payload reader struct.
+ * @return true if the payload was well formed, false otherwise.
+ */
+static bool payload_done(const struct payload_reader *pr)
+{
+    return pr->ok && pr->offset == pr->length;
+}
+
+/**
+ * @brief Starts a response in the session output buffer. Room for a full frame is guaranteed by the caller.
+ *
+ * @param[in,out] se Pointer to session struct.
+ * @param[in] status Response status.
+ * @return Pointer to the response header, used to fill in the length.
+ */
+static unsigned char *response_begin(struct session *se, const enum server_status status)
+{
+    unsigned char *header = se->out + se->out_length;
+    header[0] = (unsigned char)status;
+    header[1] = 0;
+    se->out_length += FRAME_HEADER_SIZE;
+    return header;
+}
+
+/**
+ * @brief Appends a little endian u32 to the response.
+ *
+ * @param[in,out] se Pointer to session struct.
+ * @param[in,out] header Response header from response_begin().
+ * @param[in] value Value to append.
+ */
+static void response_put_u32(struct session *se, unsigned char *header, const unsigned int value)
+{
+    unsigned char *b = se->out + se->out_length;
+    b[0] = (unsigned char)value;
+    b[1] = (unsigned char)(value >> 8);
+    b[2] = (unsigned char)(value >> 16);
+    b[3] = (unsigned char)(value >> 24);
+    se->out_length += 4;
+    header[1] += 4;
+}
+
+/**
+ * @brief Appends a length prefixed string to the response, truncated to what fits.
+ *
+ * @param[in,out] se Pointer to session struct.
+ * @param[in,out] header Response header from response_begin().
+ * @param[in] str String to append.
+ */
+static void response_put_str(struct session *se, unsigned char *header, const char *str)
+{
+    size_t length = str ? strlen(str) : 0;
+    const size_t room = SERVER_MAX_PAYLOAD - header[1] - 1;
+    if (length > room) {
+        length = room;
+    }
+
+    se->out[se->out_length] = (unsigned char)length;
+    if (length > 0) {
+        memcpy(se->out + se->out_length + 1, str, length);
+    }
+    se->out_length += 1 + length;
+    header[1] += (unsigned char)(1 + length);
+}
+
+/**
+ * @brief Releases the game of a session, its players were moved in and go with it.
+ *
+ * @param[in] g Pointer to game struct.
+ */
+static void session_release_game(struct game *g)
+{
+    game_deinitialize(g);
+}
+
+/**
+ * @brief Handles SERVER_OP_JOIN.
+ *
+ * @param[in,out] se Pointer to session struct.
+ * @param[in,out] pr Pointer to payload reader struct.
+ */
+static void session_join(struct session *se, struct payload_reader *pr)
+{
+    char name[SERVER_MAX_PAYLOAD + 1];
+    payload_read_str(pr, name);
+    const unsigned int health = payload_read_u32(pr);
+    const unsigned int resistance = payload_read_u32(pr);
+    if (!payload_done(pr)) {
+        response_begin(se, SERVER_STATUS_BAD_REQUEST);
+        return;
+    }
+
+    struct armor armor = {0};
+    struct vector weapons = {0};
+    struct player p = {0};
+    if (!armor_initialize("Armor", SESSION_ARMOR_HEALTH, SESSION_ARMOR_HEALTH, resistance, &armor)) {
+        response_begin(se, SERVER_STATUS_BAD_REQUEST);
+        return;
+    }
+    // The player, its weapons and its armor are moved into the game, which frees them
+    if (!vector_initialize(SESSION_INITIAL_WEAPONS, sizeof(struct weapon), &weapons) ||
+        !player_initialize_move(name, health, &weapons, &armor, &p) ||
+        !game_insert_player_move(&p, &se->game)) {
+        player_deinitialize(&p);
+        vector_deinitialize(&weapons);
+        armor_deinitialize(&armor);
+        response_begin(se, SERVER_STATUS_FAILED);
+        return;
+    }
+
+    unsigned char *header = response_begin(se, SERVER_STATUS_OK);
+    response_put_u32(se, header, (unsigned int)(game_get_total_players(&se->game) - 1));
+}
+
+/**
+ * @brief Handles SERVER_OP_ADD_WEAPON.
+ *
+ * @param[in,out] se Pointer to session struct.
+ * @param[in,out] pr Pointer to payload reader struct.
+ */
+static void session_add_weapon(struct session *se, struct payload_reader *pr)
+{
+    char name[SERVER_MAX_PAYLOAD + 1];
+    const unsigned int index = payload_read_u32(pr);
+    payload_read_str(pr, name);
+    const unsigned int health = payload_read_u32(pr);
+    const unsigned int damage = payload_read_u32(pr);
+    if (!payload_done(pr)) {
+        response_begin(se, SERVER_STATUS_BAD_REQUEST);
+        return;
+    }
+
+    struct player *p = game_get_player_mut(index, &se->game);
+    if (!p) {
+        response_begin(se, SERVER_STATUS_NOT_FOUND);
+        return;
+    }
+
+    struct weapon w = {0};
+    if (!weapon_initialize(name, health, damage, &w)) {
+        response_begin(se, SERVER_STATUS_BAD_REQUEST);
+        return;
+    }
+
+    const size_t before = p->_weapons.size;
+    player_update_weapons("add", &w, p);
+    if (p->_weapons.size == before) {
+        weapon_deinitialize(&w);
+        response_begin(se, SERVER_STATUS_FAILED);
+        return;
+    }
+
+    response_begin(se, SERVER_STATUS_OK);
+}
+
+/**
+ * @brief Handles SERVER_OP_ATTACK.
+ *
+ * @param[in,out] se Pointer to session struct.
+ * @param[in,out] pr Pointer to payload reader struct.
+ */
+static void session_attack(struct session *se, struct payload_reader *pr)
+{
+    char name[SERVER_MAX_PAYLOAD + 1];
+    const unsigned int attacker_index = payload_read_u32(pr);
+    const unsigned int target_index = payload_read_u32(pr);
+    payload_read_str(pr, name);
+    if (!payload_done(pr)) {
+        response_begin(se, SERVER_STATUS_BAD_REQUEST);
+        return;
+    }
+
+    struct player *attacker = game_get_player_mut(attacker_index, &se->game);
+    struct player *target = game_get_player_mut(target_index, &se->game);
+    if (!attacker || !target || !vector_search_element(&attacker->_weapons, name, NULL, weapon_name_cmp)) {
+        response_begin(se, SERVER_STATUS_NOT_FOUND);
+        return;
+    }
+    if (attacker->health == 0 || target->health == 0) {
+        response_begin(se, SERVER_STATUS_FAILED);
+        return;
+    }
+
+    player_attack(attacker, name, target);
+
+    unsigned char *header = response_begin(se, SERVER_STATUS_OK);
+    response_put_u32(se, header, target->health);
+}
+
+/**
+ * @brief Handles SERVER_OP_HEAL.
+ *
+ * @param[in,out] se Pointer to session struct.
+ * @param[in,out] pr Pointer to payload reader struct.
+ */
+static void session_heal(struct session *se, struct payload_reader *pr)
+{
+    const unsigned int index = payload_read_u32(pr);
+    const unsigned int amount = payload_read_u32(pr);
+    if (!payload_done(pr)) {
+        response_begin(se, SERVER_STATUS_BAD_REQUEST);
+        return;
+    }
+
+    struct player *p = game_get_player_mut(index, &se->game);
+    if (!p) {
+        response_begin(se, SERVER_STATUS_NOT_FOUND);
+        return;
+    }
+
+    player_heal(amount, p);
+
+    unsigned char *header = response_begin(se, SERVER_STATUS_OK);
+    response_put_u32(se, header, p->health);
+}
+
+/**
+ * @brief Handles SERVER_OP_STATS.
+ *
+ * @param[in,out] se Pointer to session struct.
+ * @param[in,out] pr Pointer to payload reader struct.
+ */
+static void session_stats(struct session *se, struct payload_reader *pr)
+{
+    const unsigned int index = payload_read_u32(pr);
+    if (!payload_done(pr)) {
+        response_begin(se, SERVER_STATUS_BAD_REQUEST);
+        return;
+    }
+
+    const struct player *p = game_get_player(index, &se->game);
+    if (!p) {
+        response_begin(se, SERVER_STATUS_NOT_FOUND);
+        return;
+    }
+
+    unsigned char *header = response_begin(se, SERVER_STATUS_OK);
+    response_put_u32(se, header, p->health);
+    response_put_u32(se, header, armor_get_resistance(player_get_armor(p)));
+    response_put_u32(se, header, (unsigned int)player_get_weapons(p)->size);
+}
+
+/**
+ * @brief Handles SERVER_OP_WINNER.
+ *
+ * @param[in,out] se Pointer to session struct.
+ * @param[in,out] pr Pointer to payload reader struct.
+ */
+static void session_winner(struct session *se, struct payload_reader *pr)
+{
+    if (!payload_done(pr)) {
+        response_begin(se, SERVER_STATUS_BAD_REQUEST);
+        return;
+    }
+
+    const struct player *last_alive = NULL;
+    unsigned int alive = 0;
+    const size_t total_players = game_get_total_players(&se->game);
+    for (size_t i = 0; i < total_players; i++) {
+        const struct player *p = game_get_player(i, &se->game);
+        if (p->health > 0) {
+            last_alive = p;
+            alive++;
+        }
+    }
+
+    unsigned char *header = response_begin(se, SERVER_STATUS_OK);
+    response_put_u32(se, header, alive);
+    if (alive == 1) {
+        response_put_str(se, header, name_get(&last_alive->player_name));
+    }
+}
+
+/**
+ * @brief Handles every complete request in the input buffer while there is room for the response.
+ *
+ * @param[in,out] se Pointer to session struct.
+ */
+static void session_process(struct session *se)
+{
+    size_t consumed = 0;
+    while (se->in_length - consumed >= FRAME_HEADER_SIZE && SESSION_OUT_SIZE - se->out_length >= FRAME_MAX_SIZE) {
+        const unsigned char *frame = se->in + consumed;
+        const size_t payload_length = frame[1];
+        if (se->in_length - consumed < FRAME_HEADER_SIZE + payload_length) {
+            break;
+        }
+
+        struct payload_reader pr = {
+            .data = frame + FRAME_HEADER_SIZE,
+            .length = payload_length,
+            .offset = 0,
+            .ok = true
+        };
+        switch (frame[0]) {
+        case SERVER_OP_JOIN:
+            session_join(se, &pr);
+            break;
+        case SERVER_OP_ADD_WEAPON:
+            session_add_weapon(se, &pr);
+            break;
+        case SERVER_OP_ATTACK:
+            session_attack(se, &pr);
+            break;
+        case SERVER_OP_HEAL:
+            session_heal(se, &pr);
+            break;
+        case SERVER_OP_STATS:
+            session_stats(se, &pr);
+            break;
+        case SERVER_OP_WINNER:
+            session_winner(se, &pr);
+            break;
+        default:
+            response_begin(se, SERVER_STATUS_BAD_REQUEST);
+            break;
+        }
+        consumed += FRAME_HEADER_SIZE + payload_length;
+    }
+
+    if (consumed > 0) {
+        memmove(se->in, se->in + consumed, se->in_length - consumed);
+        se->in_length -= consumed;
+    }
+}
+
+/**
+ * @brief Sends as much pending output as the socket takes.
+ *
+ * @param[in,out] se Pointer to session struct.
+ * @return true if the session is still usable, false if it has to be closed.
+ */
+static bool session_flush(struct session *se)
+{
+    size_t sent = 0;
+    while (sent < se->out_length) {
+        const ssize_t written = send(se->fd, se->out + sent, se->out_length - sent, MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            return false;
+        }
+        sent += (size_t)written;
+    }
+
+    memmove(se->out, se->out + sent, se->out_length - sent);
+    se->out_length -= sent;
+    return true;
+}
+
+/**
+ * @brief Registers the events a session waits for: input while there is room to answer, output while any is pending.
+ *
+ * @param[in] s Pointer to server struct.
+ * @param[in] se Pointer to session struct.
+ * @param[in] op EPOLL_CTL_ADD or EPOLL_CTL_MOD.
+ * @return true if success, false otherwise.
+ */
+static bool session_watch(struct server *s, struct session *se, const int op)
+{
+    struct epoll_event ev = { .events = 0, .data.ptr = se };
+    if (SESSION_OUT_SIZE - se->out_length >= FRAME_MAX_SIZE && se->in_length < SESSION_IN_SIZE) {
+        ev.events |= EPOLLIN;
+    }
+    if (se->out_length > 0) {
+        ev.events |= EPOLLOUT;
+    }
+
+    return epoll_ctl(s->epoll_fd, op, se->fd, &ev) == 0;
+}
+
+/**
+ * @brief Closes a session and releases its game.
+ *
+ * @param[in,out] s Pointer to server struct.
+ * @param[in] se Pointer to session struct.
+ */
+static void session_close(struct server *s, struct session *se)
+{
+    epoll_ctl(s->epoll_fd, EPOLL_CTL_DEL, se->fd, NULL);
+    close(se->fd);
+    session_release_game(&se->game);
+
+    if (se->prev) {
+        se->prev->next = se->next;
+    } else {
+        s->sessions = se->next;
+    }
+    if (se->next) {
+        se->next->prev = se->prev;
+    }
+    s->total_sessions--;
+    free(se);
+}
+
+/**
+ * @brief Reads, handles and answers whatever a session is ready for.
+ *
+ * @param[in,out] s Pointer to server struct.
+ * @param[in] se Pointer to session struct.
+ * @param[in] events Ready events reported by epoll.
+ */
+static void session_handle(struct server *s, struct session *se, const uint32_t events)
+{
+    if (events & (EPOLLERR | EPOLLHUP) && !(events & EPOLLIN)) {
+        session_close(s, se);
+        return;
+    }
+
+    if (events & EPOLLIN) {
+        const ssize_t received = recv(se->fd, se->in + se->in_length, SESSION_IN_SIZE - se->in_length, 0);
+        if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            session_close(s, se);
+            return;
+        }
+        if (received > 0) {
+            se->in_length += (size_t)received;
+        }
+    }
+
+    // Keep answering pipelined requests as long as the socket drains the responses
+    do {
+        session_process(se);
+        if (!session_flush(se)) {
+            session_close(s, se);
+            return;
+        }
+    } while (se->out_length == 0 && se->in_length >= FRAME_HEADER_SIZE &&
+             se->in_length >= (size_t)FRAME_HEADER_SIZE + se->in[1]);
+
+    if (!session_watch(s, se, EPOLL_CTL_MOD)) {
+        session_close(s, se);
+    }
+}
+
+/**
+ * @brief Accepts every pending connection and starts a session for each.
+ *
+ * @param[in,out] s Pointer to server struct.
+ */
+static void server_accept(struct server *s)
+{
+    for (;;) {
+        const int fd = accept4(s->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                fprintf(stderr, "accept failed at server_accept()\n");
+            }
+            return;
+        }
+
+        struct session *se = malloc(sizeof(*se));
+        if (!se) {
+            fprintf(stderr, "malloc failed at server_accept()\n");
+            close(fd);
+            continue;
+        }
+        se->fd = fd;
+        se->in_length = 0;
+        se->out_length = 0;
+        se->prev = NULL;
+        se->next = s->sessions;
+
+        if (!game_initialize(SESSION_INITIAL_PLAYERS, &se->game)) {
+            free(se);
+            close(fd);
+            continue;
+        }
+        if (!session_watch(s, se, EPOLL_CTL_ADD)) {
+            game_deinitialize(&se->game);
+            free(se);
+            close(fd);
+            continue;
+        }
+
+        if (s->sessions) {
+            s->sessions->prev = se;
+        }
+        s->sessions = se;
+        s->total_sessions++;
+    }
+}
+
+bool server_initialize(const char *socket_path, struct server *s)
+{
+    if (!socket_path || socket_path[0] == '\0' || !s) {
+        return false;
+    }
+
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "socket path is too long at server_initialize()\n");
+        return false;
+    }
+    memcpy(addr.sun_path, socket_path, strlen(socket_path) + 1);
+
+    memset(s, 0, sizeof(*s));
+    s->socket_path = socket_path;
+    s->listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (s->listen_fd < 0) {
+        fprintf(stderr, "socket failed at server_initialize()\n");
+        return false;
+    }
+
+    unlink(socket_path);
+    if (bind(s->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(s->listen_fd, SOMAXCONN) != 0) {
+        fprintf(stderr, "bind or listen failed at server_initialize()\n");
+        close(s->listen_fd);
+        return false;
+    }
+
+    s->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = NULL };
+    if (s->epoll_fd < 0 || epoll_ctl(s->epoll_fd, EPOLL_CTL_ADD, s->listen_fd, &ev) != 0) {
+        fprintf(stderr, "epoll setup failed at server_initialize()\n");
+        if (s->epoll_fd >= 0) {
+            close(s->epoll_fd);
+        }
+        close(s->listen_fd);
+        unlink(socket_path);
+        return false;
+    }
+    atomic_init(&s->running, true);
+
+    return true;
+}
+
+bool server_run(struct server *s)
+{
+    if (!s || s->epoll_fd <= 0) {
+        return false;
+    }
+
+    struct epoll_event events[SERVER_MAX_EVENTS];
+    while (atomic_load_explicit(&s->running, memory_order_relaxed)) {
+        const int ready = epoll_wait(s->epoll_fd, events, SERVER_MAX_EVENTS, -1);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fprintf(stderr, "epoll_wait failed at server_run()\n");
+            return false;
+        }
+
+        for (int i = 0; i < ready; i++) {
+            if (!events[i].data.ptr) {
+                server_accept(s);
+                continue;
+            }
+            session_handle(s, events[i].data.ptr, events[i].events);
+        }
+    }
+
+    return true;
+}
+
+void server_stop(struct server *s)
+{
+    if (!s) {
+        return;
+    }
+
+    atomic_store_explicit(&s->running, false, memory_order_relaxed);
+}
+
+void server_deinitialize(struct server *s)
+{
+    if (!s || s->epoll_fd <= 0) {
+        return;
+    }
+
+    while (s->sessions) {
+        session_close(s, s->sessions);
+    }
+    close(s->epoll_fd);
+    close(s->listen_fd);
+    unlink(s->socket_path);
+    memset(s, 0, sizeof(*s));
+}
+
+#else
+
+bool server_initialize(const char *socket_path, struct server *s)
+{
+    (void)socket_path;
+    (void)s;
+    fprintf(stderr, "server mode is only supported on Linux\n");
+    return false;
+}
+
+bool server_run(struct server *s)
+{
+    (void)s;
+    return false;
+}
+
+void server_stop(struct server *s)
+{
+    (void)s;
+}
+
+void server_deinitialize(struct server *s)
+{
+    (void)s;
+}
+
+#endif
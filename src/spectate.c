@@ -0,0 +1,753 @@
+/*! Spectator stream implementation file */
+
+#include "headers/spectate.h"
+#include "headers/player.h"
+#include "headers/vector.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Every bit of a player mask, as keyframes send them. */
+#define SPECTATE_PLAYER_ALL 0xffu
+/** Every bit of a weapon mask. */
+#define SPECTATE_WEAPON_ALL 0x07u
+/** Longest varint, a uint64_t in 7 bit groups. */
+#define SPECTATE_VARINT_SIZE 10
+/** Longest frame a view accepts, anything longer is taken as a corrupt stream. */
+#define SPECTATE_MAX_FRAME (64u * 1024u * 1024u)
+
+/**
+ * @struct spectate_cursor
+ * @brief Read position in a frame.
+ */
+struct spectate_cursor {
+    /** Next byte. */
+    unsigned char *at;
+    /** One past the last byte. */
+    unsigned char *end;
+};
+
+static void spectate_weapon_deinitialize(struct spectate_weapon *w)
+{
+    name_deinitialize(&w->name);
+}
+
+static void spectate_player_deinitialize(struct spectate_player *p)
+{
+    name_deinitialize(&p->name);
+    name_deinitialize(&p->armor_name);
+    for (size_t i = 0; i < p->total_weapons; i++) {
+        spectate_weapon_deinitialize(&p->weapons[i]);
+    }
+    free(p->weapons);
+    memset(p, 0, sizeof(*p));
+}
+
+static void spectate_state_deinitialize(struct spectate_state *s)
+{
+    for (size_t i = 0; i < s->total_players; i++) {
+        spectate_player_deinitialize(&s->players[i]);
+    }
+    free(s->players);
+    memset(s, 0, sizeof(*s));
+}
+
+/**
+ * @brief Resizes the weapons of a player, new ones zeroed and dropped ones deinitialized.
+ */
+static bool spectate_player_resize_weapons(const size_t total, struct spectate_player *p)
+{
+    for (size_t i = total; i < p->total_weapons; i++) {
+        spectate_weapon_deinitialize(&p->weapons[i]);
+    }
+    if (total > p->weapons_capacity) {
+        const size_t capacity = total > p->weapons_capacity * 2 ? total : p->weapons_capacity * 2;
+        if (capacity > SIZE_MAX / sizeof(*p->weapons)) {
+            return false;
+        }
+        struct spectate_weapon *weapons = realloc(p->weapons, capacity * sizeof(*weapons));
+        if (!weapons) {
+            return false;
+        }
+        p->weapons = weapons;
+        p->weapons_capacity = capacity;
+    }
+    if (total > p->total_weapons) {
+        memset(&p->weapons[p->total_weapons], 0, (total - p->total_weapons) * sizeof(*p->weapons));
+    }
+    p->total_weapons = total;
+
+    return true;
+}
+
+/**
+ * @brief Resizes the players of a state, new ones zeroed and dropped ones deinitialized.
+ */
+static bool spectate_state_resize(const size_t total, struct spectate_state *s)
+{
+    for (size_t i = total; i < s->total_players; i++) {
+        spectate_player_deinitialize(&s->players[i]);
+    }
+    if (total > s->capacity) {
+        const size_t capacity = total > s->capacity * 2 ? total : s->capacity * 2;
+        if (capacity > SIZE_MAX / sizeof(*s->players)) {
+            return false;
+        }
+        struct spectate_player *players = realloc(s->players, capacity * sizeof(*players));
+        if (!players) {
+            return false;
+        }
+        s->players = players;
+        s->capacity = capacity;
+    }
+    if (total > s->total_players) {
+        memset(&s->players[s->total_players], 0, (total - s->total_players) * sizeof(*s->players));
+    }
+    s->total_players = total;
+
+    return true;
+}
+
+/**
+ * @brief Sets a name to a copy of the string, leaving it alone if it already holds it.
+ */
+static bool spectate_set_name(const char *str, struct name *n)
+{
+    if (name_equals(n, str)) {
+        return true;
+    }
+
+    name_deinitialize(n);
+    return name_initialize(str, n);
+}
+
+static unsigned int spectate_weapon_mask(const struct weapon *w, const struct spectate_weapon *last)
+{
+    if (!last) {
+        return SPECTATE_WEAPON_ALL;
+    }
+
+    unsigned int mask = 0;
+    if (!name_equals(&last->name, name_get(&w->weapon_name))) {
+        mask |= SPECTATE_WEAPON_NAME;
+    }
+    if (last->health != w->weapon_health) {
+        mask |= SPECTATE_WEAPON_HEALTH;
+    }
+    if (last->damage != w->weapon_damage) {
+        mask |= SPECTATE_WEAPON_DAMAGE;
+    }
+
+    return mask;
+}
+
+/**
+ * @brief Gets the weapon mask of the i-th weapon of a player, every bit for a weapon the last state did not have.
+ */
+static unsigned int spectate_weapon_mask_at(const struct weapon *weapons, const size_t i, const struct spectate_player *last)
+{
+    return spectate_weapon_mask(&weapons[i], last && i < last->total_weapons ? &last->weapons[i] : NULL);
+}
+
+static unsigned int spectate_player_mask(const struct player *p, const struct spectate_player *last)
+{
+    if (!last) {
+        return SPECTATE_PLAYER_ALL;
+    }
+
+    const struct armor *a = &p->current_armor;
+    unsigned int mask = 0;
+    if (!name_equals(&last->name, name_get(&p->player_name))) {
+        mask |= SPECTATE_PLAYER_NAME;
+    }
+    if (last->health != p->health) {
+        mask |= SPECTATE_PLAYER_HEALTH;
+    }
+    if (last->wearing_armor != p->_isWearingArmor) {
+        mask |= SPECTATE_PLAYER_WEARING_ARMOR;
+    }
+    if (!name_equals(&last->armor_name, name_get(&a->armor_name))) {
+        mask |= SPECTATE_PLAYER_ARMOR_NAME;
+    }
+    if (last->armor_health != a->_armor_health) {
+        mask |= SPECTATE_PLAYER_ARMOR_HEALTH;
+    }
+    if (last->armor_max_health != a->_armor_max_health) {
+        mask |= SPECTATE_PLAYER_ARMOR_MAX_HEALTH;
+    }
+    if (last->armor_resistance != a->_armor_resistance_force) {
+        mask |= SPECTATE_PLAYER_ARMOR_RESISTANCE;
+    }
+
+    const struct weapon *weapons = vector_items(&p->_weapons);
+    bool weapons_changed = last->total_weapons != p->_weapons.size;
+    for (size_t i = 0; i < p->_weapons.size && !weapons_changed; i++) {
+        weapons_changed = spectate_weapon_mask_at(weapons, i, last) != 0;
+    }
+    if (weapons_changed) {
+        mask |= SPECTATE_PLAYER_WEAPONS;
+    }
+
+    return mask;
+}
+
+/**
+ * @brief Copies what a spectator sees of a player into the last state.
+ */
+static bool spectate_player_copy(const struct player *p, struct spectate_player *sp)
+{
+    const struct armor *a = &p->current_armor;
+    if (!spectate_set_name(name_get(&p->player_name), &sp->name) ||
+        !spectate_set_name(name_get(&a->armor_name), &sp->armor_name) ||
+        !spectate_player_resize_weapons(p->_weapons.size, sp)) {
+        return false;
+    }
+    sp->health = p->health;
+    sp->wearing_armor = p->_isWearingArmor;
+    sp->armor_health = a->_armor_health;
+    sp->armor_max_health = a->_armor_max_health;
+    sp->armor_resistance = a->_armor_resistance_force;
+
+    const struct weapon *weapons = vector_items(&p->_weapons);
+    for (size_t i = 0; i < p->_weapons.size; i++) {
+        if (!spectate_set_name(name_get(&weapons[i].weapon_name), &sp->weapons[i].name)) {
+            return false;
+        }
+        sp->weapons[i].health = weapons[i].weapon_health;
+        sp->weapons[i].damage = weapons[i].weapon_damage;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Appends bytes to the frame being encoded, growing the buffer as needed.
+ */
+static bool spectate_put(const void *bytes, const size_t length, struct spectate_stream *ss)
+{
+    if (ss->failed) {
+        return false;
+    }
+
+    if (length > ss->capacity - ss->size) {
+        if (length > SIZE_MAX / 2 - ss->size) {
+            ss->failed = true;
+            return false;
+        }
+        const size_t needed = ss->size + length;
+        const size_t capacity = needed > ss->capacity * 2 ? needed : ss->capacity * 2;
+        unsigned char *buffer = realloc(ss->buffer, capacity);
+        if (!buffer) {
+            ss->failed = true;
+            return false;
+        }
+        ss->buffer = buffer;
+        ss->capacity = capacity;
+    }
+    memcpy(ss->buffer + ss->size, bytes, length);
+    ss->size += length;
+
+    return true;
+}
+
+/**
+ * @brief Encodes a value as an unsigned LEB128 varint.
+ *
+ * @return Bytes written to out, at most SPECTATE_VARINT_SIZE.
+ */
+static size_t spectate_encode_varint(uint64_t value, unsigned char *out)
+{
+    size_t length = 0;
+    while (value >= 0x80) {
+        out[length++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    out[length++] = (unsigned char)value;
+
+    return length;
+}
+
+static bool spectate_put_varint(const uint64_t value, struct spectate_stream *ss)
+{
+    unsigned char bytes[SPECTATE_VARINT_SIZE];
+    return spectate_put(bytes, spectate_encode_varint(value, bytes), ss);
+}
+
+static bool spectate_put_u8(const unsigned int value, struct spectate_stream *ss)
+{
+    const unsigned char byte = (unsigned char)value;
+    return spectate_put(&byte, 1, ss);
+}
+
+static bool spectate_put_string(const char *str, struct spectate_stream *ss)
+{
+    const size_t length = strlen(str);
+    return spectate_put_varint(length, ss) && spectate_put(str, length, ss);
+}
+
+static bool spectate_put_weapons(const struct player *p, const struct spectate_player *last, struct spectate_stream *ss)
+{
+    const struct weapon *weapons = vector_items(&p->_weapons);
+    size_t changed = 0;
+    for (size_t i = 0; i < p->_weapons.size; i++) {
+        changed += spectate_weapon_mask_at(weapons, i, last) != 0;
+    }
+    if (!spectate_put_varint(p->_weapons.size, ss) || !spectate_put_varint(changed, ss)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < p->_weapons.size; i++) {
+        const unsigned int mask = spectate_weapon_mask_at(weapons, i, last);
+        if (mask == 0) {
+            continue;
+        }
+        bool ok = spectate_put_varint(i, ss) && spectate_put_u8(mask, ss);
+        if (mask & SPECTATE_WEAPON_NAME) {
+            ok = ok && spectate_put_string(name_get(&weapons[i].weapon_name), ss);
+        }
+        if (mask & SPECTATE_WEAPON_HEALTH) {
+            ok = ok && spectate_put_varint(weapons[i].weapon_health, ss);
+        }
+        if (mask & SPECTATE_WEAPON_DAMAGE) {
+            ok = ok && spectate_put_varint(weapons[i].weapon_damage, ss);
+        }
+        if (!ok) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool spectate_put_player(const struct player *p, const unsigned int mask, const struct spectate_player *last, struct spectate_stream *ss)
+{
+    const struct armor *a = &p->current_armor;
+    bool ok = spectate_put_u8(mask, ss);
+    if (mask & SPECTATE_PLAYER_NAME) {
+        ok = ok && spectate_put_string(name_get(&p->player_name), ss);
+    }
+    if (mask & SPECTATE_PLAYER_HEALTH) {
+        ok = ok && spectate_put_varint(p->health, ss);
+    }
+    if (mask & SPECTATE_PLAYER_WEARING_ARMOR) {
+        ok = ok && spectate_put_varint(p->_isWearingArmor, ss);
+    }
+    if (mask & SPECTATE_PLAYER_ARMOR_NAME) {
+        ok = ok && spectate_put_string(name_get(&a->armor_name), ss);
+    }
+    if (mask & SPECTATE_PLAYER_ARMOR_HEALTH) {
+        ok = ok && spectate_put_varint(a->_armor_health, ss);
+    }
+    if (mask & SPECTATE_PLAYER_ARMOR_MAX_HEALTH) {
+        ok = ok && spectate_put_varint(a->_armor_max_health, ss);
+    }
+    if (mask & SPECTATE_PLAYER_ARMOR_RESISTANCE) {
+        ok = ok && spectate_put_varint(a->_armor_resistance_force, ss);
+    }
+    if (mask & SPECTATE_PLAYER_WEAPONS) {
+        ok = ok && spectate_put_weapons(p, last, ss);
+    }
+
+    return ok;
+}
+
+bool spectate_stream_initialize(const unsigned int keyframe_interval, FILE *out, struct spectate_stream *ss)
+{
+    if (keyframe_interval == 0 || !out || !ss) {
+        return false;
+    }
+
+    memset(ss, 0, sizeof(*ss));
+    ss->out = out;
+    ss->keyframe_interval = keyframe_interval;
+
+    return true;
+}
+
+bool spectate_stream_write_tick(const struct game *g, struct spectate_stream *ss)
+{
+    if (!g || !ss || !ss->out || ss->failed) {
+        return false;
+    }
+
+    const bool keyframe = ss->tick % ss->keyframe_interval == 0;
+    const size_t total = game_get_total_players(g);
+    ss->size = 0;
+    spectate_put_u8(keyframe ? SPECTATE_FRAME_KEYFRAME : SPECTATE_FRAME_DELTA, ss);
+    spectate_put_varint(ss->tick, ss);
+    spectate_put_varint(total, ss);
+
+    if (!keyframe) {
+        size_t changed = 0;
+        for (size_t i = 0; i < total; i++) {
+            const struct spectate_player *last = i < ss->last.total_players ? &ss->last.players[i] : NULL;
+            changed += spectate_player_mask(game_get_player(i, g), last) != 0;
+        }
+        spectate_put_varint(changed, ss);
+    }
+
+    for (size_t i = 0; i < total; i++) {
+        const struct player *p = game_get_player(i, g);
+        const struct spectate_player *last = !keyframe && i < ss->last.total_players ? &ss->last.players[i] : NULL;
+        const unsigned int mask = spectate_player_mask(p, last);
+        if (mask == 0) {
+            continue;
+        }
+        if (!keyframe) {
+            spectate_put_varint(i, ss);
+        }
+        spectate_put_player(p, mask, last, ss);
+    }
+    if (ss->failed) {
+        return false;
+    }
+
+    unsigned char length[SPECTATE_VARINT_SIZE];
+    const size_t length_size = spectate_encode_varint(ss->size, length);
+    // Flushed every tick, a viewer on the other end of a pipe or socket sees the game as it goes
+    if (fwrite(length, 1, length_size, ss->out) != length_size ||
+        fwrite(ss->buffer, 1, ss->size, ss->out) != ss->size ||
+        fflush(ss->out) != 0) {
+        ss->failed = true;
+        return false;
+    }
+
+    if (!spectate_state_resize(total, &ss->last)) {
+        ss->failed = true;
+        return false;
+    }
+    for (size_t i = 0; i < total; i++) {
+        if (!spectate_player_copy(game_get_player(i, g), &ss->last.players[i])) {
+            ss->failed = true;
+            return false;
+        }
+    }
+    ss->tick++;
+
+    return true;
+}
+
+void spectate_stream_deinitialize(struct spectate_stream *ss)
+{
+    if (!ss) {
+        return;
+    }
+
+    if (ss->out) {
+        fflush(ss->out);
+    }
+    spectate_state_deinitialize(&ss->last);
+    free(ss->buffer);
+    memset(ss, 0, sizeof(*ss));
+}
+
+static bool spectate_get_varint(struct spectate_cursor *c, uint64_t *value)
+{
+    uint64_t result = 0;
+    for (unsigned int shift = 0; shift < 64 && c->at < c->end; shift += 7) {
+        const unsigned char byte = *c->at++;
+        result |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool spectate_get_uint(struct spectate_cursor *c, unsigned int *value)
+{
+    uint64_t result = 0;
+    if (!spectate_get_varint(c, &result) || result > UINT_MAX) {
+        return false;
+    }
+    *value = (unsigned int)result;
+
+    return true;
+}
+
+static bool spectate_get_size(struct spectate_cursor *c, size_t *value)
+{
+    uint64_t result = 0;
+    if (!spectate_get_varint(c, &result) || result > SIZE_MAX) {
+        return false;
+    }
+    *value = (size_t)result;
+
+    return true;
+}
+
+static bool spectate_get_u8(struct spectate_cursor *c, unsigned int *value)
+{
+    if (c->at == c->end) {
+        return false;
+    }
+    *value = *c->at++;
+
+    return true;
+}
+
+/**
+ * @brief Gets the bytes left in the frame, an upper bound on the records still to come.
+ */
+static size_t spectate_remaining(const struct spectate_cursor *c)
+{
+    return (size_t)(c->end - c->at);
+}
+
+/**
+ * @brief Reads a string into a name.
+ *
+ * The view buffer holds one byte past the frame, so the string can be terminated in place
+ * for name_initialize() and the byte it covers restored after.
+ */
+static bool spectate_get_name(struct spectate_cursor *c, struct name *n)
+{
+    uint64_t length = 0;
+    if (!spectate_get_varint(c, &length) || length > (uint64_t)(c->end - c->at) || memchr(c->at, '\0', (size_t)length)) {
+        return false;
+    }
+
+    char *str = (char *)c->at;
+    const char saved = str[length];
+    str[length] = '\0';
+    const bool ok = spectate_set_name(str, n);
+    str[length] = saved;
+    c->at += length;
+
+    return ok;
+}
+
+static bool spectate_get_bool(struct spectate_cursor *c, bool *value)
+{
+    unsigned int result = 0;
+    if (!spectate_get_uint(c, &result) || result > 1) {
+        return false;
+    }
+    *value = result != 0;
+
+    return true;
+}
+
+static bool spectate_get_weapons(struct spectate_cursor *c, struct spectate_player *p)
+{
+    size_t total = 0;
+    size_t changed = 0;
+    // Weapons past the ones the view has are new and come with a record each, which bounds the allocation
+    if (!spectate_get_size(c, &total) || !spectate_get_size(c, &changed) || changed > total ||
+        changed > spectate_remaining(c) || total - changed > p->total_weapons ||
+        !spectate_player_resize_weapons(total, p)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < changed; i++) {
+        size_t index = 0;
+        unsigned int mask = 0;
+        if (!spectate_get_size(c, &index) || index >= total || !spectate_get_u8(c, &mask) || (mask & ~SPECTATE_WEAPON_ALL)) {
+            return false;
+        }
+        struct spectate_weapon *w = &p->weapons[index];
+        bool ok = true;
+        if (mask & SPECTATE_WEAPON_NAME) {
+            ok = ok && spectate_get_name(c, &w->name);
+        }
+        if (mask & SPECTATE_WEAPON_HEALTH) {
+            ok = ok && spectate_get_uint(c, &w->health);
+        }
+        if (mask & SPECTATE_WEAPON_DAMAGE) {
+            ok = ok && spectate_get_uint(c, &w->damage);
+        }
+        if (!ok) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool spectate_get_player(struct spectate_cursor *c, struct spectate_player *p)
+{
+    unsigned int mask = 0;
+    if (!spectate_get_u8(c, &mask)) {
+        return false;
+    }
+
+    bool ok = true;
+    if (mask & SPECTATE_PLAYER_NAME) {
+        ok = ok && spectate_get_name(c, &p->name);
+    }
+    if (mask & SPECTATE_PLAYER_HEALTH) {
+        ok = ok && spectate_get_uint(c, &p->health);
+    }
+    if (mask & SPECTATE_PLAYER_WEARING_ARMOR) {
+        ok = ok && spectate_get_bool(c, &p->wearing_armor);
+    }
+    if (mask & SPECTATE_PLAYER_ARMOR_NAME) {
+        ok = ok && spectate_get_name(c, &p->armor_name);
+    }
+    if (mask & SPECTATE_PLAYER_ARMOR_HEALTH) {
+        ok = ok && spectate_get_uint(c, &p->armor_health);
+    }
+    if (mask & SPECTATE_PLAYER_ARMOR_MAX_HEALTH) {
+        ok = ok && spectate_get_uint(c, &p->armor_max_health);
+    }
+    if (mask & SPECTATE_PLAYER_ARMOR_RESISTANCE) {
+        ok = ok && spectate_get_uint(c, &p->armor_resistance);
+    }
+    if (mask & SPECTATE_PLAYER_WEAPONS) {
+        ok = ok && spectate_get_weapons(c, p);
+    }
+
+    return ok;
+}
+
+/**
+ * @brief Applies a frame to the view, deltas only once synced.
+ */
+static bool spectate_view_apply(struct spectate_cursor *c, struct spectate_view *v)
+{
+    unsigned int kind = 0;
+    uint64_t tick = 0;
+    size_t total = 0;
+    if (!spectate_get_u8(c, &kind) || kind > SPECTATE_FRAME_DELTA || !spectate_get_varint(c, &tick) || !spectate_get_size(c, &total)) {
+        return false;
+    }
+
+    if (kind == SPECTATE_FRAME_DELTA) {
+        if (!v->synced) {
+            return true;
+        }
+        size_t records = 0;
+        if (!spectate_get_size(c, &records) || records > total || records > spectate_remaining(c) ||
+            total - records > v->state.total_players || !spectate_state_resize(total, &v->state)) {
+            return false;
+        }
+        for (size_t i = 0; i < records; i++) {
+            size_t index = 0;
+            if (!spectate_get_size(c, &index) || index >= total || !spectate_get_player(c, &v->state.players[index])) {
+                return false;
+            }
+        }
+    } else {
+        // A keyframe replaces everything, nothing of an earlier state may leak into it
+        if (total > spectate_remaining(c) || !spectate_state_resize(0, &v->state) || !spectate_state_resize(total, &v->state)) {
+            return false;
+        }
+        for (size_t i = 0; i < total; i++) {
+            if (!spectate_get_player(c, &v->state.players[i])) {
+                return false;
+            }
+        }
+    }
+    if (c->at != c->end) {
+        return false;
+    }
+    v->tick = tick;
+    v->synced = true;
+
+    return true;
+}
+
+/**
+ * @brief Reads the length prefix of the next frame.
+ *
+ * @return true if a length was read, false at the end of the stream or on an overlong varint.
+ */
+static bool spectate_read_length(FILE *in, uint64_t *length)
+{
+    *length = 0;
+    unsigned int shift = 0;
+    int byte = 0;
+    do {
+        byte = fgetc(in);
+        if (byte == EOF || shift >= 64) {
+            return false;
+        }
+        *length |= (uint64_t)(byte & 0x7f) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+
+    return true;
+}
+
+bool spectate_view_initialize(struct spectate_view *v)
+{
+    if (!v) {
+        return false;
+    }
+
+    memset(v, 0, sizeof(*v));
+    return true;
+}
+
+bool spectate_view_read(FILE *in, struct spectate_view *v)
+{
+    if (!in || !v) {
+        return false;
+    }
+
+    uint64_t length = 0;
+    if (!spectate_read_length(in, &length)) {
+        return false;
+    }
+    if (length > SPECTATE_MAX_FRAME) {
+        v->synced = false;
+        return false;
+    }
+
+    if (length + 1 > v->capacity) {
+        unsigned char *buffer = realloc(v->buffer, (size_t)length + 1);
+        if (!buffer) {
+            return false;
+        }
+        v->buffer = buffer;
+        v->capacity = (size_t)length + 1;
+    }
+    if (fread(v->buffer, 1, (size_t)length, in) != length) {
+        return false;
+    }
+
+    struct spectate_cursor c = { .at = v->buffer, .end = v->buffer + length };
+    if (!spectate_view_apply(&c, v)) {
+        // Half applied, wait for the next keyframe
+        v->synced = false;
+        return false;
+    }
+
+    return true;
+}
+
+bool spectate_view_skip(FILE *in)
+{
+    if (!in) {
+        return false;
+    }
+
+    uint64_t length = 0;
+    if (!spectate_read_length(in, &length) || length > SPECTATE_MAX_FRAME) {
+        return false;
+    }
+    // Read rather than seek, so pipes and sockets can be skipped too
+    unsigned char discard[4096];
+    while (length > 0) {
+        const size_t chunk = length < sizeof(discard) ? (size_t)length : sizeof(discard);
+        if (fread(discard, 1, chunk, in) != chunk) {
+            return false;
+        }
+        length -= chunk;
+    }
+
+    return true;
+}
+
+void spectate_view_deinitialize(struct spectate_view *v)
+{
+    if (!v) {
+        return;
+    }
+
+    spectate_state_deinitialize(&v->state);
+    free(v->buffer);
+    memset(v, 0, sizeof(*v));
+}
@@ -0,0 +1,85 @@
+/*! Single producer single consumer queue implementation file */
+
+#include "headers/spsc_queue.h"
+#include <stdlib.h>
+#include <string.h>
+
+bool spsc_queue_initialize(const size_t capacity, const size_t e_size, struct spsc_queue *q)
+{
+    if (capacity == 0 || e_size == 0 || !q) {
+        return false;
+    }
+
+    size_t rounded = 1;
+    while (rounded < capacity) {
+        rounded <<= 1;
+    }
+
+    q->items = malloc(rounded * e_size);
+    if (!q->items) {
+        return false;
+    }
+    q->e_size = e_size;
+    q->capacity = rounded;
+    atomic_init(&q->head, 0);
+    atomic_init(&q->tail, 0);
+    q->cached_head = 0;
+    q->cached_tail = 0;
+
+    return true;
+}
+
+bool spsc_queue_push(struct spsc_queue *q, const void *element)
+{
+    if (!q || !element) {
+        return false;
+    }
+
+    const size_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    if (tail - q->cached_head == q->capacity) {
+        // Only touch the consumer's cache line when the queue looks full
+        q->cached_head = atomic_load_explicit(&q->head, memory_order_acquire);
+        if (tail - q->cached_head == q->capacity) {
+            return false;
+        }
+    }
+
+    void *dest = (char *)q->items + (tail & (q->capacity - 1)) * q->e_size;
+    memcpy(dest, element, q->e_size);
+    atomic_store_explicit(&q->tail, tail + 1, memory_order_release);
+
+    return true;
+}
+
+bool spsc_queue_pop(struct spsc_queue *q, void *element)
+{
+    if (!q || !element) {
+        return false;
+    }
+
+    const size_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    if (head == q->cached_tail) {
+        q->cached_tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+        if (head == q->cached_tail) {
+            return false;
+        }
+    }
+
+    const void *src = (const char *)q->items + (head & (q->capacity - 1)) * q->e_size;
+    memcpy(element, src, q->e_size);
+    atomic_store_explicit(&q->head, head + 1, memory_order_release);
+
+    return true;
+}
+
+void spsc_queue_deinitialize(struct spsc_queue *q)
+{
+    if (!q || !q->items) {
+        return;
+    }
+
+    free(q->items);
+    q->items = NULL;
+    q->e_size = 0;
+    q->capacity = 0;
+}
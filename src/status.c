@@ -0,0 +1,295 @@
+/*! Status effects implementation file */
+
+#include "headers/status.h"
+#include "headers/player.h"
+#include <stdlib.h>
+#include <string.h>
+
+/** Marks the end of a slot or free list. */
+#define STATUS_NIL UINT32_MAX
+/** Mask of a slot index within a level. */
+#define STATUS_SLOT_MASK (STATUS_WHEEL_SLOTS - 1)
+
+/**
+ * @struct status_timer
+ * @brief Pool entry holding an effect and its place in the wheel.
+ */
+struct status_timer {
+    /** Effect to apply. */
+    struct status_effect effect;
+    /** Tick the effect fires next. */
+    uint64_t deadline;
+    /** Next timer in the same slot, or in the free list. */
+    uint32_t next;
+    /** Previous timer in the same slot. */
+    uint32_t prev;
+    /** Bumped on release so stale ids are rejected. */
+    uint32_t generation;
+    /** Level of the slot holding the timer. */
+    uint8_t level;
+    /** Slot holding the timer. */
+    uint8_t slot;
+    /** Set while the timer is in the wheel. */
+    bool active;
+};
+
+static struct status_timer *status_timer_at(const struct status_wheel *sw, const uint32_t index)
+{
+    return (struct status_timer *)vector_items(&sw->timers) + index;
+}
+
+/**
+ * @brief Links a timer into the slot matching its deadline.
+ *
+ * The level is the highest wheel digit where the deadline differs from now, so the slot
+ * is reached no later than the deadline. Deadlines past the top level wrap around it,
+ * which STATUS_MAX_PERIOD keeps in range.
+ */
+static void status_wheel_link(const uint32_t index, struct status_wheel *sw)
+{
+    struct status_timer *t = status_timer_at(sw, index);
+    const uint64_t differing = t->deadline ^ sw->now;
+
+    unsigned int level = 0;
+    while (level < STATUS_WHEEL_LEVELS - 1 && (differing >> (STATUS_WHEEL_BITS * (level + 1))) != 0) {
+        level++;
+    }
+    const unsigned int slot = (unsigned int)(t->deadline >> (STATUS_WHEEL_BITS * level)) & STATUS_SLOT_MASK;
+
+    t->level = (uint8_t)level;
+    t->slot = (uint8_t)slot;
+    t->prev = STATUS_NIL;
+    t->next = sw->slots[level][slot];
+    if (t->next != STATUS_NIL) {
+        status_timer_at(sw, t->next)->prev = index;
+    }
+    sw->slots[level][slot] = index;
+}
+
+static void status_wheel_unlink(const uint32_t index, struct status_wheel *sw)
+{
+    struct status_timer *t = status_timer_at(sw, index);
+    if (t->prev != STATUS_NIL) {
+        status_timer_at(sw, t->prev)->next = t->next;
+    } else {
+        sw->slots[t->level][t->slot] = t->next;
+    }
+    if (t->next != STATUS_NIL) {
+        status_timer_at(sw, t->next)->prev = t->prev;
+    }
+}
+
+static void status_wheel_release(const uint32_t index, struct status_wheel *sw)
+{
+    struct status_timer *t = status_timer_at(sw, index);
+    t->active = false;
+    t->generation++;
+    t->next = sw->free_head;
+    sw->free_head = index;
+    sw->total_active--;
+}
+
+bool status_wheel_initialize(const size_t initial_capacity, struct status_wheel *sw)
+{
+    if (!sw) {
+        return false;
+    }
+
+    memset(sw, 0, sizeof(*sw));
+    if (!vector_initialize(initial_capacity ? initial_capacity : 1, sizeof(struct status_timer), &sw->timers)) {
+        return false;
+    }
+    sw->free_head = STATUS_NIL;
+    for (size_t level = 0; level < STATUS_WHEEL_LEVELS; level++) {
+        for (size_t slot = 0; slot < STATUS_WHEEL_SLOTS; slot++) {
+            sw->slots[level][slot] = STATUS_NIL;
+        }
+    }
+    return true;
+}
+
+bool status_wheel_add(const struct status_effect *effect, uint64_t *id, struct status_wheel *sw)
+{
+    if (!effect || !sw || effect->period == 0 || effect->period > STATUS_MAX_PERIOD || effect->remaining == 0
+        || (effect->kind == STATUS_EFFECT_WEAPON_WEAR && !memchr(effect->weapon_name, '\0', STATUS_WEAPON_NAME_SIZE))) {
+        return false;
+    }
+
+    uint32_t index = sw->free_head;
+    if (index != STATUS_NIL) {
+        sw->free_head = status_timer_at(sw, index)->next;
+    } else {
+        if (sw->timers.size >= STATUS_NIL) {
+            return false;
+        }
+        const struct status_timer fresh = {0};
+        if (!vector_push_back(&sw->timers, &fresh)) {
+            return false;
+        }
+        index = (uint32_t)(sw->timers.size - 1);
+    }
+
+    struct status_timer *t = status_timer_at(sw, index);
+    t->effect = *effect;
+    t->deadline = sw->now + effect->period;
+    t->active = true;
+    status_wheel_link(index, sw);
+    sw->total_active++;
+
+    if (id) {
+        *id = ((uint64_t)t->generation << 32) | index;
+    }
+    return true;
+}
+
+bool status_wheel_cancel(const uint64_t id, struct status_wheel *sw)
+{
+    const uint32_t index = (uint32_t)id;
+    if (!sw || index >= sw->timers.size) {
+        return false;
+    }
+
+    const struct status_timer *t = status_timer_at(sw, index);
+    if (!t->active || t->generation != (uint32_t)(id >> 32)) {
+        return false;
+    }
+
+    status_wheel_unlink(index, sw);
+    status_wheel_release(index, sw);
+    return true;
+}
+
+void status_wheel_remove_player(const size_t player_index, struct status_wheel *sw)
+{
+    if (!sw) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < sw->timers.size; i++) {
+        struct status_timer *t = status_timer_at(sw, i);
+        if (!t->active) {
+            continue;
+        }
+        if (t->effect.player_index == player_index) {
+            status_wheel_unlink(i, sw);
+            status_wheel_release(i, sw);
+        } else if (t->effect.player_index > player_index) {
+            t->effect.player_index--;
+        }
+    }
+}
+
+/**
+ * @brief Applies an effect once.
+ *
+ * @return false if the effect's player is gone or dead and the effect should be dropped.
+ */
+static bool status_effect_apply(const struct status_effect *effect, struct game *g)
+{
+    struct player *p = game_get_player_mut(effect->player_index, g);
+    if (!p || p->health == 0) {
+        return false;
+    }
+
+    switch (effect->kind) {
+        case STATUS_EFFECT_POISON:
+            player_take_damage(effect->magnitude, p);
+            break;
+        case STATUS_EFFECT_REGENERATION:
+            player_heal(effect->magnitude, p);
+            break;
+        case STATUS_EFFECT_ARMOR_DECAY:
+            player_wear_armor(effect->magnitude, p);
+            break;
+        case STATUS_EFFECT_WEAPON_WEAR:
+            return player_wear_weapon(effect->weapon_name, effect->magnitude, p);
+    }
+    return true;
+}
+
+/**
+ * @brief Moves every timer of a slot to the levels below, now that the slot's time has come.
+ */
+static void status_wheel_cascade(const unsigned int level, struct status_wheel *sw)
+{
+    const unsigned int slot = (unsigned int)(sw->now >> (STATUS_WHEEL_BITS * level)) & STATUS_SLOT_MASK;
+    uint32_t index = sw->slots[level][slot];
+    sw->slots[level][slot] = STATUS_NIL;
+
+    while (index != STATUS_NIL) {
+        const uint32_t next = status_timer_at(sw, index)->next;
+        status_wheel_link(index, sw);
+        index = next;
+    }
+}
+
+/**
+ * @brief Advances one tick and fires the timers due on it.
+ *
+ * @return Number of effects fired.
+ */
+static size_t status_wheel_tick(struct game *g, struct status_wheel *sw)
+{
+    sw->now++;
+
+    unsigned int top = 0;
+    while (top < STATUS_WHEEL_LEVELS - 1 && (sw->now & ((1ull << (STATUS_WHEEL_BITS * (top + 1))) - 1)) == 0) {
+        top++;
+    }
+    for (unsigned int level = top; level >= 1; level--) {
+        status_wheel_cascade(level, sw);
+    }
+
+    const unsigned int slot = (unsigned int)sw->now & STATUS_SLOT_MASK;
+    uint32_t index = sw->slots[0][slot];
+    sw->slots[0][slot] = STATUS_NIL;
+
+    size_t fired = 0;
+    while (index != STATUS_NIL) {
+        struct status_timer *t = status_timer_at(sw, index);
+        const uint32_t next = t->next;
+
+        const bool applied = status_effect_apply(&t->effect, g);
+        fired += applied;
+        if (applied && --t->effect.remaining > 0) {
+            t->deadline += t->effect.period;
+            status_wheel_link(index, sw);
+        } else {
+            status_wheel_release(index, sw);
+        }
+        index = next;
+    }
+    return fired;
+}
+
+size_t status_wheel_advance(const uint64_t ticks, struct game *g, struct status_wheel *sw)
+{
+    if (!sw) {
+        return 0;
+    }
+
+    size_t fired = 0;
+    for (uint64_t i = 0; i < ticks; i++) {
+        if (sw->total_active == 0) {
+            sw->now += ticks - i;
+            break;
+        }
+        fired += status_wheel_tick(g, sw);
+    }
+    return fired;
+}
+
+size_t status_wheel_get_total_active(const struct status_wheel *sw)
+{
+    return sw ? sw->total_active : 0;
+}
+
+void status_wheel_deinitialize(struct status_wheel *sw)
+{
+    if (!sw) {
+        return;
+    }
+
+    vector_deinitialize(&sw->timers);
+    memset(sw, 0, sizeof(*sw));
+}
@@ -62,7 +62,7 @@ uint32_t pcg32_random_r(pcg32_random_t* rng)
     // Standard LCG formula, magic value is carefully chosen to ensure randomness.
     rng->state = oldstate * 6364136223846793005ULL + rng->inc;
     // Mix the bits of old state, reduces the 64-bit state down to 32 bits with good distribution.
-    uint32_t xorshifted = (uint32_t)((oldstate >> 18u) ^ oldstate) >> 27u;
+    uint32_t xorshifted = (uint32_t)(((oldstate >> 18u) ^ oldstate) >> 27u);
     // Take the top 5 bits of oldstate to determine how much to rotate, gives value between 0 and 31.
     uint32_t rot = oldstate >> 59u;
     // bitwise rotate right, ensures full use of entropy and rotation amount varies dynamically, adding more randomness to the output.
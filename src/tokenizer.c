@@ -0,0 +1,289 @@
+/*! Tokenizer implementation file */
+
+#include "headers/tokenizer.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+/**
+ * @brief Checks for the whitespace characters separating tokens.
+ *
+ * @param[in] c Character to check.
+ * @return true if c is whitespace, false otherwise.
+ */
+static inline bool is_space(const char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+struct string_view string_view_from_cstr(const char *str)
+{
+    struct string_view sv = {0};
+    if (!str) {
+        return sv;
+    }
+
+    sv.data = str;
+    sv.length = strlen(str);
+    return sv;
+}
+
+bool string_view_equals(const struct string_view sv, const char *str)
+{
+    if (!str) {
+        return false;
+    }
+
+    size_t length = strlen(str);
+    return sv.length == length && (length == 0 || memcmp(sv.data, str, length) == 0);
+}
+
+struct string_view string_view_trim(const struct string_view sv)
+{
+    struct string_view trimmed = sv;
+    while (trimmed.length > 0 && is_space(trimmed.data[0])) {
+        trimmed.data++;
+        trimmed.length--;
+    }
+    while (trimmed.length > 0 && is_space(trimmed.data[trimmed.length - 1])) {
+        trimmed.length--;
+    }
+
+    return trimmed;
+}
+
+bool string_view_copy(const struct string_view sv, const size_t size, char *dest)
+{
+    if (!dest || size == 0) {
+        return false;
+    }
+
+    if (sv.length >= size) {
+        dest[0] = '\0';
+        return false;
+    }
+
+    if (sv.length > 0) {
+        memcpy(dest, sv.data, sv.length);
+    }
+    dest[sv.length] = '\0';
+    return true;
+}
+
+bool string_view_parse_uint(const struct string_view sv, unsigned int *out_val)
+{
+    if (!out_val || !sv.data || sv.length == 0) {
+        return false;
+    }
+
+    unsigned int val = 0;
+    for (size_t i = 0; i < sv.length; i++) {
+        // Unsigned wrap turns every non digit into a value above 9
+        const unsigned int digit = (unsigned int)(unsigned char)sv.data[i] - '0';
+        if (digit > 9) {
+            return false;
+        }
+        if (val > (UINT_MAX - digit) / 10) {
+            return false;
+        }
+        val = val * 10 + digit;
+    }
+
+    *out_val = val;
+    return true;
+}
+
+bool tokenizer_initialize(const char *buffer, const size_t length, struct tokenizer *t)
+{
+    if (!t || (!buffer && length > 0)) {
+        return false;
+    }
+
+    t->cursor = buffer;
+    t->end = buffer ? buffer + length : NULL;
+    return true;
+}
+
+bool tokenizer_next_line(struct tokenizer *t, struct string_view *line)
+{
+    if (!t || !line || t->cursor >= t->end) {
+        return false;
+    }
+
+    const char *start = t->cursor;
+    const char *newline = memchr(start, '\n', (size_t)(t->end - start));
+    const char *line_end = newline ? newline : t->end;
+    t->cursor = newline ? newline + 1 : t->end;
+
+    if (line_end > start && line_end[-1] == '\r') {
+        line_end--;
+    }
+
+    line->data = start;
+    line->length = (size_t)(line_end - start);
+    return true;
+}
+
+bool tokenizer_next_token(struct tokenizer *t, struct string_view *token)
+{
+    if (!t || !token) {
+        return false;
+    }
+
+    const char *c = t->cursor;
+    while (c < t->end && is_space(*c)) {
+        c++;
+    }
+    if (c >= t->end) {
+        t->cursor = t->end;
+        return false;
+    }
+
+    const char *start = c;
+    while (c < t->end && !is_space(*c)) {
+        c++;
+    }
+
+    token->data = start;
+    token->length = (size_t)(c - start);
+    t->cursor = c;
+    return true;
+}
+
+struct string_view tokenizer_remaining(const struct tokenizer *t)
+{
+    struct string_view rest = {0};
+    if (!t || t->cursor >= t->end) {
+        return rest;
+    }
+
+    rest.data = t->cursor;
+    rest.length = (size_t)(t->end - t->cursor);
+    return string_view_trim(rest);
+}
+
+bool line_reader_initialize(FILE *file, const size_t block_size, struct line_reader *lr)
+{
+    if (!file || block_size == 0 || !lr) {
+        return false;
+    }
+
+    lr->buffer = malloc(block_size);
+    if (!lr->buffer) {
+        return false;
+    }
+    lr->file = file;
+    lr->capacity = block_size;
+    lr->start = 0;
+    lr->end = 0;
+    lr->eof = false;
+    lr->failed = false;
+
+    return true;
+}
+
+/**
+ * @brief Moves the unread tail to the front of the buffer and reads another block after it.
+ *
+ * @param[in,out] lr Pointer to line reader struct.
+ * @return true if more data was read, false at the end of the file or on error, which sets failed.
+ */
+static bool line_reader_refill(struct line_reader *lr)
+{
+    if (lr->eof || lr->failed) {
+        return false;
+    }
+
+    const size_t pending = lr->end - lr->start;
+    if (lr->start > 0 && pending > 0) {
+        memmove(lr->buffer, lr->buffer + lr->start, pending);
+    }
+    lr->start = 0;
+    lr->end = pending;
+
+    // A single line longer than the buffer, grow it
+    if (lr->end == lr->capacity) {
+        char *new_block = realloc(lr->buffer, lr->capacity * 2);
+        if (!new_block) {
+            lr->failed = true;
+            return false;
+        }
+        lr->buffer = new_block;
+        lr->capacity *= 2;
+    }
+
+    const size_t read = fread(lr->buffer + lr->end, 1, lr->capacity - lr->end, lr->file);
+    if (read == 0) {
+        // A read error is not the end of the file, the pending bytes may not be a whole line
+        lr->failed = ferror(lr->file) != 0;
+        lr->eof = !lr->failed;
+        return false;
+    }
+    lr->end += read;
+
+    return true;
+}
+
+bool line_reader_next_line(struct line_reader *lr, struct string_view *line)
+{
+    if (!lr || !lr->buffer || !line || lr->failed) {
+        return false;
+    }
+
+    size_t scanned = 0;
+    for (;;) {
+        const char *start = lr->buffer + lr->start;
+        const size_t pending = lr->end - lr->start;
+        const char *newline = memchr(start + scanned, '\n', pending - scanned);
+
+        if (newline) {
+            size_t length = (size_t)(newline - start);
+            lr->start += length + 1;
+            if (length > 0 && start[length - 1] == '\r') {
+                length--;
+            }
+            line->data = start;
+            line->length = length;
+            return true;
+        }
+
+        scanned = pending;
+        if (!line_reader_refill(lr)) {
+            break;
+        }
+    }
+    if (lr->failed) {
+        return false;
+    }
+
+    // Last line without a terminator
+    if (lr->end > lr->start) {
+        const char *start = lr->buffer + lr->start;
+        size_t length = lr->end - lr->start;
+        lr->start = lr->end;
+        if (start[length - 1] == '\r') {
+            length--;
+        }
+        line->data = start;
+        line->length = length;
+        return true;
+    }
+
+    return false;
+}
+
+bool line_reader_has_failed(const struct line_reader *lr)
+{
+    return lr && lr->failed;
+}
+
+void line_reader_deinitialize(struct line_reader *lr)
+{
+    if (!lr || !lr->buffer) {
+        return;
+    }
+
+    free(lr->buffer);
+    memset(lr, 0, sizeof(*lr));
+}
@@ -0,0 +1,240 @@
+/*! Trace recorder implementation file */
+
+#include "headers/trace.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+#include <time.h>
+
+static_assert((TRACE_BUFFER_EVENTS & (TRACE_BUFFER_EVENTS - 1)) == 0, "TRACE_BUFFER_EVENTS must be a power of two");
+
+/**
+ * @struct trace_event
+ * @brief One recorded event.
+ */
+struct trace_event {
+    /** Name given by the caller. */
+    const char *name;
+    /** Nanoseconds since recording started. */
+    uint64_t timestamp_ns;
+    /** Chrome trace phase: 'B' begin, 'E' end, 'i' instant. */
+    char phase;
+};
+
+/**
+ * @struct trace_buffer
+ * @brief Ring of events of one thread, only written by that thread.
+ */
+struct trace_buffer {
+    /** Ring of the last events. */
+    struct trace_event events[TRACE_BUFFER_EVENTS];
+    /** Events recorded, the next one goes to total % TRACE_BUFFER_EVENTS. */
+    uint64_t total;
+    /** Thread id written to the trace. */
+    unsigned int thread;
+    /** Next buffer of the list. */
+    struct trace_buffer *next;
+};
+
+/** Set while recording. */
+static atomic_bool trace_recording = false;
+/** Bumped by every trace_initialize(), so threads drop buffers of an earlier recording. */
+static atomic_uint trace_generation = 0;
+/** Guards trace_buffers and trace_threads. */
+static mtx_t trace_lock;
+/** Initializes trace_lock once. */
+static once_flag trace_lock_once = ONCE_FLAG_INIT;
+/** Every thread's buffer. */
+static struct trace_buffer *trace_buffers = NULL;
+/** Threads that recorded so far. */
+static unsigned int trace_threads = 0;
+/** File to write, owned. */
+static char *trace_path = NULL;
+/** When recording started, in nanoseconds. */
+static uint64_t trace_origin_ns = 0;
+
+/** Buffer of the calling thread. */
+static _Thread_local struct trace_buffer *trace_local = NULL;
+/** Recording trace_local belongs to. */
+static _Thread_local unsigned int trace_local_generation = 0;
+
+static void trace_init_lock(void)
+{
+    mtx_init(&trace_lock, mtx_plain);
+}
+
+static uint64_t trace_now_ns(void)
+{
+    struct timespec now = {0};
+    timespec_get(&now, TIME_UTC);
+    return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+static void trace_at_exit(void)
+{
+    trace_deinitialize();
+}
+
+/**
+ * @brief Gets the buffer of the calling thread, registering a new one on its first event.
+ */
+static struct trace_buffer *trace_local_buffer(void)
+{
+    const unsigned int generation = atomic_load_explicit(&trace_generation, memory_order_acquire);
+    if (trace_local && trace_local_generation == generation) {
+        return trace_local;
+    }
+
+    struct trace_buffer *b = malloc(sizeof(*b));
+    if (!b) {
+        return NULL;
+    }
+    b->total = 0;
+
+    mtx_lock(&trace_lock);
+    b->thread = trace_threads++;
+    b->next = trace_buffers;
+    trace_buffers = b;
+    mtx_unlock(&trace_lock);
+
+    trace_local = b;
+    trace_local_generation = generation;
+    return b;
+}
+
+static void trace_record(const char *name, const char phase)
+{
+    if (!name || !atomic_load_explicit(&trace_recording, memory_order_acquire)) {
+        return;
+    }
+
+    struct trace_buffer *b = trace_local_buffer();
+    if (!b) {
+        return;
+    }
+
+    struct trace_event *e = &b->events[b->total & (TRACE_BUFFER_EVENTS - 1)];
+    e->name = name;
+    e->timestamp_ns = trace_now_ns() - trace_origin_ns;
+    e->phase = phase;
+    b->total++;
+}
+
+/**
+ * @brief Writes a string as a JSON string literal.
+ */
+static void trace_write_string(FILE *out, const char *str)
+{
+    fputc('"', out);
+    for (const char *c = str; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            fputc('\\', out);
+            fputc(*c, out);
+        } else if ((unsigned char)*c < 0x20) {
+            fprintf(out, "\\u%04x", (unsigned int)(unsigned char)*c);
+        } else {
+            fputc(*c, out);
+        }
+    }
+    fputc('"', out);
+}
+
+/**
+ * @brief Writes every buffered event in the Chrome trace event format.
+ */
+static bool trace_write(FILE *out)
+{
+    bool first = true;
+    fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    for (const struct trace_buffer *b = trace_buffers; b; b = b->next) {
+        // Once a ring wrapped, its oldest event is the one about to be overwritten
+        const uint64_t start = b->total > TRACE_BUFFER_EVENTS ? b->total - TRACE_BUFFER_EVENTS : 0;
+        for (uint64_t i = start; i < b->total; i++) {
+            const struct trace_event *e = &b->events[i & (TRACE_BUFFER_EVENTS - 1)];
+            fprintf(out, "%s\n{\"name\":", first ? "" : ",");
+            trace_write_string(out, e->name);
+            fprintf(out, ",\"ph\":\"%c\",\"ts\":%llu.%03u,\"pid\":1,\"tid\":%u%s}",
+                    e->phase, (unsigned long long)(e->timestamp_ns / 1000), (unsigned int)(e->timestamp_ns % 1000),
+                    b->thread, e->phase == 'i' ? ",\"s\":\"t\"" : "");
+            first = false;
+        }
+    }
+    fprintf(out, "\n]}\n");
+    return !ferror(out);
+}
+
+bool trace_initialize(const char *path)
+{
+    static atomic_bool registered = false;
+    if (!path || path[0] == '\0' || atomic_load(&trace_recording)) {
+        return false;
+    }
+
+    call_once(&trace_lock_once, trace_init_lock);
+    const size_t length = strlen(path);
+    trace_path = malloc(length + 1);
+    if (!trace_path) {
+        return false;
+    }
+    memcpy(trace_path, path, length + 1);
+
+    if (!atomic_exchange(&registered, true) && atexit(trace_at_exit) != 0) {
+        atomic_store(&registered, false);
+        free(trace_path);
+        trace_path = NULL;
+        return false;
+    }
+
+    trace_origin_ns = trace_now_ns();
+    atomic_fetch_add_explicit(&trace_generation, 1, memory_order_release);
+    atomic_store_explicit(&trace_recording, true, memory_order_release);
+    return true;
+}
+
+void trace_begin(const char *name)
+{
+    trace_record(name, 'B');
+}
+
+void trace_end(const char *name)
+{
+    trace_record(name, 'E');
+}
+
+void trace_instant(const char *name)
+{
+    trace_record(name, 'i');
+}
+
+bool trace_deinitialize(void)
+{
+    if (!atomic_exchange(&trace_recording, false)) {
+        return false;
+    }
+
+    bool ok = false;
+    FILE *out = fopen(trace_path, "w");
+    if (out) {
+        ok = trace_write(out);
+        ok = fclose(out) == 0 && ok;
+    }
+    if (!ok) {
+        fprintf(stderr, "cannot write trace to %s at trace_deinitialize()\n", trace_path);
+    }
+
+    mtx_lock(&trace_lock);
+    while (trace_buffers) {
+        struct trace_buffer *next = trace_buffers->next;
+        free(trace_buffers);
+        trace_buffers = next;
+    }
+    trace_threads = 0;
+    mtx_unlock(&trace_lock);
+    free(trace_path);
+    trace_path = NULL;
+
+    return ok;
+}
@@ -1,58 +1,97 @@
 /*! Vector implementation file */
 
 #include <stdlib.h>
-#include <stdio.h>
 #include <string.h>
-#include "vector.h"
+#include "headers/vector.h"
+#include "headers/alloc.h"
+#include "headers/error.h"
+
+/**
+ * @brief Doubles the capacity until total elements fit.
+ *
+ * @return false on allocation failure, the vector is then unchanged.
+ */
+static bool vector_grow(const size_t total, struct vector *vec)
+{
+    if (total <= vec->capacity) {
+        return true;
+    }
+
+    // Avoid multiplying zero
+    size_t capacity = vec->capacity ? vec->capacity : 1;
+    while (capacity < total) {
+        capacity *= 2;
+    }
+
+    // Inline elements spill to the heap, heap elements grow in place
+    void *new_block = alloc_realloc(vec->_heap, capacity * vec->e_size, ALLOC_TAG_VECTOR);
+    if (!new_block) {
+        return false;
+    }
+    if (!vec->_heap) {
+        memcpy(new_block, vec->_inline.bytes, vec->size * vec->e_size);
+    }
+    vec->_heap = new_block;
+    vec->capacity = capacity;
+
+    return true;
+}
 
 bool vector_initialize(const size_t capacity, const size_t e_size, struct vector *vec)
 {
     if (capacity == 0) {
-        fprintf(stderr, "capacity is 0 at vector_initialize()\n");
-        return false;
+        return error_set(ERROR_INVALID_ARGUMENT, "vector_initialize");
     }
 
     if (e_size == 0) {
-        fprintf(stderr, "element size is 0 at vector_initialize()\n");
-        return false;
+        return error_set(ERROR_INVALID_ARGUMENT, "vector_initialize");
     }
 
-    vec->items = malloc(e_size * capacity);
-    if (!vec->items) {
-        fprintf(stderr, "malloc failed at vector_initialize()\n");
-        return false;
-    }
     vec->e_size = e_size;
-    memset(vec->items, 0, e_size);
-    vec->capacity = capacity;
+    if (capacity * e_size <= VECTOR_INLINE_SIZE) {
+        vec->_heap = NULL;
+        vec->capacity = VECTOR_INLINE_SIZE / e_size;
+    } else {
+        vec->_heap = alloc_malloc(e_size * capacity, ALLOC_TAG_VECTOR);
+        if (!vec->_heap) {
+            return error_set(ERROR_OUT_OF_MEMORY, "vector_initialize");
+        }
+        vec->capacity = capacity;
+    }
+    memset(vector_items(vec), 0, e_size);
 
     return true;
 }
 
+void *vector_items(const struct vector *vec)
+{
+    if (!vec) {
+        return NULL;
+    }
+
+    return vec->_heap ? vec->_heap : (void *)vec->_inline.bytes;
+}
+
 bool vector_search_element(const struct vector *vec, const void *key, void *element, cmp_func cmp)
 {
     if (!vec) {
-        fprintf(stderr, "vector is null at vector_search_element()\n");
-        return false;
+        return error_set(ERROR_NULL_ARGUMENT, "vector_search_element");
     }
 
-    if (!vec->items) {
-        fprintf(stderr, "vector is empty at vector_search_element()\n");
-        return false;
+    if (vec->e_size == 0) {
+        return error_set(ERROR_INVALID_ARGUMENT, "vector_search_element");
     }
 
     if (!key) {
-        fprintf(stderr, "key is null at vector_search_element()\n");
-        return false;
+        return error_set(ERROR_NULL_ARGUMENT, "vector_search_element");
     }
 
     if (!cmp) {
-        fprintf(stderr, "comparision function is null at vector_search_element()\n");
-        return false;
+        return error_set(ERROR_NULL_ARGUMENT, "vector_search_element");
     }
 
     for (size_t i = 0; i < vec->size; i++) {
-        void *vec_element = (char *)vec->items + i * vec->e_size;
+        void *vec_element = (char *)vector_items(vec) + i * vec->e_size;
         if (cmp(vec_element, key)) {
             if (element) {
                 memcpy(element, vec_element, vec->e_size);
@@ -61,27 +100,24 @@ bool vector_search_element(const struct vector *vec, const void *key, void *elem
         }
     }
 
-    return false;
+    return error_set(ERROR_NOT_FOUND, "vector_search_element");
 }
 
 bool vector_get_element(const struct vector *vec, const size_t index, void *element)
 {
     if (!vec) {
-        fprintf(stderr, "vector is null at vector_get_element()\n");
-        return false;
+        return error_set(ERROR_NULL_ARGUMENT, "vector_get_element");
     }
 
     if (!element) {
-        fprintf(stderr, "element is null at vector_get_element()\n");
-        return false;
+        return error_set(ERROR_NULL_ARGUMENT, "vector_get_element");
     }
 
     if (index >= vec->size) {
-        fprintf(stderr, "index is greater than vector size at vector_get_element()\n");
-        return false;
+        return error_set(ERROR_OUT_OF_RANGE, "vector_get_element");
     }
 
-    void *src = (char *)vec->items + (index * vec->e_size);
+    void *src = (char *)vector_items(vec) + (index * vec->e_size);
     memcpy(element, src, vec->e_size);
 
     return true;
@@ -90,35 +126,38 @@ bool vector_get_element(const struct vector *vec, const size_t index, void *elem
 bool vector_push_back(struct vector *vec, const void *element)
 {
     if (!vec) {
-        fprintf(stderr, "vector is null at vector_push_back()\n");
-        return false;
+        return error_set(ERROR_NULL_ARGUMENT, "vector_push_back");
     }
 
     if (!element) {
-        fprintf(stderr, "element is null at vector_push_back()\n");
-        return false;
+        return error_set(ERROR_NULL_ARGUMENT, "vector_push_back");
     }
 
-    if (vec->size >= vec->capacity) {
-        // Avoid multiplying zero
-        vec->capacity = vec->capacity ? vec->capacity * 2 : 1;
-
-        void *new_block = realloc(vec->items, vec->capacity * vec->e_size);
-        if (!new_block) {
-            fprintf(stderr, "realloc failed at vector_push_back()\n");
-            return false;
-        }
-        vec->items = new_block;
+    if (!vector_grow(vec->size + 1, vec)) {
+        return error_set(ERROR_OUT_OF_MEMORY, "vector_push_back");
     }
     
     size_t offset = vec->size * vec->e_size;
-    void *dest = (char *)vec->items + offset; // char* for advancing 1 byte
+    void *dest = (char *)vector_items(vec) + offset; // char* for advancing 1 byte
     memcpy(dest, element, vec->e_size);
     vec->size++;
 
     return true;
 }
 
+bool vector_reserve(struct vector *vec, const size_t capacity)
+{
+    if (!vec || vec->e_size == 0) {
+        return error_set(vec ? ERROR_INVALID_ARGUMENT : ERROR_NULL_ARGUMENT, "vector_reserve");
+    }
+
+    if (!vector_grow(capacity, vec)) {
+        return error_set(ERROR_OUT_OF_MEMORY, "vector_reserve");
+    }
+
+    return true;
+}
+
 /*
 removing C
 
@@ -131,17 +170,16 @@ copying from right (higher memory address) to left (lower memory address)
 bool vector_pop_search(struct vector *vec, const void *element)
 {
     if (!vec) {
-        fprintf(stderr, "vector is null at vector_pop_search()\n");
-        return false;
+        return error_set(ERROR_NULL_ARGUMENT, "vector_pop_search");
     }
 
     if (!element) {
-        fprintf(stderr, "element is null at vector_pop_search()\n");
-        return false;
+        return error_set(ERROR_NULL_ARGUMENT, "vector_pop_search");
     }
 
+    char *items = vector_items(vec);
     for (size_t i = 0; i < vec->size; i++) {
-        void *current = (char*)vec->items + i * vec->e_size;
+        void *current = items + i * vec->e_size;
         // Compare current element with the target element
         if (memcmp(current, element, vec->e_size) == 0) {
             // Found the element to remove
@@ -149,8 +187,8 @@ bool vector_pop_search(struct vector *vec, const void *element)
             // Shift all elements after i one slot to the left
             for (size_t j = i + 1; j < vec->size; j++) {
                 size_t byte_offset = j * vec->e_size;
-                void *src = (char*)vec->items + byte_offset;            // calculates address at index j
-                void *dest = (char*)vec->items + (j - 1) * vec->e_size; // calculates address at index just before j
+                void *src = items + byte_offset;            // calculates address at index j
+                void *dest = items + (j - 1) * vec->e_size; // calculates address at index just before j
                 memcpy(dest, src, vec->e_size);
             }
 
@@ -159,33 +197,30 @@ bool vector_pop_search(struct vector *vec, const void *element)
         }
     }
 
-    return false;
+    return error_set(ERROR_NOT_FOUND, "vector_pop_search");
 }
 
 bool vector_pop_index(struct vector *vec, const size_t index, void *element)
 {
     if (!vec) {
-        fprintf(stderr, "vector is null at vector_pop_index()\n");
-        return false;
+        return error_set(ERROR_NULL_ARGUMENT, "vector_pop_index");
     }
 
     if (!element) {
-        fprintf(stderr, "element is null at vector_pop_index()\n");
-        return false;
+        return error_set(ERROR_NULL_ARGUMENT, "vector_pop_index");
     }
 
     if (index >= vec->size) {
-        fprintf(stderr, "index is out of bounds at vector_pop_index()\n");
-        return false;
+        return error_set(ERROR_OUT_OF_RANGE, "vector_pop_index");
     }
 
     // Get pointer to the element to pop
-    void *ele_ptr = (char *)vec->items + (index * vec->e_size);
+    void *ele_ptr = (char *)vector_items(vec) + (index * vec->e_size);
     memcpy(element, ele_ptr, vec->e_size); // Copy to output
 
     // Shift remaining elements left
     if (index < vec->size - 1) {
-        void *src = (char *)vec->items + ((index + 1) * vec->e_size);
+        void *src = (char *)vector_items(vec) + ((index + 1) * vec->e_size);
         memmove(ele_ptr, src, (vec->size - index - 1) * vec->e_size);
     }
 
@@ -193,14 +228,187 @@ bool vector_pop_index(struct vector *vec, const size_t index, void *element)
     return true;
 }
 
+bool vector_sort(struct vector *vec, order_func order)
+{
+    if (!vec || !order) {
+        return error_set(ERROR_NULL_ARGUMENT, "vector_sort");
+    }
+
+    if (vec->size > 1) {
+        qsort(vector_items(vec), vec->size, vec->e_size, order);
+    }
+
+    return true;
+}
+
+size_t vector_lower_bound(const struct vector *vec, const void *key, order_func order)
+{
+    if (!vec || !key || !order) {
+        return 0;
+    }
+
+    const char *items = vector_items(vec);
+    size_t low = 0;
+    size_t high = vec->size;
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        if (order(items + mid * vec->e_size, key) < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+size_t vector_upper_bound(const struct vector *vec, const void *key, order_func order)
+{
+    if (!vec || !key || !order) {
+        return 0;
+    }
+
+    const char *items = vector_items(vec);
+    size_t low = 0;
+    size_t high = vec->size;
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        if (order(items + mid * vec->e_size, key) <= 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+bool vector_binary_search(const struct vector *vec, const void *key, void *element, order_func order)
+{
+    if (!vec || !key || !order) {
+        return error_set(ERROR_NULL_ARGUMENT, "vector_binary_search");
+    }
+
+    const size_t index = vector_lower_bound(vec, key, order);
+    const void *found = (const char *)vector_items(vec) + index * vec->e_size;
+    if (index == vec->size || order(found, key) != 0) {
+        return error_set(ERROR_NOT_FOUND, "vector_binary_search");
+    }
+    if (element) {
+        memcpy(element, found, vec->e_size);
+    }
+
+    return true;
+}
+
+size_t vector_range(const struct vector *vec, const void *low, const void *high, size_t *first, order_func order)
+{
+    if (!vec || !low || !high || !order) {
+        return 0;
+    }
+
+    const size_t begin = vector_lower_bound(vec, low, order);
+    const size_t end = vector_upper_bound(vec, high, order);
+    if (first) {
+        *first = begin;
+    }
+
+    return end > begin ? end - begin : 0;
+}
+
+bool vector_insert_sorted(struct vector *vec, const void *element, order_func order)
+{
+    if (!vec || !element || !order) {
+        return error_set(ERROR_NULL_ARGUMENT, "vector_insert_sorted");
+    }
+
+    if (!vector_grow(vec->size + 1, vec)) {
+        return error_set(ERROR_OUT_OF_MEMORY, "vector_insert_sorted");
+    }
+
+    // After its equals, so insertion order is kept among them
+    const size_t index = vector_upper_bound(vec, element, order);
+    char *at = (char *)vector_items(vec) + index * vec->e_size;
+    memmove(at + vec->e_size, at, (vec->size - index) * vec->e_size);
+    memcpy(at, element, vec->e_size);
+    vec->size++;
+
+    return true;
+}
+
+/*
+merging a sorted batch from the back, so nothing is overwritten before it moved
+
+vec:   [A, C, E, _, _]   batch: [B, D]
+        ^i=2                     ^j=1       k=4 gets max(E, D) = E, then D, C, B, A
+*/
+
+bool vector_merge_sorted(struct vector *vec, const void *elements, const size_t total, order_func order)
+{
+    if (!vec || !elements || !order) {
+        return error_set(ERROR_NULL_ARGUMENT, "vector_merge_sorted");
+    }
+
+    if (total == 0) {
+        return true;
+    }
+
+    char *batch = alloc_malloc(total * vec->e_size, ALLOC_TAG_VECTOR);
+    if (!batch) {
+        return error_set(ERROR_OUT_OF_MEMORY, "vector_merge_sorted");
+    }
+    memcpy(batch, elements, total * vec->e_size);
+    qsort(batch, total, vec->e_size, order);
+
+    if (!vector_grow(vec->size + total, vec)) {
+        error_set(ERROR_OUT_OF_MEMORY, "vector_merge_sorted");
+        alloc_free(batch);
+        return false;
+    }
+
+    char *items = vector_items(vec);
+    size_t i = vec->size;
+    size_t j = total;
+    size_t k = vec->size + total;
+    while (j > 0) {
+        // Ties take the batch element first from the back, keeping existing elements before new ones
+        if (i > 0 && order(items + (i - 1) * vec->e_size, batch + (j - 1) * vec->e_size) > 0) {
+            memcpy(items + --k * vec->e_size, items + --i * vec->e_size, vec->e_size);
+        } else {
+            memcpy(items + --k * vec->e_size, batch + --j * vec->e_size, vec->e_size);
+        }
+    }
+    vec->size += total;
+    alloc_free(batch);
+
+    return true;
+}
+
+bool vector_copy(const struct vector *src, struct vector *dst)
+{
+    if (!src || !dst) {
+        return error_set(ERROR_NULL_ARGUMENT, "vector_copy");
+    }
+
+    if (!vector_initialize(src->size ? src->size : 1, src->e_size, dst)) {
+        return false;
+    }
+    if (src->size) {
+        memcpy(vector_items(dst), vector_items(src), src->size * src->e_size);
+    }
+    dst->size = src->size;
+
+    return true;
+}
+
 void vector_deinitialize(struct vector *vec)
 {
     if (!vec) {
         return;
     }
     
-    free(vec->items);
-    vec->items = NULL;
+    alloc_free(vec->_heap);
+    vec->_heap = NULL;
     vec->e_size = 0;
     vec->size = 0;
     vec->capacity = 0;
@@ -1,36 +1,75 @@
 /*! Weapon implementation file */
 
 #include "headers/weapon.h"
-#include "headers/compatibility.h"
+#include "headers/alloc.h"
+#include "headers/error.h"
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
+static bool weapon_is_valid(const char *name, const unsigned int health, const unsigned int damage)
+{
+    return name && name[0] != '\0' && health > 0 && damage > 0;
+}
+
 bool weapon_initialize(const char *name, const unsigned int health, const unsigned int damage, struct weapon *w)
 {
-    if (!name || name[0] == '\0' || health == 0 || damage == 0 || !w) {
-        return false;
+    if (!weapon_is_valid(name, health, damage) || !w) {
+        return error_set(!name || !w ? ERROR_NULL_ARGUMENT : ERROR_INVALID_ARGUMENT, "weapon_initialize");
     }
 
-    size_t name_length = strlen(name);
-    w->weapon_name = malloc(name_length + 1);
-    if (!w->weapon_name) {
+    if (!name_initialize(name, &w->weapon_name)) {
         return false;
     }
-    strcpy_s(w->weapon_name, name_length + 1, name);
     w->weapon_health = health;
     w->weapon_damage = damage;
 
     return true;
 }
 
+bool weapon_batch_initialize(const struct weapon_spec *specs, const size_t total, struct weapon_batch *batch)
+{
+    if (!specs || total == 0 || total > SIZE_MAX / sizeof(struct weapon) || !batch) {
+        return error_set(!specs || !batch ? ERROR_NULL_ARGUMENT : ERROR_INVALID_ARGUMENT, "weapon_batch_initialize");
+    }
+
+    memset(batch, 0, sizeof(*batch));
+    size_t names_size = 0;
+    for (size_t i = 0; i < total; i++) {
+        if (!weapon_is_valid(specs[i].name, specs[i].health, specs[i].damage)) {
+            return error_set(ERROR_INVALID_ARGUMENT, "weapon_batch_initialize");
+        }
+        names_size += name_external_size(specs[i].name);
+    }
+
+    batch->weapons = alloc_malloc(total * sizeof(*batch->weapons), ALLOC_TAG_WEAPON);
+    batch->names = names_size ? alloc_malloc(names_size, ALLOC_TAG_WEAPON) : NULL;
+    if (!batch->weapons || (names_size && !batch->names)) {
+        weapon_batch_deinitialize(batch);
+        return error_set(ERROR_OUT_OF_MEMORY, "weapon_batch_initialize");
+    }
+
+    char *storage = batch->names;
+    for (size_t i = 0; i < total; i++) {
+        struct weapon *w = &batch->weapons[i];
+        name_initialize_in(specs[i].name, storage, &w->weapon_name);
+        storage += name_external_size(specs[i].name);
+        w->weapon_health = specs[i].health;
+        w->weapon_damage = specs[i].damage;
+    }
+    batch->size = total;
+
+    return true;
+}
+
 const char *weapon_get_name(const struct weapon *w)
 {
     if (!w) {
         return NULL;
     }
 
-    return w->weapon_name;
+    return name_get(&w->weapon_name);
 }
 
 unsigned int weapon_get_health(const struct weapon *w)
@@ -59,6 +98,7 @@ void weapon_use(const unsigned int damage, struct weapon *w)
 
     if (w->weapon_health <= damage) {
         w->weapon_health = 0;
+        return;
     }
 
     w->weapon_health -= damage;
@@ -90,7 +130,14 @@ bool weapon_name_cmp(const void *w, const void *k)
 
     const struct weapon *weapon = (const struct weapon *)w;
     const char *key = (const char *)k;
-    return strcmp(weapon->weapon_name, key) == 0;
+    return name_equals(&weapon->weapon_name, key);
+}
+
+int weapon_name_order(const void *a, const void *b)
+{
+    const struct weapon *wa = (const struct weapon *)a;
+    const struct weapon *wb = (const struct weapon *)b;
+    return strcmp(name_get(&wa->weapon_name), name_get(&wb->weapon_name));
 }
 
 bool weapon_is_equal(const struct weapon *w1, const struct weapon *w2)
@@ -99,19 +146,30 @@ bool weapon_is_equal(const struct weapon *w1, const struct weapon *w2)
         return false;
     }
 
-    return strcmp(w1->weapon_name, w2->weapon_name) == 0 &&
+    return name_equals(&w1->weapon_name, name_get(&w2->weapon_name)) &&
     w1->weapon_health == w2->weapon_health &&
     w1->weapon_damage == w2->weapon_damage;
 }
 
 void weapon_deinitialize(struct weapon *w)
 {
-    if (!w || !w->weapon_name) {
+    if (!w || name_is_empty(&w->weapon_name)) {
         return;
     }
-    free(w->weapon_name);
-    w->weapon_name = NULL;
+    name_deinitialize(&w->weapon_name);
     w->weapon_health = 0;
     w->weapon_damage = 0;
     memset(w, 0, sizeof(*w));
+}
+
+void weapon_batch_deinitialize(struct weapon_batch *batch)
+{
+    if (!batch) {
+        return;
+    }
+
+    // Names are inline or in batch->names, the weapons own nothing else
+    alloc_free(batch->weapons);
+    alloc_free(batch->names);
+    memset(batch, 0, sizeof(*batch));
 }
\ No newline at end of file